@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cpuid.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ISA tiers used to select a kernel table at runtime
+//   XDNN_ISA_AVX2:   Haswell and later, Zen (AVX2 + FMA + F16C)
+//   XDNN_ISA_AVX512: Skylake-SP, Cascade Lake, Ice Lake (AVX512F/BW/VL/DQ)
+//   XDNN_ISA_AMX:    Sapphire Rapids and later, the target of the prebuilt library
+//                    (AVX512-FP16, AVX512-BF16, AMX-BF16, AMX-INT8)
+enum XDNN_CPU_ISA {
+    XDNN_ISA_NONE = 0,
+    XDNN_ISA_AVX2 = 1,
+    XDNN_ISA_AVX512 = 2,
+    XDNN_ISA_AMX = 3,
+};
+
+struct XDNN_CPU_FEATURES {
+    bool avx2;
+    bool fma;
+    bool f16c;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512vl;
+    bool avx512dq;
+    bool avx512_vnni;
+    bool avx512_bf16;
+    bool avx512_fp16;
+    bool amx_tile;
+    bool amx_bf16;
+    bool amx_int8;
+    bool avx_vnni;
+};
+
+// Probe CPUID/XGETBV once per process
+const XDNN_CPU_FEATURES &xdnn_cpu_features();
+
+// Highest usable tier, optionally capped by env XDNN_MAX_CPU_ISA=avx2|avx512|amx
+XDNN_CPU_ISA xdnn_cpu_isa();
+
+const char *xdnn_cpu_isa_name(XDNN_CPU_ISA isa);
+
+inline uint64_t xdnn_xgetbv(uint32_t index) {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+inline XDNN_CPU_FEATURES xdnn_probe_cpu_features() {
+    XDNN_CPU_FEATURES f;
+    memset(&f, 0, sizeof(f));
+
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return f;
+
+    bool osxsave = (ecx >> 27) & 1;
+    if (!osxsave) return f;
+
+    // OS must save YMM (bit 1, 2), ZMM (bit 5, 6, 7) and tile (bit 17, 18) state
+    uint64_t xcr0 = xdnn_xgetbv(0);
+    bool os_avx = (xcr0 & 0x6) == 0x6;
+    bool os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+    bool os_amx = (xcr0 & 0x60000) == 0x60000;
+
+    f.fma = os_avx && ((ecx >> 12) & 1);
+    f.f16c = os_avx && ((ecx >> 29) & 1);
+
+    unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+    if (max_leaf < 7) return f;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    f.avx2 = os_avx && ((ebx >> 5) & 1);
+    f.avx512f = os_avx512 && ((ebx >> 16) & 1);
+    f.avx512dq = os_avx512 && ((ebx >> 17) & 1);
+    f.avx512bw = os_avx512 && ((ebx >> 30) & 1);
+    f.avx512vl = os_avx512 && ((ebx >> 31) & 1);
+    f.avx512_vnni = os_avx512 && ((ecx >> 11) & 1);
+    f.avx512_fp16 = os_avx512 && ((edx >> 23) & 1);
+    f.amx_bf16 = os_amx && ((edx >> 22) & 1);
+    f.amx_tile = os_amx && ((edx >> 24) & 1);
+    f.amx_int8 = os_amx && ((edx >> 25) & 1);
+
+    unsigned int max_subleaf = eax;
+    if (max_subleaf >= 1) {
+        __cpuid_count(7, 1, eax, ebx, ecx, edx);
+        f.avx_vnni = os_avx && ((eax >> 4) & 1);
+        f.avx512_bf16 = os_avx512 && ((eax >> 5) & 1);
+    }
+
+    // Linux only grants the tile data state after an explicit request
+    // (ARCH_REQ_XCOMP_PERM = 0x1023, XFEATURE_XTILEDATA = 18)
+    if (f.amx_tile) {
+        if (syscall(SYS_arch_prctl, 0x1023, 18) != 0) {
+            f.amx_tile = f.amx_bf16 = f.amx_int8 = false;
+        }
+    }
+
+    return f;
+}
+
+inline const XDNN_CPU_FEATURES &xdnn_cpu_features() {
+    static const XDNN_CPU_FEATURES features = xdnn_probe_cpu_features();
+    return features;
+}
+
+inline XDNN_CPU_ISA xdnn_cpu_isa_from_env() {
+    const char *env = getenv("XDNN_MAX_CPU_ISA");
+    if (env == nullptr) return XDNN_ISA_AMX;
+    if (strcasecmp(env, "avx2") == 0) return XDNN_ISA_AVX2;
+    if (strcasecmp(env, "avx512") == 0) return XDNN_ISA_AVX512;
+    return XDNN_ISA_AMX;
+}
+
+inline XDNN_CPU_ISA xdnn_probe_cpu_isa() {
+    const XDNN_CPU_FEATURES &f = xdnn_cpu_features();
+
+    XDNN_CPU_ISA isa = XDNN_ISA_NONE;
+    if (f.avx2 && f.fma && f.f16c) isa = XDNN_ISA_AVX2;
+    if (isa == XDNN_ISA_AVX2 && f.avx512f && f.avx512bw && f.avx512vl && f.avx512dq) isa = XDNN_ISA_AVX512;
+    if (isa == XDNN_ISA_AVX512 && f.avx512_fp16 && f.avx512_bf16 && f.amx_tile && f.amx_bf16 && f.amx_int8) {
+        isa = XDNN_ISA_AMX;
+    }
+
+    XDNN_CPU_ISA max_isa = xdnn_cpu_isa_from_env();
+    return isa < max_isa ? isa : max_isa;
+}
+
+inline XDNN_CPU_ISA xdnn_cpu_isa() {
+    static const XDNN_CPU_ISA isa = xdnn_probe_cpu_isa();
+    return isa;
+}
+
+inline const char *xdnn_cpu_isa_name(XDNN_CPU_ISA isa) {
+    switch (isa) {
+        case XDNN_ISA_AVX2: return "avx2";
+        case XDNN_ISA_AVX512: return "avx512";
+        case XDNN_ISA_AMX: return "amx";
+        default: return "none";
+    }
+}
@@ -1,6 +1,152 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <immintrin.h>
+
 #include "float16.h"
 #include "bfloat16.h"
+#include "float8.h"
 #include "uint4x2.h"
-#include "normal_float4x2.h"
\ No newline at end of file
+#include "uint2x4.h"
+#include "uint3x8.h"
+#include "normal_float4x2.h"
+
+// Element types, for the descriptors that carry the type at runtime
+enum XDNN_DATA_TYPE {
+    XDNN_DT_FP32 = 0,
+    XDNN_DT_FP16,
+    XDNN_DT_BF16,
+    XDNN_DT_INT8,
+    XDNN_DT_UINT4,
+    XDNN_DT_NF4,
+    XDNN_DT_FP8_E4M3,
+    XDNN_DT_FP8_E5M2,
+    XDNN_DT_UINT2,
+    XDNN_DT_UINT3,
+};
+
+template <typename T>
+inline constexpr bool xdnn_is_fp8 = std::is_same_v<T, XDNN_FP8_E4M3> || std::is_same_v<T, XDNN_FP8_E5M2>;
+
+// Weights per element of a weight type: 2 for the 4-bit, 4 for the 2-bit, 8 for the 3-bit types
+template <typename T>
+inline constexpr int xdnn_values_per = std::is_same_v<T, XDNN_UINT4x2> ? 2
+        : std::is_same_v<T, XDNN_UINT2x4> ? 4 : std::is_same_v<T, XDNN_UINT3x8> ? 8 : 1;
+
+template <typename TS>
+inline constexpr XDNN_DATA_TYPE xdnn_data_type_of() {
+    if constexpr (std::is_same_v<TS, XDNN_FP16>) return XDNN_DT_FP16;
+    else if constexpr (std::is_same_v<TS, XDNN_BF16>) return XDNN_DT_BF16;
+    else {
+        static_assert(std::is_same_v<TS, float>, "not an FP32, FP16 or BF16 type");
+        return XDNN_DT_FP32;
+    }
+}
+
+// Bytes per element of the unpacked types (FP32, FP16, BF16, INT8)
+inline size_t xdnn_size_of(XDNN_DATA_TYPE type) {
+    switch (type) {
+        case XDNN_DT_FP32: return sizeof(float);
+        case XDNN_DT_FP16: return sizeof(XDNN_FP16);
+        case XDNN_DT_BF16: return sizeof(XDNN_BF16);
+        default: return sizeof(int8_t);
+    }
+}
+
+// dst[0:n] = src[0:n] as fp32, 16 or 8 at a time with the vector extensions of the build
+// (F16C/AVX2 from XDNN_CPU_ARCH=x86-64-v3 on), exact like the scalar conversions
+inline void xdnn_fp16_to_float(const XDNN_FP16 *src, size_t n, float *dst) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(src + i))));
+    }
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i];
+}
+
+inline void xdnn_bf16_to_float(const XDNN_BF16 *src, size_t n, float *dst) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_slli_epi32(v, 16)));
+    }
+#endif
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(v, 16)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i];
+}
+
+// FP8 to fp32 through FP16: an E5M2 is the top byte of an FP16, and the bits of an E4M3
+// shifted into an FP16 give its value / 2^8 (subnormals included). S.1111.111 is the NaN of E4M3,
+// which the shift makes 480, a value no E4M3 has.
+inline void xdnn_e4m3_to_float(const XDNN_FP8_E4M3 *src, size_t n, float *dst) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m256i h = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x80)), 8),
+                _mm256_slli_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x7F)), 7));
+        __m512 f = _mm512_mul_ps(_mm512_cvtph_ps(h), _mm512_set1_ps(256.0f));
+        __mmask16 nan = _mm512_cmp_ps_mask(_mm512_abs_ps(f), _mm512_set1_ps(480.0f), _CMP_EQ_OQ);
+        _mm512_storeu_ps(dst + i, _mm512_mask_mov_ps(f, nan, _mm512_set1_ps(std::numeric_limits<float>::quiet_NaN())));
+    }
+#endif
+#if defined(__F16C__) && defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(src + i)));
+        __m128i h = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(x, _mm_set1_epi16(0x80)), 8),
+                _mm_slli_epi16(_mm_and_si128(x, _mm_set1_epi16(0x7F)), 7));
+        __m256 f = _mm256_mul_ps(_mm256_cvtph_ps(h), _mm256_set1_ps(256.0f));
+        __m256 abs = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), f);
+        __m256 nan = _mm256_cmp_ps(abs, _mm256_set1_ps(480.0f), _CMP_EQ_OQ);
+        _mm256_storeu_ps(dst + i, _mm256_blendv_ps(f, _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN()), nan));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i];
+}
+
+inline void xdnn_e5m2_to_float(const XDNN_FP8_E5M2 *src, size_t n, float *dst) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_slli_epi16(x, 8)));
+    }
+#endif
+#if defined(__F16C__) && defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_slli_epi16(x, 8)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i];
+}
+
+// dst[0:n] = src[0:n] as fp32, src is FP32, FP16 or BF16 (any other type is an error)
+inline void xdnn_to_float(XDNN_DATA_TYPE type, const void *src, size_t n, float *dst) {
+    if (type == XDNN_DT_FP16) {
+        xdnn_fp16_to_float((const XDNN_FP16 *)src, n, dst);
+    } else if (type == XDNN_DT_BF16) {
+        xdnn_bf16_to_float((const XDNN_BF16 *)src, n, dst);
+    } else {
+        assert(type == XDNN_DT_FP32 && "not an FP32, FP16 or BF16 type");
+        memcpy(dst, src, n * sizeof(float));
+    }
+}
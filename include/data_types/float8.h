@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "bit_convert.h"
+
+// ================================================================================
+// 8-bit floats of the OCP FP8 spec:
+//   E4M3 (E4M3FN): bias 7, max 448, no infinity, NaN = S.1111.111. Overflows saturate to +-448.
+//   E5M2: bias 15, max 57344, infinities and NaNs as in IEEE 754 (it is the top byte of an FP16).
+// Conversions from float round to nearest even.
+// ================================================================================
+
+// Bits of f as a float with EXP exponent and MAN mantissa bits. max_code is the largest finite
+// magnitude; larger values give inf_code (max_code to saturate).
+template <int EXP, int MAN>
+inline uint8_t xdnn_float_to_fp8_bits(float f, uint8_t max_code, uint8_t inf_code, uint8_t nan_code) {
+    constexpr int bias = (1 << (EXP - 1)) - 1;
+    uint32_t u = bit_convert<uint32_t>(f);
+    uint8_t sign = (u >> 24) & 0x80;
+    uint32_t a = u & 0x7FFFFFFF;
+
+    if (a > 0x7F800000) return sign | nan_code;
+    if (a == 0x7F800000) return sign | inf_code;
+
+    int exp = (int)(a >> 23) - 127;
+    if (exp < 1 - bias) {
+        // Subnormal (or zero): multiples of 2^(1 - bias - MAN), 1 << MAN is the smallest normal
+        float q = std::nearbyint(std::ldexp(bit_convert<float>(a), bias - 1 + MAN));
+        return sign | (uint8_t)q;
+    }
+
+    // Round the mantissa to MAN bits, a carry moves into the exponent
+    a += (1u << (22 - MAN)) - 1 + ((a >> (23 - MAN)) & 1);
+    uint32_t code = (a >> (23 - MAN)) - ((uint32_t)(127 - bias) << MAN);
+    if (code > max_code) return sign | inf_code;
+    return sign | (uint8_t)code;
+}
+
+class XDNN_FP8_E4M3 {
+public:
+    XDNN_FP8_E4M3() = default;
+    XDNN_FP8_E4M3(float val);
+
+    operator float() const;
+    XDNN_FP8_E4M3 &operator=(float f);
+
+    static constexpr float max() { return 448.0f; }
+
+private:
+    uint8_t raw_bits_;
+};
+
+static_assert(sizeof(XDNN_FP8_E4M3) == 1, "XDNN_FP8_E4M3 must be 1 byte");
+
+inline XDNN_FP8_E4M3::XDNN_FP8_E4M3(float val) {
+    (*this) = val;
+}
+
+inline XDNN_FP8_E4M3 &XDNN_FP8_E4M3::operator=(float f) {
+    raw_bits_ = xdnn_float_to_fp8_bits<4, 3>(f, 0x7E, 0x7E, 0x7F);
+    return *this;
+}
+
+inline XDNN_FP8_E4M3::operator float() const {
+    uint32_t e = (raw_bits_ >> 3) & 0x0F;
+    uint32_t m = raw_bits_ & 0x07;
+    float f;
+    if (e == 0x0F && m == 0x07) {
+        f = std::numeric_limits<float>::quiet_NaN();
+    } else if (e == 0) {
+        f = std::ldexp((float)m, -9);
+    } else {
+        f = std::ldexp((float)(8 + m), (int)e - 10);
+    }
+    return (raw_bits_ & 0x80) ? -f : f;
+}
+
+class XDNN_FP8_E5M2 {
+public:
+    XDNN_FP8_E5M2() = default;
+    XDNN_FP8_E5M2(float val);
+
+    operator float() const;
+    XDNN_FP8_E5M2 &operator=(float f);
+
+    static constexpr float max() { return 57344.0f; }
+
+private:
+    uint8_t raw_bits_;
+};
+
+static_assert(sizeof(XDNN_FP8_E5M2) == 1, "XDNN_FP8_E5M2 must be 1 byte");
+
+inline XDNN_FP8_E5M2::XDNN_FP8_E5M2(float val) {
+    (*this) = val;
+}
+
+inline XDNN_FP8_E5M2 &XDNN_FP8_E5M2::operator=(float f) {
+    raw_bits_ = xdnn_float_to_fp8_bits<5, 2>(f, 0x7B, 0x7C, 0x7E);
+    return *this;
+}
+
+inline XDNN_FP8_E5M2::operator float() const {
+    uint32_t e = (raw_bits_ >> 2) & 0x1F;
+    uint32_t m = raw_bits_ & 0x03;
+    float f;
+    if (e == 0x1F) {
+        f = m ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+    } else if (e == 0) {
+        f = std::ldexp((float)m, -16);
+    } else {
+        f = std::ldexp((float)(4 + m), (int)e - 17);
+    }
+    return (raw_bits_ & 0x80) ? -f : f;
+}
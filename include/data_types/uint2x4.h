@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Four 2-bit values in a byte, v1 in the low-order bits
+class XDNN_UINT2x4 {
+public:
+    XDNN_UINT2x4() = default;
+    XDNN_UINT2x4(uint8_t v1, uint8_t v2, uint8_t v3, uint8_t v4);
+    XDNN_UINT2x4(uint8_t v1);
+
+    bool operator!=(const XDNN_UINT2x4& other) const;
+    uint8_t get(int i) const;
+    void set(int i, uint8_t v);
+    void print() const;
+
+private:
+    uint8_t raw_bits_;
+};
+
+static_assert(sizeof(XDNN_UINT2x4) == 1, "XDNN_UINT2x4 must be 1 bytes");
+
+inline XDNN_UINT2x4::XDNN_UINT2x4(uint8_t v1, uint8_t v2, uint8_t v3, uint8_t v4) {
+    this->raw_bits_ = (v1 & 0x03) | ((v2 & 0x03) << 2) | ((v3 & 0x03) << 4) | ((v4 & 0x03) << 6);
+}
+
+inline XDNN_UINT2x4::XDNN_UINT2x4(uint8_t v1) {
+    this->raw_bits_ = v1 & 0x03;
+}
+
+inline bool XDNN_UINT2x4::operator!=(const XDNN_UINT2x4& other) const {
+    return raw_bits_ != other.raw_bits_;
+}
+
+inline uint8_t XDNN_UINT2x4::get(int i) const {
+    return (raw_bits_ >> (i * 2)) & 0x03;
+}
+
+inline void XDNN_UINT2x4::set(int i, uint8_t v) {
+    raw_bits_ = (raw_bits_ & ~(0x03 << (i * 2))) | ((v & 0x03) << (i * 2));
+}
+
+inline void XDNN_UINT2x4::print() const {
+    printf("uint2x4: 0x%x %d %d %d %d\n", raw_bits_, get(0), get(1), get(2), get(3));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Eight 3-bit values in 3 bytes, value i in bits [3i, 3i + 3) of the little-endian 24-bit word
+class XDNN_UINT3x8 {
+public:
+    XDNN_UINT3x8() = default;
+
+    bool operator!=(const XDNN_UINT3x8& other) const;
+    uint8_t get(int i) const;
+    void set(int i, uint8_t v);
+    void print() const;
+
+private:
+    uint32_t word() const;
+
+    uint8_t raw_bits_[3];
+};
+
+static_assert(sizeof(XDNN_UINT3x8) == 3, "XDNN_UINT3x8 must be 3 bytes");
+
+inline uint32_t XDNN_UINT3x8::word() const {
+    return raw_bits_[0] | ((uint32_t)raw_bits_[1] << 8) | ((uint32_t)raw_bits_[2] << 16);
+}
+
+inline bool XDNN_UINT3x8::operator!=(const XDNN_UINT3x8& other) const {
+    return word() != other.word();
+}
+
+inline uint8_t XDNN_UINT3x8::get(int i) const {
+    return (word() >> (i * 3)) & 0x07;
+}
+
+inline void XDNN_UINT3x8::set(int i, uint8_t v) {
+    uint32_t w = (word() & ~(0x07u << (i * 3))) | ((uint32_t)(v & 0x07) << (i * 3));
+    raw_bits_[0] = w & 0xFF;
+    raw_bits_[1] = (w >> 8) & 0xFF;
+    raw_bits_[2] = (w >> 16) & 0xFF;
+}
+
+inline void XDNN_UINT3x8::print() const {
+    printf("uint3x8: 0x%06x", word());
+    for (int i = 0; i < 8; ++i) printf(" %d", get(i));
+    printf("\n");
+}
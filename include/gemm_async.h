@@ -0,0 +1,232 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <immintrin.h>
+#include <omp.h>
+
+#include "gemm_kernels.h"
+#include "gemm_w8a8.h"
+#include "prefetch.h"
+#include "thread_context.h"
+#include "thread_pool.h"
+
+// ================================================================================
+// Asynchronous gemm calls, so host work of a decode step (sampling, KV cache bookkeeping,
+// tokenization) overlaps the gemm instead of waiting for it:
+//   XDNN_ASYNC_HANDLE h = xdnn_sgemm_compute_async(false, M, N, K, 1.0f, A, lda, packedB,
+//           nullptr, nullptr, 0.0f, C, ldc, &ops);
+//   ... host work ...
+//   xdnn_wait(h);
+// Calls run in submission order on a dispatcher thread that takes the place of the calling
+// thread: under the thread context current at submission (on its XDNN_THREAD_POOL if it has
+// one, otherwise on the OpenMP team of the dispatcher), with the OpenMP thread count and
+// prefetch hint of the caller. The post op chain is copied at submission; A, packedB,
+// scaleB/zeroB, C, the vectors the ops point to and the pool of the context must stay
+// alive until the wait.
+// ================================================================================
+struct XDNN_ASYNC_JOB {
+    std::function<void()> fn;
+    XDNN_THREAD_CONTEXT ctx;
+    bool has_ctx;
+    int threads;
+    XDNN_PREFETCH_HINT hint;
+    bool has_hint;
+
+    std::atomic<bool> done{false};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+// Completion handle of a call; copies refer to the same call. An empty handle is done.
+typedef std::shared_ptr<XDNN_ASYNC_JOB> XDNN_ASYNC_HANDLE;
+
+// True once the call of h has written C, without blocking
+inline bool xdnn_done(const XDNN_ASYNC_HANDLE &h) {
+    return !h || h->done.load(std::memory_order_acquire);
+}
+
+// Block until the call of h has written C; rethrows what the call threw. Spins for
+// spin_us first, as a decode step usually waits for a gemm that is about to end.
+inline void xdnn_wait(const XDNN_ASYNC_HANDLE &h, int spin_us = XDNN_POOL_SPIN_US) {
+    if (!h) return;
+    auto start = std::chrono::steady_clock::now();
+    for (int spins = 0; !xdnn_done(h); ++spins) {
+        _mm_pause();
+        if ((spins & 63) != 0) continue;
+        if (std::chrono::steady_clock::now() - start < std::chrono::microseconds(spin_us)) continue;
+
+        std::unique_lock<std::mutex> lock(h->mutex);
+        h->cv.wait(lock, [&] { return xdnn_done(h); });
+    }
+    if (h->error) std::rethrow_exception(h->error);
+}
+
+// FIFO of calls run by one dispatcher thread. xdnn_async_queue() is the one of the
+// xdnn_*_compute_async entry points; instances that should not wait on each other's calls
+// submit on a queue of their own.
+class XDNN_ASYNC_QUEUE {
+public:
+    explicit XDNN_ASYNC_QUEUE(int spin_us = XDNN_POOL_SPIN_US) : spin_us_(spin_us) {
+        dispatcher_ = std::thread([this] { dispatcher_main(); });
+    }
+
+    // Runs the calls still queued, then stops the dispatcher
+    ~XDNN_ASYNC_QUEUE() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        dispatcher_.join();
+    }
+
+    XDNN_ASYNC_QUEUE(const XDNN_ASYNC_QUEUE &) = delete;
+    XDNN_ASYNC_QUEUE &operator=(const XDNN_ASYNC_QUEUE &) = delete;
+
+    // Queue fn, to run with the thread settings of the calling thread
+    XDNN_ASYNC_HANDLE submit(std::function<void()> fn) {
+        XDNN_ASYNC_HANDLE job = std::make_shared<XDNN_ASYNC_JOB>();
+        job->fn = std::move(fn);
+        const XDNN_THREAD_CONTEXT *ctx = xdnn_current_thread_context();
+        job->has_ctx = ctx != nullptr;
+        if (ctx) job->ctx = *ctx;
+        job->threads = omp_get_max_threads();
+        const XDNN_PREFETCH_HINT *hint = xdnn_current_prefetch_hint();
+        job->has_hint = hint != nullptr;
+        if (hint) job->hint = *hint;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(job);
+            pending_.fetch_add(1, std::memory_order_release);
+        }
+        if (sleeping_.load(std::memory_order_seq_cst)) wake_.notify_one();
+        return job;
+    }
+
+private:
+    void run(XDNN_ASYNC_JOB &job) {
+        omp_set_num_threads(job.threads);
+        {
+            std::unique_ptr<XDNN_THREAD_SCOPE> scope;
+            std::unique_ptr<XDNN_PREFETCH_SCOPE> next;
+            if (job.has_ctx) scope.reset(new XDNN_THREAD_SCOPE(job.ctx));
+            if (job.has_hint) next.reset(new XDNN_PREFETCH_SCOPE(job.hint.ptr, job.hint.bytes, job.hint.level));
+            try {
+                job.fn();
+            } catch (...) {
+                job.error = std::current_exception();
+            }
+        }
+        job.fn = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.done.store(true, std::memory_order_release);
+        }
+        job.cv.notify_all();
+    }
+
+    void dispatcher_main() {
+        auto idle = std::chrono::steady_clock::now();
+        for (int spins = 0; ; ++spins) {
+            if (pending_.load(std::memory_order_acquire) > 0) {
+                XDNN_ASYNC_HANDLE job;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    job = jobs_.front();
+                    jobs_.pop_front();
+                    pending_.fetch_sub(1, std::memory_order_relaxed);
+                }
+                run(*job);
+                idle = std::chrono::steady_clock::now();
+                spins = 0;
+                continue;
+            }
+
+            _mm_pause();
+            if ((spins & 63) != 0) continue;
+            if (std::chrono::steady_clock::now() - idle < std::chrono::microseconds(spin_us_)) continue;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_seq_cst);
+            wake_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+            sleeping_.store(false, std::memory_order_seq_cst);
+            if (stop_ && jobs_.empty()) return;
+            idle = std::chrono::steady_clock::now();
+        }
+    }
+
+    int spin_us_;
+    std::thread dispatcher_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<XDNN_ASYNC_HANDLE> jobs_;
+    std::atomic<int> pending_{0};
+    std::atomic<bool> sleeping_{false};
+    bool stop_ = false;
+};
+
+inline XDNN_ASYNC_QUEUE &xdnn_async_queue() {
+    static XDNN_ASYNC_QUEUE queue;
+    return queue;
+}
+
+// xdnn_gemm_compute on queue; returns once the call is queued. kernels must outlive the
+// call (the xdnn_<family>_kernels tables are static).
+template <typename TB>
+inline XDNN_ASYNC_HANDLE xdnn_gemm_compute_async(XDNN_ASYNC_QUEUE &queue, const XDNN_GEMM_KERNELS<TB> &kernels,
+        bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+        const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    XDNN_GEMM_EPILOGUE ep = xdnn_gemm_epilogue(kernels, alpha, beta, ops);
+    const XDNN_GEMM_KERNELS<TB> *table = &kernels;
+    return queue.submit([=] {
+        xdnn_gemm_compute_epilogue(*table, ep, transA, M, N, K, A, lda, packedB, scaleB, zeroB, C, ldc);
+    });
+}
+
+template <typename TB>
+inline XDNN_ASYNC_HANDLE xdnn_gemm_compute_async(const XDNN_GEMM_KERNELS<TB> &kernels, bool transA, int M, int N,
+        int K, float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+        float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    return xdnn_gemm_compute_async(xdnn_async_queue(), kernels, transA, M, N, K, alpha, A, lda, packedB, scaleB,
+            zeroB, beta, C, ldc, ops);
+}
+
+// xdnn_<family>_compute_async of the families with an xdnn_<family>_kernels table, the
+// kernels picked at submission on the dispatch tier of the calling thread
+#define XDNN_DEFINE_ASYNC_FAMILY(family, TB) \
+    inline XDNN_ASYNC_HANDLE xdnn_##family##_compute_async(bool transA, int M, int N, int K, float alpha, \
+            const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB, float beta, \
+            float *C, int ldc, const XDNN_POST_OPS *ops = nullptr) { \
+        return xdnn_gemm_compute_async(xdnn_##family##_kernels(), transA, M, N, K, alpha, A, lda, packedB, \
+                scaleB, zeroB, beta, C, ldc, ops); \
+    }
+
+XDNN_DEFINE_ASYNC_FAMILY(sgemm, float)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32f16f32, XDNN_FP16)
+XDNN_DEFINE_ASYNC_FAMILY(hgemm_f32f16f32, XDNN_FP16)
+XDNN_DEFINE_ASYNC_FAMILY(bgemm_f32bf16f32, XDNN_BF16)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32s8f32, int8_t)
+XDNN_DEFINE_ASYNC_FAMILY(hgemm_f32s8f32, int8_t)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32i8f32, int8_t)
+XDNN_DEFINE_ASYNC_FAMILY(hgemm_f32i8f32, int8_t)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32u4f32, XDNN_UINT4x2)
+XDNN_DEFINE_ASYNC_FAMILY(hgemm_f32u4f32, XDNN_UINT4x2)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32nf4f32, XDNN_NF4x2)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32e4m3f32, XDNN_FP8_E4M3)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32e5m2f32, XDNN_FP8_E5M2)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32u2f32, XDNN_UINT2x4)
+XDNN_DEFINE_ASYNC_FAMILY(sgemm_f32u3f32, XDNN_UINT3x8)
+XDNN_DEFINE_ASYNC_FAMILY(w8a8_sgemm_f32s8f32, int8_t)
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <omp.h>
+
+#include "amx_sgemm_bf16bf16bf16.h"
+#include "cpu_isa.h"
+#include "hgemm.h"
+#include "parallel.h"
+#include "sgemm.h"
+
+#define XDNN_BATCH_MIN_ROWS 32 // rows of a tile are not split below this
+#define XDNN_BATCH_MIN_COLS 64 // cols of a tile are not split below this
+
+// Portable single threaded tile for the AVX2/AVX-512 tiers, where the library kernels
+// (built for Sapphire Rapids) cannot run. B of the tile is converted to fp32 once and
+// each row of C accumulated in fp32.
+template <typename T>
+inline void xdnn_batch_to_float(const T *src, int n, float *dst) {
+    if constexpr (std::is_same_v<T, float>) {
+        memcpy(dst, src, n * sizeof(float));
+    } else if constexpr (std::is_same_v<T, XDNN_FP16>) {
+        xdnn_fp16_to_float(src, n, dst);
+    } else {
+        xdnn_bf16_to_float(src, n, dst);
+    }
+}
+
+template <typename T>
+inline void xdnn_batch_tile_plain(bool transA, bool transB, int M, int N, int K, float alpha, const T *A, int lda,
+        const T *B, int ldb, float beta, T *C, int ldc) {
+    std::vector<float> a(K), b((size_t)K * N), acc(N);
+    for (int r = 0; r < (transB ? N : K); ++r) {
+        xdnn_batch_to_float(B + (size_t)r * ldb, transB ? K : N, b.data() + (size_t)r * (transB ? K : N));
+    }
+
+    for (int m = 0; m < M; ++m) {
+        if (transA) {
+            for (int k = 0; k < K; ++k) a[k] = static_cast<float>(A[(size_t)k * lda + m]);
+        } else {
+            xdnn_batch_to_float(A + (size_t)m * lda, K, a.data());
+        }
+
+        if (transB) {
+            for (int n = 0; n < N; ++n) {
+                const float *bn = b.data() + (size_t)n * K;
+                float sum = 0.0f;
+                #pragma omp simd reduction(+ : sum)
+                for (int k = 0; k < K; ++k) sum += a[k] * bn[k];
+                acc[n] = sum;
+            }
+        } else {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int k = 0; k < K; ++k) {
+                const float *bk = b.data() + (size_t)k * N;
+                float ak = a[k];
+                #pragma omp simd
+                for (int n = 0; n < N; ++n) acc[n] += ak * bk[n];
+            }
+        }
+
+        T *c = C + (size_t)m * ldc;
+        for (int n = 0; n < N; ++n) {
+            float v = alpha * acc[n];
+            if (beta != 0.0f) v += beta * static_cast<float>(c[n]);
+            c[n] = static_cast<T>(v);
+        }
+    }
+}
+
+// Single threaded kernel of one tile, per element type: the library on AMX, the portable tile elsewhere
+template <typename T>
+struct xdnn_batch_tile_kernel;
+
+template <>
+struct xdnn_batch_tile_kernel<float> {
+    static void call(bool transA, bool transB, int M, int N, int K, float alpha, const float *A, int lda,
+            const float *B, int ldb, float beta, float *C, int ldc) {
+        if (xdnn_cpu_isa() == XDNN_ISA_AMX) {
+            xdnn_sgemm_single_thread(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        } else {
+            xdnn_batch_tile_plain(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+    }
+};
+
+// No single thread hgemm in the library, xdnn_hgemm is single threaded inside the batch parallel region
+template <>
+struct xdnn_batch_tile_kernel<XDNN_FP16> {
+    static void call(bool transA, bool transB, int M, int N, int K, float alpha, const XDNN_FP16 *A, int lda,
+            const XDNN_FP16 *B, int ldb, float beta, XDNN_FP16 *C, int ldc) {
+        if (xdnn_cpu_isa() == XDNN_ISA_AMX) {
+            xdnn_hgemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        } else {
+            xdnn_batch_tile_plain(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+    }
+};
+
+template <>
+struct xdnn_batch_tile_kernel<XDNN_BF16> {
+    static void call(bool transA, bool transB, int M, int N, int K, float alpha, const XDNN_BF16 *A, int lda,
+            const XDNN_BF16 *B, int ldb, float beta, XDNN_BF16 *C, int ldc) {
+        if (xdnn_cpu_isa() == XDNN_ISA_AMX) {
+            xdnn_amx_sgemm_bf16bf16bf16_single_thread(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        } else {
+            xdnn_batch_tile_plain(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+    }
+};
+
+// Split each matrix in mblocks x nblocks tiles, until batch x tiles makes about 2 tiles per thread
+inline void xdnn_batch_tiles(int batch, int M, int N, int threads, int &mblocks, int &nblocks) {
+    int max_mblocks = std::max(1, M / XDNN_BATCH_MIN_ROWS);
+    int max_nblocks = std::max(1, N / XDNN_BATCH_MIN_COLS);
+    mblocks = nblocks = 1;
+    while ((long long)batch * mblocks * nblocks < 2 * threads) {
+        // Split the longer side first to keep tiles square
+        bool splitM = mblocks < max_mblocks && (M / mblocks >= N / nblocks || nblocks >= max_nblocks);
+        if (splitM) {
+            ++mblocks;
+        } else if (nblocks < max_nblocks) {
+            ++nblocks;
+        } else {
+            break;
+        }
+    }
+}
+
+// To compute a batch of independent gemms in one parallel region:
+//   C[i] = alpha * A[i] * B[i] + beta * C[i], i in [0, batch)
+// with A[i] = A + i * strideA, B[i] = B + i * strideB, C[i] = C + i * strideC (in elements)
+// A stride of 0 shares the matrix in all the batch (e.g. grouped query attention)
+template <typename T>
+inline void xdnn_gemm_batch_strided(bool transA, bool transB, int M, int N, int K,
+        float alpha, const T *A, int lda, size_t strideA, const T *B, int ldb, size_t strideB,
+        float beta, T *C, int ldc, size_t strideC, int batch) {
+    if (batch <= 0 || M <= 0 || N <= 0) return;
+
+    int mblocks, nblocks;
+    xdnn_batch_tiles(batch, M, N, omp_get_max_threads(), mblocks, nblocks);
+    int rows = (M + mblocks - 1) / mblocks;
+    int cols = (N + nblocks - 1) / nblocks;
+    int tiles = mblocks * nblocks;
+
+    xdnn_parallel_for(batch * tiles, [&](int t) {
+        int i = t / tiles;
+        int m0 = (t % tiles) / nblocks * rows;
+        int n0 = (t % nblocks) * cols;
+        if (m0 >= M || n0 >= N) return;
+
+        const T *a = A + i * strideA + (transA ? (size_t)m0 : (size_t)m0 * lda);
+        const T *b = B + i * strideB + (transB ? (size_t)n0 * ldb : (size_t)n0);
+        T *c = C + i * strideC + (size_t)m0 * ldc + n0;
+        xdnn_batch_tile_kernel<T>::call(transA, transB, std::min(rows, M - m0), std::min(cols, N - n0), K,
+                alpha, a, lda, b, ldb, beta, c, ldc);
+    });
+}
+
+// To compute strided batched sgemm: C[i] = alpha * A[i] * B[i] + beta * C[i]
+inline void xdnn_sgemm_batch_strided(bool transA, bool transB, int M, int N, int K,
+        float alpha, const float *A, int lda, size_t strideA, const float *B, int ldb, size_t strideB,
+        float beta, float *C, int ldc, size_t strideC, int batch) {
+    xdnn_gemm_batch_strided(transA, transB, M, N, K, alpha, A, lda, strideA, B, ldb, strideB,
+            beta, C, ldc, strideC, batch);
+}
+
+// To compute strided batched hgemm: C[i] = alpha * A[i] * B[i] + beta * C[i]
+inline void xdnn_hgemm_batch_strided(bool transA, bool transB, int M, int N, int K,
+        float alpha, const XDNN_FP16 *A, int lda, size_t strideA, const XDNN_FP16 *B, int ldb, size_t strideB,
+        float beta, XDNN_FP16 *C, int ldc, size_t strideC, int batch) {
+    xdnn_gemm_batch_strided(transA, transB, M, N, K, alpha, A, lda, strideA, B, ldb, strideB,
+            beta, C, ldc, strideC, batch);
+}
+
+// To compute strided batched amx sgemm: C[i] = alpha * A[i] * B[i] + beta * C[i]
+inline void xdnn_amx_sgemm_bf16bf16bf16_batch_strided(bool transA, bool transB, int M, int N, int K,
+        float alpha, const XDNN_BF16 *A, int lda, size_t strideA, const XDNN_BF16 *B, int ldb, size_t strideB,
+        float beta, XDNN_BF16 *C, int ldc, size_t strideC, int batch) {
+    xdnn_gemm_batch_strided(transA, transB, M, N, K, alpha, A, lda, strideA, B, ldb, strideB,
+            beta, C, ldc, strideC, batch);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <omp.h>
+
+#include "packed_b.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+// One independent problem of a grouped GEMM:
+//   C = ops(alpha * A * packedB + beta * C), A is in M x K (K x M if transA), C is in M x N
+// N and K come from packedB, which may differ between problems of a group.
+template <typename TB>
+struct XDNN_GEMM_PROBLEM {
+    bool transA;
+    int M;
+    float alpha;
+    const float *A;
+    int lda;
+    const XDNN_PACKED_B<TB> *packedB;
+    float beta;
+    float *C;
+    int ldc;
+    XDNN_POST_OPS ops;
+};
+
+// To compute many independent problems (e.g. MoE experts, recommendation towers) in one
+// parallel region: the row block x panel tiles of all problems are scheduled together
+// instead of paying one fork/join per problem.
+template <typename TB>
+inline void xdnn_gemm_compute_grouped(int count, const XDNN_GEMM_PROBLEM<TB> *problems) {
+    int threads = omp_get_max_threads();
+
+    // first[i]: index of the first tile of problem i
+    std::vector<int> first(count + 1, 0);
+    std::vector<int> rows(count, 0);
+    for (int i = 0; i < count; ++i) {
+        const XDNN_GEMM_PROBLEM<TB> &pb = problems[i];
+        int panels = pb.M > 0 ? pb.packedB->panels : 0;
+        int mblocks = panels > 0 ? xdnn_row_blocks(pb.M, panels * count, threads) : 0;
+        rows[i] = mblocks > 0 ? (pb.M + mblocks - 1) / mblocks : 0;
+        first[i + 1] = first[i] + mblocks * panels;
+    }
+
+    xdnn_parallel_for(first[count], [&](int t) {
+        int i = std::upper_bound(first.begin(), first.end(), t) - first.begin() - 1;
+        const XDNN_GEMM_PROBLEM<TB> &pb = problems[i];
+        int local = t - first[i];
+        int panels = pb.packedB->panels;
+        int m0 = (local / panels) * rows[i];
+        int p = local % panels;
+        if (m0 < pb.M) {
+            xdnn_packed_b_compute_tile(*pb.packedB, pb.transA, m0, std::min(rows[i], pb.M - m0), p,
+                    pb.alpha, pb.A, pb.lda, pb.beta, pb.C, pb.ldc, &pb.ops);
+        }
+    });
+}
@@ -0,0 +1,712 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "cpu_isa.h"
+#include "gemm_portable.h"
+#include "parallel.h"
+#include "packb_size.h"
+#include "post_ops.h"
+#include "tuning_db.h"
+#include "data_types/data_types.h"
+
+#include "sgemm.h"
+#include "sgemm_f32f16f32.h"
+#include "sgemm_f32s8f32.h"
+#include "sgemm_f32i8f32.h"
+#include "sgemm_f32u4f32.h"
+#include "sgemm_f32nf4f32.h"
+#include "hgemm_f32f16f32.h"
+#include "hgemm_f32s8f32.h"
+#include "hgemm_f32i8f32.h"
+#include "hgemm_f32u4f32.h"
+#include "bgemm_f32bf16f32.h"
+
+// ================================================================================
+// Kernel tables of the packed-B families with fp32 A and C. One table per ISA tier
+// and family; xdnn_<family>_kernels() picks the tier of the running CPU once.
+//   XDNN_ISA_AMX:    the prebuilt library entry points
+//   XDNN_ISA_AVX512: portable kernels compiled for AVX-512
+//   XDNN_ISA_AVX2:   portable kernels compiled with the build flags
+// A packedB is only valid with the table that packed it.
+// All functions share the signature of the quantized families, scaleB/zeroB are
+// ignored by the others.
+// ================================================================================
+template <typename TB>
+struct XDNN_GEMM_KERNELS {
+    using quantize_fn = void (*)(bool transB, int N, int K, const float *B, int ldb,
+            float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB);
+    using packb_fn = void (*)(bool transB, int N, int K, const TB *B, int ldb, TB *packedB);
+    using compute_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc);
+    using bias_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const float *bias);
+    using residential_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const float *bias, const float *res, int ldres);
+    using resext_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const float *bias, float gamma, const float *res, int ldres);
+    using resmul_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const float *res, int ldres);
+    using post_ops_fn = void (*)(bool transA, int M, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const XDNN_POST_OPS *ops);
+    using quantize_packb_fn = void (*)(bool transB, int N, int K, const void *B, XDNN_DATA_TYPE typeB, int ldb,
+            float quantization_rate, TB *packedB, float *scaleB, float *zeroB);
+    using block_fn = void (*)(bool transA, int N, int K,
+            float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+            float beta, float *C, int ldc, const XDNN_POST_OPS *ops, int m0, int rows);
+
+    const char *name;
+    XDNN_CPU_ISA isa;
+
+    size_t (*packb_size)(int N, int K); // in elements of TB
+    quantize_fn quantize;               // nullptr if weights are not quantized
+    packb_fn packb;
+
+    compute_fn compute;
+    compute_fn compute_silu;
+    compute_fn compute_gelu;
+    bias_fn compute_biasadd;
+    bias_fn compute_biasadd_relu;
+    residential_fn compute_residential;
+    resext_fn compute_resext;
+    resmul_fn compute_resmul;
+    post_ops_fn compute_post_ops;       // any chain fused in the tile loop, nullptr if not available
+    quantize_packb_fn quantize_packb;   // B (FP32, FP16 or BF16) to packedB + scaleB/zeroB, nullptr if not quantized
+    int group_size;                     // rows of K per scale, 0 for one scale per column (xdnn_scale_groups)
+    bool codebook;                      // zeroB holds the codebooks (xdnn_fmt_cb4), shared by all columns
+
+    // Families packing B in blocks (tuning_db.h), nullptr for the others: the block to pack N x K
+    // with for a team of threads, and packb_size/packb with that block instead of the default one
+    XDNN_PACKB_BLOCK (*packb_block)(int N, int K, int threads) = nullptr;
+    size_t (*packb_size_blocked)(int N, int K, XDNN_PACKB_BLOCK block) = nullptr;
+    void (*packb_blocked)(bool transB, int N, int K, const TB *B, int ldb, TB *packedB, XDNN_PACKB_BLOCK block) = nullptr;
+
+    // Tables with compute_post_ops of their own tile loop: rows m0:m0+rows of C on the calling thread,
+    // with no tiling or split-K of its own, for plans (gemm_plan.h). nullptr for the library tables.
+    block_fn compute_block = nullptr;
+};
+
+// Floats of scaleB for N x K
+template <typename TB>
+inline size_t xdnn_scale_count(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K) {
+    return (size_t)N * xdnn_scale_groups(K, kernels.group_size);
+}
+
+// Offset in scaleB of the scales of column n0
+template <typename TB>
+inline size_t xdnn_scale_offset(const XDNN_GEMM_KERNELS<TB> &kernels, int K, int n0) {
+    return (size_t)n0 * xdnn_scale_groups(K, kernels.group_size);
+}
+
+// Same for zeroB, which is not per column with a codebook
+template <typename TB>
+inline size_t xdnn_zero_count(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K) {
+    if (kernels.codebook) return (size_t)XDNN_CODEBOOK_SIZE * xdnn_scale_groups(K, kernels.group_size);
+    return xdnn_scale_count(kernels, N, K);
+}
+
+template <typename TB>
+inline size_t xdnn_zero_offset(const XDNN_GEMM_KERNELS<TB> &kernels, int K, int n0) {
+    return kernels.codebook ? 0 : xdnn_scale_offset(kernels, K, n0);
+}
+
+// The fixed epilogue entry points and the head of a chain each of them covers
+enum XDNN_FUSED_ENTRY {
+    XDNN_FUSED_NONE = 0,    // []
+    XDNN_FUSED_SILU,        // [SILU]
+    XDNN_FUSED_GELU,        // [GELU]
+    XDNN_FUSED_BIASADD,     // [BIAS]
+    XDNN_FUSED_BIASADD_RELU,// [BIAS, RELU]
+    XDNN_FUSED_RESIDENTIAL, // [BIAS, RES_ADD(1)]
+    XDNN_FUSED_RESEXT,      // [BIAS, RES_ADD(gamma)]
+    XDNN_FUSED_RESMUL,      // [RES_MUL]
+};
+
+// Pick the entry point covering the longest head of ops, count is set to the ops it covers
+inline XDNN_FUSED_ENTRY xdnn_match_fused_entry(const XDNN_POST_OPS *ops, int &count) {
+    int n = xdnn_post_ops_count(ops);
+    XDNN_POST_OP_KIND first = n > 0 ? ops->ops[0].kind : XDNN_POST_OP_NONE;
+    XDNN_POST_OP_KIND second = n > 1 ? ops->ops[1].kind : XDNN_POST_OP_NONE;
+
+    count = 1;
+    switch (first) {
+        case XDNN_POST_OP_SILU: return XDNN_FUSED_SILU;
+        case XDNN_POST_OP_GELU: return XDNN_FUSED_GELU;
+        case XDNN_POST_OP_RES_MUL: return XDNN_FUSED_RESMUL;
+        case XDNN_POST_OP_BIAS:
+            count = 2;
+            if (second == XDNN_POST_OP_RELU) return XDNN_FUSED_BIASADD_RELU;
+            if (second == XDNN_POST_OP_RES_ADD) {
+                return ops->ops[1].alpha == 1.0f ? XDNN_FUSED_RESIDENTIAL : XDNN_FUSED_RESEXT;
+            }
+            count = 1;
+            return XDNN_FUSED_BIASADD;
+        default:
+            count = 0;
+            return XDNN_FUSED_NONE;
+    }
+}
+
+template <typename TB>
+inline void xdnn_gemm_compute_fused(const XDNN_GEMM_KERNELS<TB> &kernels, XDNN_FUSED_ENTRY entry,
+        bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+        const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    const XDNN_POST_OP *op = ops ? ops->ops : nullptr;
+    switch (entry) {
+        case XDNN_FUSED_SILU:
+            kernels.compute_silu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc);
+            break;
+        case XDNN_FUSED_GELU:
+            kernels.compute_gelu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc);
+            break;
+        case XDNN_FUSED_BIASADD:
+            kernels.compute_biasadd(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, op[0].vec);
+            break;
+        case XDNN_FUSED_BIASADD_RELU:
+            kernels.compute_biasadd_relu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, op[0].vec);
+            break;
+        case XDNN_FUSED_RESIDENTIAL:
+            kernels.compute_residential(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                    op[0].vec, op[1].mat, op[1].ld);
+            break;
+        case XDNN_FUSED_RESEXT:
+            kernels.compute_resext(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                    op[0].vec, op[1].alpha, op[1].mat, op[1].ld);
+            break;
+        case XDNN_FUSED_RESMUL:
+            kernels.compute_resmul(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                    op[0].mat, op[0].ld);
+            break;
+        default:
+            kernels.compute(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc);
+            break;
+    }
+}
+
+// Rows of C per block when the rest of a chain runs after a fixed entry point, about 128KB of C
+inline int xdnn_post_ops_block_rows(int N) {
+    return std::max(1, (32 * 1024) / std::max(N, 1));
+}
+
+// How a chain runs on a kernel table, resolved once per call (or once per plan)
+struct XDNN_GEMM_EPILOGUE {
+    float alpha;            // with a leading scalar scale folded in
+    float beta;
+    XDNN_POST_OPS chain;    // the ops left after the fold
+    XDNN_FUSED_ENTRY entry; // tables without compute_post_ops: entry point fusing the head of chain
+    XDNN_POST_OPS rest;     // and the ops after that head
+};
+
+template <typename TB>
+inline XDNN_GEMM_EPILOGUE xdnn_gemm_epilogue(const XDNN_GEMM_KERNELS<TB> &kernels, float alpha, float beta,
+        const XDNN_POST_OPS *ops) {
+    XDNN_GEMM_EPILOGUE ep;
+    ep.alpha = alpha;
+    ep.beta = beta;
+
+    // A leading scalar scale folds into alpha and beta
+    int skip = 0;
+    if (xdnn_post_ops_count(ops) > 0 && ops->ops[0].kind == XDNN_POST_OP_SCALE && ops->ops[0].vec == nullptr) {
+        ep.alpha *= ops->ops[0].alpha;
+        ep.beta *= ops->ops[0].alpha;
+        skip = 1;
+    }
+    ep.chain = xdnn_post_ops_tail(ops, skip);
+    // Only the tile loops of compute_post_ops store C themselves; the library kernels have
+    // written it by the time the chain runs, so a STREAM would only get in the way of fusing
+    if (!kernels.compute_post_ops) ep.chain = xdnn_post_ops_drop(&ep.chain, XDNN_POST_OP_STREAM);
+
+    int fused = 0;
+    ep.entry = kernels.compute_post_ops ? XDNN_FUSED_NONE : xdnn_match_fused_entry(&ep.chain, fused);
+    ep.rest = kernels.compute_post_ops ? XDNN_POST_OPS{0} : xdnn_post_ops_tail(&ep.chain, fused);
+    return ep;
+}
+
+// ep with the buffers of ops, a chain that differs from the one ep was resolved for only in
+// its buffers (xdnn_post_ops_same_kinds): the fold, the dropped ops and the fused head stay
+inline void xdnn_gemm_epilogue_rebind(XDNN_GEMM_EPILOGUE &ep, const XDNN_POST_OPS *ops) {
+    int j = xdnn_post_ops_count(ops) > 0 && ops->ops[0].kind == XDNN_POST_OP_SCALE && ops->ops[0].vec == nullptr;
+    for (int i = 0; i < ep.chain.count; ++i, ++j) {
+        while (ops->ops[j].kind != ep.chain.ops[i].kind) ++j; // a dropped STREAM
+        ep.chain.ops[i] = ops->ops[j];
+    }
+    int head = ep.chain.count - ep.rest.count;
+    for (int i = 0; i < ep.rest.count; ++i) ep.rest.ops[i] = ep.chain.ops[head + i];
+}
+
+// The epilogue of the sub block starting at (m0, n0)
+inline XDNN_GEMM_EPILOGUE xdnn_gemm_epilogue_at(const XDNN_GEMM_EPILOGUE &ep, int m0, int n0) {
+    XDNN_GEMM_EPILOGUE sub = ep;
+    sub.chain = xdnn_post_ops_at(&ep.chain, m0, n0);
+    sub.rest = xdnn_post_ops_at(&ep.rest, m0, n0);
+    return sub;
+}
+
+// C = ep(A * packedB + C)
+// Tables with compute_post_ops run the whole chain in the tile loop. Otherwise the longest
+// head covered by a fixed entry point is fused, and the rest runs on blocks of rows right
+// after each block is computed, while it is still in cache.
+template <typename TB>
+inline void xdnn_gemm_compute_epilogue(const XDNN_GEMM_KERNELS<TB> &kernels, const XDNN_GEMM_EPILOGUE &ep,
+        bool transA, int M, int N, int K, const float *A, int lda, const TB *packedB, const float *scaleB,
+        const float *zeroB, float *C, int ldc) {
+    float alpha = ep.alpha;
+    float beta = ep.beta;
+
+    if (kernels.compute_post_ops) {
+        kernels.compute_post_ops(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, &ep.chain);
+        return;
+    }
+
+    if (ep.rest.count == 0) {
+        xdnn_gemm_compute_fused(kernels, ep.entry, transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB,
+                beta, C, ldc, &ep.chain);
+        return;
+    }
+
+    int rows = xdnn_post_ops_block_rows(N);
+    int blocks = (M + rows - 1) / rows;
+
+    if (omp_in_parallel() || blocks >= omp_get_max_threads()) {
+        xdnn_parallel_for(blocks, [&](int b) {
+            int m0 = b * rows;
+            int mb = std::min(rows, M - m0);
+            XDNN_POST_OPS sub = xdnn_post_ops_at(&ep.chain, m0, 0);
+            xdnn_gemm_compute_fused(kernels, ep.entry, transA, mb, N, K, alpha, transA ? A + m0 : A + (size_t)m0 * lda,
+                    lda, packedB, scaleB, zeroB, beta, C + (size_t)m0 * ldc, ldc, &sub);
+            xdnn_apply_post_ops(&ep.rest, m0, 0, mb, N, C + (size_t)m0 * ldc, ldc);
+        });
+    } else {
+        // Too few rows to keep all threads busy on blocks: let the entry point use all of them,
+        // C is small then and the rest is a cheap pass
+        xdnn_gemm_compute_fused(kernels, ep.entry, transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB,
+                beta, C, ldc, &ep.chain);
+        xdnn_parallel_for(blocks, [&](int b) {
+            int m0 = b * rows;
+            xdnn_apply_post_ops(&ep.rest, m0, 0, std::min(rows, M - m0), N, C + (size_t)m0 * ldc, ldc);
+        });
+    }
+}
+
+// C = ops(alpha * A * packedB + beta * C)
+template <typename TB>
+inline void xdnn_gemm_compute(const XDNN_GEMM_KERNELS<TB> &kernels, bool transA, int M, int N, int K,
+        float alpha, const float *A, int lda, const TB *packedB, const float *scaleB, const float *zeroB,
+        float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    XDNN_GEMM_EPILOGUE ep = xdnn_gemm_epilogue(kernels, alpha, beta, ops);
+    xdnn_gemm_compute_epilogue(kernels, ep, transA, M, N, K, A, lda, packedB, scaleB, zeroB, C, ldc);
+}
+
+// ================================================================================
+// Adapters from the library entry points to the table signatures
+// ================================================================================
+
+// Drop scaleB/zeroB for the families without quantized weights
+template <typename TB, typename... Ts>
+struct xdnn_unquantized {
+    template <void (*Fn)(bool, int, int, int, float, const float *, int, const TB *, float, float *, int, Ts...)>
+    static void call(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *, const float *, float beta, float *C, int ldc, Ts... args) {
+        Fn(transA, M, N, K, alpha, A, lda, packedB, beta, C, ldc, args...);
+    }
+};
+
+#define XDNN_QUANTIZE_COLS 64 // columns of B converted to fp32 at a time by xdnn_quantize_from
+
+// quantize (an fp32 _quantize) of B in FP32, FP16 or BF16. FP16/BF16 B is converted to fp32
+// XDNN_QUANTIZE_COLS columns at a time, never as a whole; the columns are quantized on their own.
+// scale_stride/zero_stride: floats of scaleB/zeroB per column (xdnn_scale_offset, xdnn_zero_offset)
+template <typename TB>
+inline void xdnn_quantize_from(typename XDNN_GEMM_KERNELS<TB>::quantize_fn quantize, bool transB, int N, int K,
+        const void *B, XDNN_DATA_TYPE typeB, int ldb, float quantization_rate, TB *quantizedB, int ldqb,
+        float *scaleB, float *zeroB, size_t scale_stride = 1, size_t zero_stride = 1) {
+    if (typeB == XDNN_DT_FP32) {
+        quantize(transB, N, K, (const float *)B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB);
+        return;
+    }
+
+    // 4/3/2-bit values of two blocks share an element when the rows of quantizedB are not whole elements
+    int blocks = (N + XDNN_QUANTIZE_COLS - 1) / XDNN_QUANTIZE_COLS;
+    bool parallel = ldqb % xdnn_values_per<TB> == 0;
+    size_t bytes = xdnn_size_of(typeB);
+
+    #pragma omp parallel for if(parallel)
+    for (int b = 0; b < blocks; ++b) {
+        int n0 = b * XDNN_QUANTIZE_COLS;
+        int cols = std::min(XDNN_QUANTIZE_COLS, N - n0);
+        std::vector<float> block((size_t)cols * K);
+
+        // The columns as fp32, in the orientation of B: cols x K if transB, K x cols otherwise
+        if (transB) {
+            for (int n = 0; n < cols; ++n) {
+                xdnn_to_float(typeB, (const char *)B + ((size_t)(n0 + n) * ldb) * bytes, K, block.data() + (size_t)n * K);
+            }
+        } else {
+            for (int k = 0; k < K; ++k) {
+                xdnn_to_float(typeB, (const char *)B + ((size_t)k * ldb + n0) * bytes, cols, block.data() + (size_t)k * cols);
+            }
+        }
+
+        size_t offset = transB ? (size_t)n0 * ldqb : (size_t)n0;
+        quantize(transB, cols, K, block.data(), transB ? K : cols, quantization_rate,
+                quantizedB + xdnn_elems<TB>(offset), ldqb, scaleB + n0 * scale_stride, zeroB + n0 * zero_stride);
+    }
+}
+
+// quantize_packb of the library tables: B is quantized into a buffer of the weight type, then packed
+template <typename TB, typename XDNN_GEMM_KERNELS<TB>::quantize_fn Quantize, typename XDNN_GEMM_KERNELS<TB>::packb_fn Packb>
+inline void xdnn_quantize_then_packb(bool transB, int N, int K, const void *B, XDNN_DATA_TYPE typeB, int ldb,
+        float quantization_rate, TB *packedB, float *scaleB, float *zeroB) {
+    int ldq = transB ? K : N;
+    std::vector<TB> quantized(xdnn_elems_for<TB>((size_t)K * N));
+    xdnn_quantize_from<TB>(Quantize, transB, N, K, B, typeB, ldb, quantization_rate, quantized.data(), ldq, scaleB, zeroB);
+    Packb(transB, N, K, quantized.data(), ldq, packedB);
+}
+
+// For families without a native _compute_gelu
+template <typename TB, void (*Fn)(bool, int, int, int, float, const float *, int, const TB *, const float *,
+        const float *, float, float *, int)>
+inline void xdnn_compute_then_gelu(bool transA, int M, int N, int K, float alpha, const float *A, int lda,
+        const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+    Fn(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc);
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_gelu()});
+    #pragma omp parallel for
+    for (int i = 0; i < M; ++i) {
+        xdnn_apply_post_ops(&ops, i, 0, 1, N, C + (size_t)i * ldc, ldc);
+    }
+}
+
+// The blocked families: the block tuned for N x K and a team (tuning_db.h) if there is one, and
+// packb_size/packb with a given block. The default packb of the tables use the default block.
+inline XDNN_PACKB_BLOCK xdnn_bgemm_f32bf16f32_packb_block(int N, int K, int threads) {
+    return xdnn_packb_block("bgemm_f32bf16f32", N, K, {16, 64}, threads);
+}
+
+inline size_t xdnn_bgemm_f32bf16f32_packb_size_blocked(int N, int K, XDNN_PACKB_BLOCK b) {
+    return xdnn_bgemm_f32bf16f32_packb_size(N, K, b.block_rows, b.block_cols);
+}
+
+inline void xdnn_bgemm_f32bf16f32_packb_blocked(bool transB, int N, int K, const XDNN_BF16 *B, int ldb,
+        XDNN_BF16 *packedB, XDNN_PACKB_BLOCK b) {
+    xdnn_bgemm_f32bf16f32_packb(transB, N, K, B, ldb, packedB, b.block_rows, b.block_cols);
+}
+
+inline void xdnn_bgemm_f32bf16f32_default_packb(bool transB, int N, int K, const XDNN_BF16 *B, int ldb, XDNN_BF16 *packedB) {
+    xdnn_bgemm_f32bf16f32_packb(transB, N, K, B, ldb, packedB, 16, 64);
+}
+
+inline XDNN_PACKB_BLOCK xdnn_hgemm_f32f16f32_packb_block(int N, int K, int threads) {
+    return xdnn_packb_block("hgemm_f32f16f32", N, K, {0, 0}, threads);
+}
+
+inline size_t xdnn_hgemm_f32f16f32_packb_size_blocked(int N, int K, XDNN_PACKB_BLOCK b) {
+    return xdnn_hgemm_f32f16f32_packb_size(N, K, b.block_rows, b.block_cols);
+}
+
+inline void xdnn_hgemm_f32f16f32_packb_blocked(bool transB, int N, int K, const XDNN_FP16 *B, int ldb,
+        XDNN_FP16 *packedB, XDNN_PACKB_BLOCK b) {
+    if (b.block_rows > 0) {
+        xdnn_hgemm_f32f16f32_packb_block(transB, N, K, B, ldb, packedB, b.block_rows, b.block_cols);
+    } else {
+        xdnn_hgemm_f32f16f32_packb(transB, N, K, B, ldb, packedB);
+    }
+}
+
+#define XDNN_UNQUANTIZED_TABLE(family, TB, packb_size, packb, ...) \
+    { #family, XDNN_ISA_AMX, packb_size, nullptr, packb, \
+        xdnn_unquantized<TB>::call<xdnn_##family##_compute>, \
+        xdnn_unquantized<TB>::call<xdnn_##family##_compute_silu>, \
+        xdnn_unquantized<TB>::call<xdnn_##family##_compute_gelu>, \
+        xdnn_unquantized<TB, const float *>::call<xdnn_##family##_compute_biasadd>, \
+        xdnn_unquantized<TB, const float *>::call<xdnn_##family##_compute_biasadd_relu>, \
+        xdnn_unquantized<TB, const float *, const float *, int>::call<xdnn_##family##_compute_residential>, \
+        xdnn_unquantized<TB, const float *, float, const float *, int>::call<xdnn_##family##_compute_resext>, \
+        xdnn_unquantized<TB, const float *, int>::call<xdnn_##family##_compute_resmul>, nullptr, nullptr, 0, false \
+        __VA_OPT__(,) __VA_ARGS__ }
+
+#define XDNN_QUANTIZED_TABLE(family, TB, gelu) \
+    { #family, XDNN_ISA_AMX, xdnn_##family##_packb_size, xdnn_##family##_quantize, xdnn_##family##_packb, \
+        xdnn_##family##_compute, xdnn_##family##_compute_silu, gelu, \
+        xdnn_##family##_compute_biasadd, xdnn_##family##_compute_biasadd_relu, \
+        xdnn_##family##_compute_residential, xdnn_##family##_compute_resext, xdnn_##family##_compute_resmul, nullptr, \
+        xdnn_quantize_then_packb<TB, xdnn_##family##_quantize, xdnn_##family##_packb>, 0, false }
+
+// ================================================================================
+// Portable tables
+// ================================================================================
+template <typename Fmt, XDNN_CPU_ISA isa, int Group = 0>
+struct xdnn_plain_kernels {
+    using TB = typename Fmt::type;
+
+    static void quantize(bool transB, int N, int K, const float *B, int ldb,
+            float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB) {
+        if constexpr (Fmt::quantized) {
+            xdnn_plain_quantize<Fmt, Group>(transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB);
+        }
+    }
+
+    static void quantize_packb(bool transB, int N, int K, const void *B, XDNN_DATA_TYPE typeB, int ldb,
+            float quantization_rate, TB *packedB, float *scaleB, float *zeroB) {
+        if constexpr (Fmt::quantized) {
+            if (typeB == XDNN_DT_FP16) {
+                xdnn_plain_quantize_packb<Fmt, Group>(transB, N, K, (const XDNN_FP16 *)B, ldb, quantization_rate, packedB, scaleB, zeroB);
+            } else if (typeB == XDNN_DT_BF16) {
+                xdnn_plain_quantize_packb<Fmt, Group>(transB, N, K, (const XDNN_BF16 *)B, ldb, quantization_rate, packedB, scaleB, zeroB);
+            } else {
+                xdnn_plain_quantize_packb<Fmt, Group>(transB, N, K, (const float *)B, ldb, quantization_rate, packedB, scaleB, zeroB);
+            }
+        }
+    }
+
+    static void compute_post_ops(bool transA, int M, int N, int K, float alpha, const float *A, int lda,
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+            const XDNN_POST_OPS *ops) {
+        xdnn_plain_gemm_compute<Fmt, isa, Group>(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops);
+    }
+
+    static void run(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, XDNN_POST_OPS ops) {
+        xdnn_plain_gemm_compute<Fmt, isa, Group>(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, &ops);
+    }
+
+    static void compute(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({}));
+    }
+
+    static void compute_silu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_silu()}));
+    }
+
+    static void compute_gelu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_gelu()}));
+    }
+
+    static void compute_biasadd(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_bias(bias)}));
+    }
+
+    static void compute_biasadd_relu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_relu()}));
+    }
+
+    static void compute_residential(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres)}));
+    }
+
+    static void compute_resext(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias,
+            float gamma, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres, gamma)}));
+    }
+
+    static void compute_resmul(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_res_mul(res, ldres)}));
+    }
+
+    static XDNN_GEMM_KERNELS<TB> table(const char *name) {
+        return {name, isa, xdnn_plain_packb_size<Fmt>, Fmt::quantized ? quantize : nullptr, xdnn_plain_packb<Fmt>,
+                compute, compute_silu, compute_gelu, compute_biasadd, compute_biasadd_relu,
+                compute_residential, compute_resext, compute_resmul, compute_post_ops,
+                Fmt::quantized ? quantize_packb : nullptr, Group, xdnn_is_codebook<Fmt>,
+                nullptr, nullptr, nullptr, xdnn_plain_gemm_block<Fmt, isa, Group>};
+    }
+};
+
+template <typename TB>
+inline const XDNN_GEMM_KERNELS<TB> &xdnn_select_kernels(XDNN_CPU_ISA isa,
+        const XDNN_GEMM_KERNELS<TB> &amx, const XDNN_GEMM_KERNELS<TB> &avx512, const XDNN_GEMM_KERNELS<TB> &avx2) {
+    if (isa >= XDNN_ISA_AMX) return amx;
+    if (isa == XDNN_ISA_AVX512) return avx512;
+    return avx2;
+}
+
+#define XDNN_DEFINE_KERNELS(family, Fmt, amx_table) \
+    inline const XDNN_GEMM_KERNELS<Fmt::type> &xdnn_##family##_kernels(XDNN_CPU_ISA isa = xdnn_cpu_isa()) { \
+        static const XDNN_GEMM_KERNELS<Fmt::type> amx = amx_table; \
+        static const XDNN_GEMM_KERNELS<Fmt::type> avx512 = xdnn_plain_kernels<Fmt, XDNN_ISA_AVX512>::table(#family); \
+        static const XDNN_GEMM_KERNELS<Fmt::type> avx2 = xdnn_plain_kernels<Fmt, XDNN_ISA_AVX2>::table(#family); \
+        return xdnn_select_kernels(isa, amx, avx512, avx2); \
+    }
+
+XDNN_DEFINE_KERNELS(sgemm, xdnn_fmt_f32,
+        XDNN_UNQUANTIZED_TABLE(sgemm, float, xdnn_sgemm_packb_size, xdnn_sgemm_packb))
+XDNN_DEFINE_KERNELS(sgemm_f32f16f32, xdnn_fmt_f16,
+        XDNN_UNQUANTIZED_TABLE(sgemm_f32f16f32, XDNN_FP16, xdnn_sgemm_f32f16f32_packb_size, xdnn_sgemm_f32f16f32_packb))
+XDNN_DEFINE_KERNELS(hgemm_f32f16f32, xdnn_fmt_f16,
+        XDNN_UNQUANTIZED_TABLE(hgemm_f32f16f32, XDNN_FP16, xdnn_hgemm_f32f16f32_packb_size, xdnn_hgemm_f32f16f32_packb,
+                xdnn_hgemm_f32f16f32_packb_block, xdnn_hgemm_f32f16f32_packb_size_blocked, xdnn_hgemm_f32f16f32_packb_blocked))
+XDNN_DEFINE_KERNELS(bgemm_f32bf16f32, xdnn_fmt_bf16,
+        XDNN_UNQUANTIZED_TABLE(bgemm_f32bf16f32, XDNN_BF16, xdnn_bgemm_f32bf16f32_packb_size,
+                xdnn_bgemm_f32bf16f32_default_packb, xdnn_bgemm_f32bf16f32_packb_block,
+                xdnn_bgemm_f32bf16f32_packb_size_blocked, xdnn_bgemm_f32bf16f32_packb_blocked))
+XDNN_DEFINE_KERNELS(sgemm_f32s8f32, xdnn_fmt_s8,
+        XDNN_QUANTIZED_TABLE(sgemm_f32s8f32, int8_t, xdnn_sgemm_f32s8f32_compute_gelu))
+XDNN_DEFINE_KERNELS(hgemm_f32s8f32, xdnn_fmt_s8,
+        XDNN_QUANTIZED_TABLE(hgemm_f32s8f32, int8_t, xdnn_hgemm_f32s8f32_compute_gelu))
+XDNN_DEFINE_KERNELS(sgemm_f32i8f32, xdnn_fmt_s8,
+        XDNN_QUANTIZED_TABLE(sgemm_f32i8f32, int8_t, (xdnn_compute_then_gelu<int8_t, xdnn_sgemm_f32i8f32_compute>)))
+XDNN_DEFINE_KERNELS(hgemm_f32i8f32, xdnn_fmt_s8,
+        XDNN_QUANTIZED_TABLE(hgemm_f32i8f32, int8_t, (xdnn_compute_then_gelu<int8_t, xdnn_hgemm_f32i8f32_compute>)))
+XDNN_DEFINE_KERNELS(sgemm_f32u4f32, xdnn_fmt_u4,
+        XDNN_QUANTIZED_TABLE(sgemm_f32u4f32, XDNN_UINT4x2, xdnn_sgemm_f32u4f32_compute_gelu))
+XDNN_DEFINE_KERNELS(hgemm_f32u4f32, xdnn_fmt_u4,
+        XDNN_QUANTIZED_TABLE(hgemm_f32u4f32, XDNN_UINT4x2, xdnn_hgemm_f32u4f32_compute_gelu))
+XDNN_DEFINE_KERNELS(sgemm_f32nf4f32, xdnn_fmt_nf4,
+        XDNN_QUANTIZED_TABLE(sgemm_f32nf4f32, XDNN_NF4x2, xdnn_sgemm_f32nf4f32_compute_gelu))
+
+// ================================================================================
+// FP8 weights (E4M3, E5M2), not in the prebuilt library: the portable kernels on every tier,
+// upconverting each K block of B to fp32 in registers. An FP8 checkpoint is packed as it is
+// (_packb), with its per column scales as scaleB (or nullptr) and zeroB = nullptr;
+// _quantize makes FP8 B with a scale per column from fp32 B.
+// ================================================================================
+XDNN_DEFINE_KERNELS(sgemm_f32e4m3f32, xdnn_fmt_e4m3,
+        (xdnn_plain_kernels<xdnn_fmt_e4m3, XDNN_ISA_AMX>::table("sgemm_f32e4m3f32")))
+XDNN_DEFINE_KERNELS(sgemm_f32e5m2f32, xdnn_fmt_e5m2,
+        (xdnn_plain_kernels<xdnn_fmt_e5m2, XDNN_ISA_AMX>::table("sgemm_f32e5m2f32")))
+
+// The xdnn_<family>_* entry points of a family served by its kernel table only
+#define XDNN_DEFINE_TABLE_FAMILY(family, TB) \
+    inline void xdnn_##family##_quantize(bool transB, int N, int K, const float *B, int ldb, \
+            float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB) { \
+        xdnn_##family##_kernels().quantize(transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB); \
+    } \
+    inline void xdnn_##family##_packb(bool transB, int N, int K, const TB *B, int ldb, TB *packedB) { \
+        xdnn_##family##_kernels().packb(transB, N, K, B, ldb, packedB); \
+    } \
+    inline void xdnn_##family##_compute(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc) { \
+        xdnn_##family##_kernels().compute(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc); \
+    } \
+    inline void xdnn_##family##_compute_silu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc) { \
+        xdnn_##family##_kernels().compute_silu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc); \
+    } \
+    inline void xdnn_##family##_compute_gelu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc) { \
+        xdnn_##family##_kernels().compute_gelu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc); \
+    } \
+    inline void xdnn_##family##_compute_biasadd(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) { \
+        xdnn_##family##_kernels().compute_biasadd(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, bias); \
+    } \
+    inline void xdnn_##family##_compute_biasadd_relu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) { \
+        xdnn_##family##_kernels().compute_biasadd_relu(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, bias); \
+    } \
+    inline void xdnn_##family##_compute_residential(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc, \
+            const float *bias, const float *res, int ldres) { \
+        xdnn_##family##_kernels().compute_residential(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, \
+                bias, res, ldres); \
+    } \
+    inline void xdnn_##family##_compute_resext(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc, \
+            const float *bias, float gamma, const float *res, int ldres) { \
+        xdnn_##family##_kernels().compute_resext(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, \
+                bias, gamma, res, ldres); \
+    } \
+    inline void xdnn_##family##_compute_resmul(bool transA, int M, int N, int K, float alpha, const float *A, int lda, \
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc, \
+            const float *res, int ldres) { \
+        xdnn_##family##_kernels().compute_resmul(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, \
+                res, ldres); \
+    }
+
+XDNN_DEFINE_TABLE_FAMILY(sgemm_f32e4m3f32, XDNN_FP8_E4M3)
+XDNN_DEFINE_TABLE_FAMILY(sgemm_f32e5m2f32, XDNN_FP8_E5M2)
+
+// ================================================================================
+// 2-bit and 3-bit weights (XDNN_UINT2x4, XDNN_UINT3x8), quantized like u4: asymmetric per
+// column, dequantized as q * scale + zero, with the group-wise tables below for accuracy.
+// Not in the prebuilt library: the portable kernels on every tier, reading 1/2 and 3/4 of
+// the bytes of u4 per weight, which is what bounds decode (M = 1).
+// ================================================================================
+XDNN_DEFINE_KERNELS(sgemm_f32u2f32, xdnn_fmt_u2,
+        (xdnn_plain_kernels<xdnn_fmt_u2, XDNN_ISA_AMX>::table("sgemm_f32u2f32")))
+XDNN_DEFINE_KERNELS(sgemm_f32u3f32, xdnn_fmt_u3,
+        (xdnn_plain_kernels<xdnn_fmt_u3, XDNN_ISA_AMX>::table("sgemm_f32u3f32")))
+
+XDNN_DEFINE_TABLE_FAMILY(sgemm_f32u2f32, XDNN_UINT2x4)
+XDNN_DEFINE_TABLE_FAMILY(sgemm_f32u3f32, XDNN_UINT3x8)
+
+// ================================================================================
+// Group-wise quantized tables: one scale/zero per group of group_size (32, 64 or 128) rows
+// along K in each column, applied per group in the K loop of the portable kernels.
+// scaleB/zeroB hold xdnn_scale_count floats. The library kernels only take one scale per
+// column, so the AMX tier runs the AVX-512 kernels.
+//   const auto &kernels = xdnn_sgemm_f32u4f32_group_kernels(64);
+// ================================================================================
+#define XDNN_DEFINE_GROUP_KERNELS(family, Fmt) \
+    template <int Group> \
+    inline const XDNN_GEMM_KERNELS<Fmt::type> &xdnn_##family##_group_kernels(XDNN_CPU_ISA isa) { \
+        static const std::string name = #family "_g" + std::to_string(Group); \
+        static const XDNN_GEMM_KERNELS<Fmt::type> amx = xdnn_plain_kernels<Fmt, XDNN_ISA_AMX, Group>::table(name.c_str()); \
+        static const XDNN_GEMM_KERNELS<Fmt::type> avx512 = xdnn_plain_kernels<Fmt, XDNN_ISA_AVX512, Group>::table(name.c_str()); \
+        static const XDNN_GEMM_KERNELS<Fmt::type> avx2 = xdnn_plain_kernels<Fmt, XDNN_ISA_AVX2, Group>::table(name.c_str()); \
+        return xdnn_select_kernels(isa, amx, avx512, avx2); \
+    } \
+    inline const XDNN_GEMM_KERNELS<Fmt::type> &xdnn_##family##_group_kernels(int group_size, XDNN_CPU_ISA isa = xdnn_cpu_isa()) { \
+        assert(group_size == 32 || group_size == 64 || group_size == 128); \
+        if (group_size <= 32) return xdnn_##family##_group_kernels<32>(isa); \
+        if (group_size <= 64) return xdnn_##family##_group_kernels<64>(isa); \
+        return xdnn_##family##_group_kernels<128>(isa); \
+    }
+
+XDNN_DEFINE_GROUP_KERNELS(sgemm_f32s8f32, xdnn_fmt_s8)
+XDNN_DEFINE_GROUP_KERNELS(sgemm_f32u4f32, xdnn_fmt_u4)
+XDNN_DEFINE_GROUP_KERNELS(sgemm_f32nf4f32, xdnn_fmt_nf4)
+XDNN_DEFINE_GROUP_KERNELS(sgemm_f32u2f32, xdnn_fmt_u2)
+XDNN_DEFINE_GROUP_KERNELS(sgemm_f32u3f32, xdnn_fmt_u3)
+
+// ================================================================================
+// NF4 with a codebook given by the caller: the 4-bit values index a 16 entry codebook
+// instead of XDNN_NORMAL_FLOAT32, with one codebook for the tensor (group_size = 0) or one
+// per group of group_size rows along K. zeroB is the codebooks (xdnn_zero_count floats,
+// 16 per group) for _quantize, which picks the nearest entry, and for the compute, which
+// looks the values up the same way as NF4. Portable kernels on every tier.
+//   float codebook[16] = {...}; // e.g. the 16 values of FP4-E2M1
+//   const auto &kernels = xdnn_sgemm_f32nf4f32_codebook_kernels();
+//   kernels.quantize(transB, N, K, B, ldb, 1.0f, quantizedB, ldqb, scaleB, codebook);
+//   xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A, lda, packedB, scaleB, codebook, 0.0f, C, ldc, &ops);
+// ================================================================================
+template <int Group>
+inline const XDNN_GEMM_KERNELS<XDNN_NF4x2> &xdnn_sgemm_f32nf4f32_codebook_kernels(XDNN_CPU_ISA isa) {
+    static const std::string name = Group ? "sgemm_f32nf4f32_cb_g" + std::to_string(Group) : "sgemm_f32nf4f32_cb";
+    static const XDNN_GEMM_KERNELS<XDNN_NF4x2> amx = xdnn_plain_kernels<xdnn_fmt_cb4, XDNN_ISA_AMX, Group>::table(name.c_str());
+    static const XDNN_GEMM_KERNELS<XDNN_NF4x2> avx512 = xdnn_plain_kernels<xdnn_fmt_cb4, XDNN_ISA_AVX512, Group>::table(name.c_str());
+    static const XDNN_GEMM_KERNELS<XDNN_NF4x2> avx2 = xdnn_plain_kernels<xdnn_fmt_cb4, XDNN_ISA_AVX2, Group>::table(name.c_str());
+    return xdnn_select_kernels(isa, amx, avx512, avx2);
+}
+
+inline const XDNN_GEMM_KERNELS<XDNN_NF4x2> &xdnn_sgemm_f32nf4f32_codebook_kernels(int group_size = 0,
+        XDNN_CPU_ISA isa = xdnn_cpu_isa()) {
+    assert(group_size == 0 || group_size == 32 || group_size == 64 || group_size == 128);
+    if (group_size <= 0) return xdnn_sgemm_f32nf4f32_codebook_kernels<0>(isa);
+    if (group_size <= 32) return xdnn_sgemm_f32nf4f32_codebook_kernels<32>(isa);
+    if (group_size <= 64) return xdnn_sgemm_f32nf4f32_codebook_kernels<64>(isa);
+    return xdnn_sgemm_f32nf4f32_codebook_kernels<128>(isa);
+}
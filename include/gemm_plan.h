@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <omp.h>
+
+#include "gemm_kernels.h"
+#include "packed_b.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+// ================================================================================
+// Execution plan of C = ops(alpha * A * packedB + beta * C) for one shape, so a serving loop
+// repeating the same few shapes pays for the planning once:
+//   XDNN_GEMM_PLAN<float> plan = xdnn_plan_create(packedB, false, M, alpha, lda, beta, ldc, &ops);
+//   xdnn_plan_execute(plan, A, C);
+// The plan holds the row blocks x panels partition for the thread count current at creation
+// (inside an XDNN_THREAD_SCOPE, its budget), and the epilogue resolved on the kernel table:
+// alpha/beta with a leading scale folded in, and the fixed entry point fusing the head of the chain.
+// On the portable tables each tile runs on compute_block, in the plan's tiles with no planning of
+// the kernel's own, and with the chain of its panel bound once per plan instead of per tile.
+// The plan keeps a copy of the XDNN_PACKED_B descriptor, so it may be built from a temporary one;
+// the packed data, scales and the buffers of ops are referenced, not copied.
+// ================================================================================
+template <typename TB>
+struct XDNN_GEMM_PLAN {
+    XDNN_PACKED_B<TB> packedB;
+    bool transA;
+    int M;
+    int lda;
+    int ldc;
+    int threads;            // team size the partition is made for
+    int mblocks;
+    int rows;               // rows per row block
+    int tasks;              // mblocks x panels
+    float alpha;            // as given to xdnn_plan_create/xdnn_plan_set_post_ops
+    float beta;
+    XDNN_POST_OPS ops;
+    XDNN_GEMM_EPILOGUE epilogue;
+    std::vector<XDNN_POST_OPS> panel_chain; // epilogue.chain from the first column of each panel (compute_block)
+};
+
+// The chain of each panel, for the tables with compute_block
+template <typename TB>
+inline void xdnn_plan_bind_panels(XDNN_GEMM_PLAN<TB> &plan) {
+    const XDNN_PACKED_B<TB> &packedB = plan.packedB;
+    if (!packedB.kernels->compute_block) return;
+    plan.panel_chain.resize(packedB.panels);
+    for (int p = 0; p < packedB.panels; ++p) {
+        plan.panel_chain[p] = xdnn_post_ops_at(&plan.epilogue.chain, 0, p * packedB.panel_cols);
+    }
+}
+
+template <typename TB>
+inline XDNN_GEMM_PLAN<TB> xdnn_plan_create(const XDNN_PACKED_B<TB> &packedB, bool transA, int M,
+        float alpha, int lda, float beta, int ldc, const XDNN_POST_OPS *ops = nullptr) {
+    XDNN_GEMM_PLAN<TB> plan;
+    plan.packedB = packedB;
+    plan.transA = transA;
+    plan.M = M;
+    plan.lda = lda;
+    plan.ldc = ldc;
+    plan.threads = omp_get_max_threads();
+    plan.mblocks = xdnn_row_blocks(M, packedB.panels, plan.threads);
+    plan.rows = (M + plan.mblocks - 1) / plan.mblocks;
+    plan.mblocks = M > 0 ? (M + plan.rows - 1) / plan.rows : 0; // no empty trailing block
+    plan.tasks = plan.mblocks * packedB.panels;
+    plan.alpha = alpha;
+    plan.beta = beta;
+    plan.ops = xdnn_post_ops_tail(ops, 0);
+    plan.epilogue = xdnn_gemm_epilogue(*packedB.kernels, alpha, beta, ops);
+    xdnn_plan_bind_panels(plan);
+    return plan;
+}
+
+// New alpha, beta or chain, e.g. the residual of this step. The same alpha, beta and chain
+// kinds (xdnn_post_ops_same_kinds) only rebind the buffers of the resolved epilogue.
+template <typename TB>
+inline void xdnn_plan_set_post_ops(XDNN_GEMM_PLAN<TB> &plan, float alpha, float beta, const XDNN_POST_OPS *ops) {
+    if (alpha == plan.alpha && beta == plan.beta && xdnn_post_ops_same_kinds(&plan.ops, ops)) {
+        xdnn_gemm_epilogue_rebind(plan.epilogue, ops);
+    } else {
+        plan.alpha = alpha;
+        plan.beta = beta;
+        plan.epilogue = xdnn_gemm_epilogue(*plan.packedB.kernels, alpha, beta, ops);
+    }
+    plan.ops = xdnn_post_ops_tail(ops, 0);
+    xdnn_plan_bind_panels(plan);
+}
+
+// Tile t of the plan, single threaded
+template <typename TB>
+inline void xdnn_plan_execute_tile(const XDNN_GEMM_PLAN<TB> &plan, int t, const float *A, float *C) {
+    const XDNN_PACKED_B<TB> &packedB = plan.packedB;
+    int p = t % packedB.panels;
+    int m0 = (t / packedB.panels) * plan.rows;
+    int rows = std::min(plan.rows, plan.M - m0);
+    int n0 = p * packedB.panel_cols;
+    size_t offset = xdnn_scale_offset(*packedB.kernels, packedB.K, n0);
+    size_t zero_offset = xdnn_zero_offset(*packedB.kernels, packedB.K, n0);
+    const TB *panel = packedB.data + p * packedB.panel_stride;
+    const float *scaleB = packedB.scaleB ? packedB.scaleB + offset : nullptr;
+    const float *zeroB = packedB.zeroB ? packedB.zeroB + zero_offset : nullptr;
+
+    // A single tile for a team is left to the kernel's own tiling and split-K, which spread it
+    // over the threads; otherwise the plan's tiles are the kernel's work as they are
+    if (packedB.kernels->compute_block && (plan.tasks > 1 || plan.threads == 1)) {
+        // A, C and the chain of the panel in the rows of the whole matrices
+        packedB.kernels->compute_block(plan.transA, xdnn_panel_cols_of(packedB, p), packedB.K, plan.epilogue.alpha,
+                A, plan.lda, panel, scaleB, zeroB, plan.epilogue.beta, C + n0, plan.ldc, &plan.panel_chain[p], m0, rows);
+        return;
+    }
+
+    const float *a = plan.transA ? A + m0 : A + (size_t)m0 * plan.lda;
+    xdnn_gemm_compute_epilogue(*packedB.kernels, xdnn_gemm_epilogue_at(plan.epilogue, m0, n0), plan.transA,
+            rows, xdnn_panel_cols_of(packedB, p), packedB.K, a, plan.lda, panel, scaleB, zeroB,
+            C + (size_t)m0 * plan.ldc + n0, plan.ldc);
+}
+
+// A is in M x K (K x M if transA), C in M x packedB.N with the strides of the plan
+template <typename TB>
+inline void xdnn_plan_execute(const XDNN_GEMM_PLAN<TB> &plan, const float *A, float *C) {
+    xdnn_parallel_for(plan.tasks, [&](int t) { xdnn_plan_execute_tile(plan, t, A, C); });
+}
+
+#define XDNN_PLAN_CACHE_CAPACITY 256 // plans kept by an XDNN_PLAN_CACHE unless given
+
+// Plans of the shapes seen so far, keyed by the contents of packedB (kernel table, N, K,
+// panel_cols, data, scaleB, zeroB; the dtype is TB and the table tells u4 from nf4) and by
+// transA, M, lda, ldc and threads, for callers that don't keep the plans themselves:
+//   XDNN_PLAN_CACHE<float> cache;
+//   xdnn_plan_execute(cache.get(packedB, false, M, 1.0f, K, 0.0f, N, &ops), A, C);
+// At most capacity plans are kept, a new shape drops the least recently used one, so a
+// serving loop seeing every M up to the context length doesn't grow the cache without end.
+// A cache is not thread safe, use one per serving thread.
+template <typename TB>
+class XDNN_PLAN_CACHE {
+public:
+    explicit XDNN_PLAN_CACHE(size_t capacity = XDNN_PLAN_CACHE_CAPACITY) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    // The plan of the shape with the epilogue bound to alpha, beta and ops, valid until
+    // capacity other shapes have been requested
+    const XDNN_GEMM_PLAN<TB> &get(const XDNN_PACKED_B<TB> &packedB, bool transA, int M,
+            float alpha, int lda, float beta, int ldc, const XDNN_POST_OPS *ops = nullptr) {
+        key k = {packedB.kernels, packedB.N, packedB.K, packedB.panel_cols, packedB.data, packedB.scaleB, packedB.zeroB,
+                transA, M, lda, ldc, omp_get_max_threads()};
+        auto it = index_.find(k);
+        if (it != index_.end()) {
+            plans_.splice(plans_.begin(), plans_, it->second);
+            xdnn_plan_set_post_ops(it->second->second, alpha, beta, ops);
+            return it->second->second;
+        }
+
+        if (plans_.size() >= capacity_) {
+            index_.erase(plans_.back().first);
+            plans_.pop_back();
+        }
+        plans_.emplace_front(k, xdnn_plan_create(packedB, transA, M, alpha, lda, beta, ldc, ops));
+        index_.emplace(k, plans_.begin());
+        return plans_.front().second;
+    }
+
+    size_t size() const {
+        return plans_.size();
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // Drops all plans, e.g. to free them once the weights they refer to are released
+    void clear() {
+        index_.clear();
+        plans_.clear();
+    }
+
+private:
+    struct key {
+        const XDNN_GEMM_KERNELS<TB> *kernels;
+        int N, K, panel_cols;
+        const TB *data;
+        const float *scaleB;
+        const float *zeroB;
+        bool transA;
+        int M, lda, ldc, threads;
+
+        bool operator==(const key &o) const {
+            return kernels == o.kernels && N == o.N && K == o.K && panel_cols == o.panel_cols && data == o.data
+                    && scaleB == o.scaleB && zeroB == o.zeroB && transA == o.transA && M == o.M && lda == o.lda
+                    && ldc == o.ldc && threads == o.threads;
+        }
+    };
+
+    struct key_hash {
+        size_t operator()(const key &k) const {
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (uint64_t v : {(uint64_t)(uintptr_t)k.kernels, (uint64_t)k.N, (uint64_t)k.K, (uint64_t)k.panel_cols,
+                    (uint64_t)(uintptr_t)k.data, (uint64_t)(uintptr_t)k.scaleB, (uint64_t)(uintptr_t)k.zeroB,
+                    (uint64_t)k.transA, (uint64_t)k.M, (uint64_t)k.lda, (uint64_t)k.ldc, (uint64_t)k.threads}) {
+                h = (h ^ v) * 0x100000001b3ull;
+            }
+            return h;
+        }
+    };
+
+    size_t capacity_;
+    std::list<std::pair<key, XDNN_GEMM_PLAN<TB>>> plans_; // most recently used first
+    std::unordered_map<key, typename std::list<std::pair<key, XDNN_GEMM_PLAN<TB>>>::iterator, key_hash> index_;
+};
@@ -0,0 +1,776 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <omp.h>
+
+#include "cpu_isa.h"
+#include "parallel.h"
+#include "post_ops.h"
+#include "prefetch.h"
+#include "data_types/data_types.h"
+
+// ================================================================================
+// Portable kernels used on CPUs the prebuilt library does not target (AVX2, AVX-512
+// without FP16/BF16/AMX). Weights use the "plain" packed format: K rows of N values,
+// 4-bit values are stored two per byte along N with the row padded to an even count
+// (2-bit values four per byte, 3-bit values eight per 3 bytes, xdnn_values_per).
+// Leading dimensions of 4/3/2-bit matrices are counted in values, not bytes.
+// ================================================================================
+
+#define XDNN_PLAIN_NB 64 // columns per tile
+#define XDNN_PLAIN_KB 64 // K rows decoded per step
+#define XDNN_PLAIN_MB 64 // rows per tile
+#define XDNN_PLAIN_SPLITK_MIN 1024 // fewest rows of K per slice of split-K
+#define XDNN_PLAIN_GEMV_NB 256 // widest column tile of the M = 1 kernel
+#define XDNN_PLAIN_GEMV_KB 4 // rows of K summed per step by the M = 1 kernel
+#define XDNN_PLAIN_GEMV_PREFETCH 16 // rows of K prefetched ahead by the M = 1 kernel
+
+inline uint8_t xdnn_get_u4(const XDNN_UINT4x2 *base, size_t idx) {
+    XDNN_UINT4x2 v = base[idx >> 1];
+    return (idx & 1) ? v.get_v2() : v.get_v1();
+}
+
+inline void xdnn_set_u4(XDNN_UINT4x2 *base, size_t idx, uint8_t val) {
+    XDNN_UINT4x2 v = base[idx >> 1];
+    base[idx >> 1] = (idx & 1) ? XDNN_UINT4x2(v.get_v1(), val) : XDNN_UINT4x2(val, v.get_v2());
+}
+
+// Value idx of a 4, 2 or 3-bit matrix
+template <typename TB>
+inline uint8_t xdnn_get_packed(const TB *base, size_t idx) {
+    if constexpr (std::is_same_v<TB, XDNN_UINT4x2>) {
+        return xdnn_get_u4(base, idx);
+    } else {
+        constexpr int per = xdnn_values_per<TB>;
+        return base[idx / per].get(idx % per);
+    }
+}
+
+template <typename TB>
+inline void xdnn_set_packed(TB *base, size_t idx, uint8_t val) {
+    if constexpr (std::is_same_v<TB, XDNN_UINT4x2>) {
+        xdnn_set_u4(base, idx, val);
+    } else {
+        constexpr int per = xdnn_values_per<TB>;
+        base[idx / per].set(idx % per, val);
+    }
+}
+
+// Weight formats. decode() converts cols values of packed row 'row' starting at column n0 into floats
+struct xdnn_fmt_f32 {
+    using type = float;
+    static constexpr bool quantized = false;
+    static void decode(const float *row, int n0, int cols, float *dst) {
+        #pragma omp simd
+        for (int j = 0; j < cols; ++j) dst[j] = row[n0 + j];
+    }
+};
+
+struct xdnn_fmt_f16 {
+    using type = XDNN_FP16;
+    static constexpr bool quantized = false;
+    static void decode(const XDNN_FP16 *row, int n0, int cols, float *dst) {
+        xdnn_fp16_to_float(row + n0, cols, dst);
+    }
+};
+
+struct xdnn_fmt_bf16 {
+    using type = XDNN_BF16;
+    static constexpr bool quantized = false;
+    static void decode(const XDNN_BF16 *row, int n0, int cols, float *dst) {
+        xdnn_bf16_to_float(row + n0, cols, dst);
+    }
+};
+
+// Symmetric int8, dequantized as q * scale + zero
+struct xdnn_fmt_s8 {
+    using type = int8_t;
+    static constexpr bool quantized = true;
+    static constexpr int qmin = -127;
+    static constexpr int qmax = 127;
+    static void decode(const int8_t *row, int n0, int cols, float *dst) {
+        #pragma omp simd
+        for (int j = 0; j < cols; ++j) dst[j] = row[n0 + j];
+    }
+};
+
+// Asymmetric uint4, dequantized as q * scale + zero
+struct xdnn_fmt_u4 {
+    using type = XDNN_UINT4x2;
+    static constexpr bool quantized = true;
+    static constexpr int qmin = 0;
+    static constexpr int qmax = 15;
+    static void decode(const XDNN_UINT4x2 *row, int n0, int cols, float *dst) {
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(row);
+        int j = 0;
+        // Both values of each whole byte (tiles start at even columns)
+        if (n0 % 2 == 0) {
+            const uint8_t *p = raw + n0 / 2;
+            #pragma omp simd
+            for (int i = 0; i < cols / 2; ++i) {
+                dst[2 * i] = p[i] & 0x0F;
+                dst[2 * i + 1] = p[i] >> 4;
+            }
+            j = cols / 2 * 2;
+        }
+        for (; j < cols; ++j) {
+            int n = n0 + j;
+            dst[j] = (raw[n >> 1] >> ((n & 1) * 4)) & 0x0F;
+        }
+    }
+};
+
+// Asymmetric uint2 and uint3, dequantized as q * scale + zero like uint4
+struct xdnn_fmt_u2 {
+    using type = XDNN_UINT2x4;
+    static constexpr bool quantized = true;
+    static constexpr int qmin = 0;
+    static constexpr int qmax = 3;
+    static void decode(const XDNN_UINT2x4 *row, int n0, int cols, float *dst) {
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(row);
+        int j = 0;
+        if (n0 % 4 == 0) {
+            const uint8_t *p = raw + n0 / 4;
+            #pragma omp simd
+            for (int i = 0; i < cols / 4; ++i) {
+                dst[4 * i] = p[i] & 0x03;
+                dst[4 * i + 1] = (p[i] >> 2) & 0x03;
+                dst[4 * i + 2] = (p[i] >> 4) & 0x03;
+                dst[4 * i + 3] = p[i] >> 6;
+            }
+            j = cols / 4 * 4;
+        }
+        for (; j < cols; ++j) {
+            int n = n0 + j;
+            dst[j] = (raw[n >> 2] >> ((n & 3) * 2)) & 0x03;
+        }
+    }
+};
+
+struct xdnn_fmt_u3 {
+    using type = XDNN_UINT3x8;
+    static constexpr bool quantized = true;
+    static constexpr int qmin = 0;
+    static constexpr int qmax = 7;
+    static void decode(const XDNN_UINT3x8 *row, int n0, int cols, float *dst) {
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(row);
+        int j = 0;
+        // Whole groups of 8 values from one 24-bit word
+        for (; j < cols && (n0 + j) % 8 != 0; ++j) dst[j] = row[(n0 + j) >> 3].get((n0 + j) & 7);
+        for (; j + 8 <= cols; j += 8) {
+            const uint8_t *p = raw + (size_t)((n0 + j) >> 3) * 3;
+            uint32_t w = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+            for (int i = 0; i < 8; ++i) dst[j + i] = (w >> (i * 3)) & 0x07;
+        }
+        for (; j < cols; ++j) dst[j] = row[(n0 + j) >> 3].get((n0 + j) & 7);
+    }
+};
+
+// 4-bit indices into a 16 entry table
+inline void xdnn_decode_lut4(const XDNN_UINT4x2 *row, int n0, int cols, const float *lut, float *dst) {
+    const uint8_t *raw = reinterpret_cast<const uint8_t *>(row);
+    int j = 0;
+    if (n0 % 2 == 0) {
+        const uint8_t *p = raw + n0 / 2;
+#if defined(__AVX2__)
+        // 16 values at a time, each lookup two 8 entry permutes blended on bit 3 of the index
+        __m256 lut_lo = _mm256_loadu_ps(lut);
+        __m256 lut_hi = _mm256_loadu_ps(lut + 8);
+        auto lookup = [&](__m256i idx) {
+            return _mm256_blendv_ps(_mm256_permutevar8x32_ps(lut_lo, idx), _mm256_permutevar8x32_ps(lut_hi, idx),
+                    _mm256_castsi256_ps(_mm256_slli_epi32(idx, 28)));
+        };
+        for (; j + 16 <= cols; j += 16) {
+            __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(p + j / 2)));
+            __m256 even = lookup(_mm256_and_si256(v, _mm256_set1_epi32(0x0F)));
+            __m256 odd = lookup(_mm256_srli_epi32(v, 4));
+            __m256 lo = _mm256_unpacklo_ps(even, odd);
+            __m256 hi = _mm256_unpackhi_ps(even, odd);
+            _mm256_storeu_ps(dst + j, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(dst + j + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+#endif
+        #pragma omp simd
+        for (int i = j / 2; i < cols / 2; ++i) {
+            int v = p[i];
+            dst[2 * i] = lut[v & 0x0F];
+            dst[2 * i + 1] = lut[v >> 4];
+        }
+        j = cols / 2 * 2;
+    }
+    for (; j < cols; ++j) {
+        int n = n0 + j;
+        dst[j] = lut[(raw[n >> 1] >> ((n & 1) * 4)) & 0x0F];
+    }
+}
+
+// NormalFloat4, dequantized as XDNN_NORMAL_FLOAT32[q] * scale + zero
+struct xdnn_fmt_nf4 {
+    using type = XDNN_NF4x2;
+    static constexpr bool quantized = true;
+    static void decode(const XDNN_NF4x2 *row, int n0, int cols, float *dst) {
+        xdnn_decode_lut4(row, n0, cols, XDNN_NORMAL_FLOAT32, dst);
+    }
+};
+
+// NF4 with a 16 entry codebook given by the caller (FP4-E2M1, learned, k-means, ...),
+// dequantized as codebook[q] * scale. zeroB carries the codebooks instead of zeros:
+// 16 floats per group of rows along K (one codebook for all of K without groups),
+// shared by all columns.
+struct xdnn_fmt_cb4 {
+    using type = XDNN_NF4x2;
+    static constexpr bool quantized = true;
+    static void decode(const XDNN_NF4x2 *row, int n0, int cols, const float *codebook, float *dst) {
+        xdnn_decode_lut4(row, n0, cols, codebook, dst);
+    }
+};
+
+template <typename Fmt>
+inline constexpr bool xdnn_is_codebook = std::is_same_v<Fmt, xdnn_fmt_cb4>;
+
+#define XDNN_CODEBOOK_SIZE 16
+
+// Largest magnitude of a codebook, the value the largest weight of a group is scaled to
+inline float xdnn_codebook_max(const float *codebook) {
+    float m = 0.0f;
+    for (int i = 0; i < XDNN_CODEBOOK_SIZE; ++i) m = std::max(m, std::fabs(codebook[i]));
+    return m;
+}
+
+// FP8 with a scale per column, dequantized as q * scale (zero is 0). B in FP8 with scaleB = nullptr
+// computes with B as it is.
+struct xdnn_fmt_e4m3 {
+    using type = XDNN_FP8_E4M3;
+    static constexpr bool quantized = true;
+    static constexpr float qmax = XDNN_FP8_E4M3::max();
+    static void decode(const XDNN_FP8_E4M3 *row, int n0, int cols, float *dst) {
+        xdnn_e4m3_to_float(row + n0, cols, dst);
+    }
+};
+
+struct xdnn_fmt_e5m2 {
+    using type = XDNN_FP8_E5M2;
+    static constexpr bool quantized = true;
+    static constexpr float qmax = XDNN_FP8_E5M2::max();
+    static void decode(const XDNN_FP8_E5M2 *row, int n0, int cols, float *dst) {
+        xdnn_e5m2_to_float(row + n0, cols, dst);
+    }
+};
+
+// Elements of type per packed row
+template <typename Fmt>
+inline size_t xdnn_plain_row_elems(int N) {
+    constexpr int per = xdnn_values_per<typename Fmt::type>;
+    return ((size_t)N + per - 1) / per;
+}
+
+// Scales (and zeros) per column of B: one per group of group_size rows along K, or one for
+// all of K if group_size = 0. Those of column n are scaleB[n * groups + g], so the scales
+// of a range of columns start at scaleB + n0 * groups.
+inline int xdnn_scale_groups(int K, int group_size) {
+    return group_size > 0 ? (K + group_size - 1) / group_size : 1;
+}
+
+template <typename Fmt>
+inline size_t xdnn_plain_packb_size(int N, int K) {
+    return (size_t)K * xdnn_plain_row_elems<Fmt>(N);
+}
+
+// B is in K x N if transB = false
+// B is in N x K if transB = true
+template <typename Fmt>
+inline void xdnn_plain_packb(bool transB, int N, int K, const typename Fmt::type *B, int ldb, typename Fmt::type *packedB) {
+    const size_t row = xdnn_plain_row_elems<Fmt>(N);
+
+    #pragma omp parallel for
+    for (int k = 0; k < K; ++k) {
+        typename Fmt::type *dst = packedB + k * row;
+        if constexpr (xdnn_values_per<typename Fmt::type> > 1) {
+            memset((void *)dst, 0, row * sizeof(typename Fmt::type));
+            for (int n = 0; n < N; ++n) {
+                size_t src = transB ? (size_t)n * ldb + k : (size_t)k * ldb + n;
+                xdnn_set_packed(dst, n, xdnn_get_packed(B, src));
+            }
+        } else if (!transB) {
+            memcpy((void *)dst, B + (size_t)k * ldb, N * sizeof(typename Fmt::type));
+        } else {
+            for (int n = 0; n < N; ++n) {
+                dst[n] = B[(size_t)n * ldb + k];
+            }
+        }
+    }
+}
+
+// Scale and zero of a column whose kept values are in [lo, hi]. A codebook format
+// keeps zero (its codebook) as it is.
+template <typename Fmt>
+inline void xdnn_plain_quantize_params(float lo, float hi, float &scale, float &zero, const float *codebook = nullptr) {
+    if constexpr (std::is_same_v<Fmt, xdnn_fmt_u4> || std::is_same_v<Fmt, xdnn_fmt_u2> || std::is_same_v<Fmt, xdnn_fmt_u3>) {
+        scale = (hi - lo) / Fmt::qmax;
+        zero = lo;
+    } else if constexpr (std::is_same_v<Fmt, xdnn_fmt_nf4>) {
+        scale = std::max(std::fabs(lo), std::fabs(hi));
+        zero = 0.0f;
+    } else if constexpr (xdnn_is_codebook<Fmt>) {
+        float m = xdnn_codebook_max(codebook);
+        scale = m > 0.0f ? std::max(std::fabs(lo), std::fabs(hi)) / m : 0.0f;
+    } else {
+        scale = std::max(std::fabs(lo), std::fabs(hi)) / Fmt::qmax;
+        zero = 0.0f;
+    }
+    if (scale == 0.0f) scale = 1.0f;
+}
+
+// Store v quantized with scale/zero at element idx of quantizedB, the nearest entry of
+// the codebook (XDNN_NORMAL_FLOAT32 for NF4) for the codebook formats
+template <typename Fmt>
+inline void xdnn_plain_quantize_value(float v, float scale, float zero, typename Fmt::type *quantizedB, size_t idx,
+        const float *codebook = XDNN_NORMAL_FLOAT32) {
+    if constexpr (std::is_same_v<Fmt, xdnn_fmt_nf4> || xdnn_is_codebook<Fmt>) {
+        v = v / scale;
+        int best = 0;
+        for (int q = 1; q < XDNN_CODEBOOK_SIZE; ++q) {
+            if (std::fabs(codebook[q] - v) < std::fabs(codebook[best] - v)) best = q;
+        }
+        xdnn_set_u4(quantizedB, idx, best);
+    } else if constexpr (xdnn_is_fp8<typename Fmt::type>) {
+        quantizedB[idx] = v / scale;
+    } else {
+        int q = (int)std::nearbyint((v - zero) / scale);
+        q = std::clamp(q, Fmt::qmin, Fmt::qmax);
+        if constexpr (xdnn_values_per<typename Fmt::type> > 1) {
+            xdnn_set_packed(quantizedB, idx, q);
+        } else {
+            quantizedB[idx] = q;
+        }
+    }
+}
+
+// Per column quantization of B (fp32, fp16 or bf16), per group of Group rows along K if Group > 0.
+// quantization_rate keeps the central part of the value distribution and clips the tails, as
+// the library's _quantize does. quantizedB is N x K if transQ, K x N otherwise, with stride ldq (in values).
+template <typename Fmt, int Group = 0, typename TS>
+inline void xdnn_plain_quantize_into(bool transB, int N, int K, const TS *B, int ldb, float quantization_rate,
+        typename Fmt::type *quantizedB, int ldq, bool transQ, float *scaleB, float *zeroB) {
+    static_assert(Fmt::quantized, "only quantized formats can be quantized");
+
+    float rate = std::clamp(quantization_rate, 0.0f, 1.0f);
+    const int groups = xdnn_scale_groups(K, Group);
+    const int group_rows = Group > 0 ? Group : K;
+
+    // 4-bit values of two columns may share a byte (2-bit of 4, 3-bit of 8): columns go by
+    // such runs, on one thread if ldq is not a multiple of them
+    const int step = xdnn_values_per<typename Fmt::type>;
+    const bool parallel = ldq % step == 0;
+
+    #pragma omp parallel for if(parallel)
+    for (int n0 = 0; n0 < N; n0 += step) {
+        std::vector<float> col(K);
+        std::vector<float> sorted(group_rows);
+        for (int n = n0; n < std::min(N, n0 + step); ++n) {
+            if (transB) {
+                xdnn_to_float(xdnn_data_type_of<TS>(), B + (size_t)n * ldb, K, col.data());
+            } else {
+                for (int k = 0; k < K; ++k) col[k] = static_cast<float>(B[(size_t)k * ldb + n]);
+            }
+
+            for (int g = 0; g < groups; ++g) {
+                int k0 = g * group_rows;
+                int rows = std::min(group_rows, K - k0);
+                // zeroB of a codebook format holds the codebook of each group
+                const float *codebook = xdnn_is_codebook<Fmt> ? zeroB + XDNN_CODEBOOK_SIZE * g : XDNN_NORMAL_FLOAT32;
+                float unused;
+                float &scale = scaleB[(size_t)n * groups + g];
+                float &zero = xdnn_is_codebook<Fmt> ? unused : zeroB[(size_t)n * groups + g];
+
+                std::copy(col.begin() + k0, col.begin() + k0 + rows, sorted.begin());
+                std::sort(sorted.begin(), sorted.begin() + rows);
+                int lo_idx = (int)std::floor((1.0f - rate) * 0.5f * (rows - 1));
+                int hi_idx = (int)std::ceil((1.0f + rate) * 0.5f * (rows - 1));
+                xdnn_plain_quantize_params<Fmt>(sorted[lo_idx], sorted[std::min(hi_idx, rows - 1)], scale, zero, codebook);
+
+                for (int k = k0; k < k0 + rows; ++k) {
+                    size_t idx = transQ ? (size_t)n * ldq + k : (size_t)k * ldq + n;
+                    xdnn_plain_quantize_value<Fmt>(col[k], scale, zero, quantizedB, idx, codebook);
+                }
+            }
+        }
+    }
+}
+
+template <typename Fmt, int Group = 0>
+inline void xdnn_plain_quantize(bool transB, int N, int K, const float *B, int ldb,
+        float quantization_rate, typename Fmt::type *quantizedB, int ldqb, float *scaleB, float *zeroB) {
+    xdnn_plain_quantize_into<Fmt, Group>(transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, transB, scaleB, zeroB);
+}
+
+// Quantize straight into the packed layout (xdnn_plain_packb_size elements), in one pass over B
+template <typename Fmt, int Group = 0, typename TS>
+inline void xdnn_plain_quantize_packb(bool transB, int N, int K, const TS *B, int ldb,
+        float quantization_rate, typename Fmt::type *packedB, float *scaleB, float *zeroB) {
+    int ldq = xdnn_values_per<typename Fmt::type> * (int)xdnn_plain_row_elems<Fmt>(N);
+    xdnn_plain_quantize_into<Fmt, Group>(transB, N, K, B, ldb, quantization_rate, packedB, ldq, false, scaleB, zeroB);
+}
+
+// Compute C[m0:m0+rows, n0:n0+cols] = ops(alpha * A[:, k_begin:k_end] * packedB[k_begin:k_end, :] + beta * C).
+// Single threaded; the tile fits XDNN_PLAIN_NB columns. The chain runs on each row
+// right after its last K block is accumulated. With a STREAM op and beta = 0 the tile
+// sums into a local block instead of C, and each finished row is streamed to C.
+template <typename Fmt, int Group = 0>
+inline void xdnn_plain_gemm_tile(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end) {
+    const size_t row_elems = xdnn_plain_row_elems<Fmt>(N);
+    const int groups = xdnn_scale_groups(K, Group);
+    float bbuf[XDNN_PLAIN_KB][XDNN_PLAIN_NB];
+    float scale[XDNN_PLAIN_NB];
+    float zero[XDNN_PLAIN_NB];
+    int group = -1; // the group scale/zero hold
+    const float *codebook = nullptr;
+    const bool stream = beta == 0.0f && k_begin < k_end && xdnn_post_ops_has(ops, XDNN_POST_OP_STREAM);
+    float cbuf[XDNN_PLAIN_MB][XDNN_PLAIN_NB];
+    float *out = stream ? cbuf[0] : C + (size_t)m0 * ldc + n0; // where the rows are summed
+    const int ldo = stream ? XDNN_PLAIN_NB : ldc;
+
+    for (int i = 0; i < rows; ++i) {
+        float *c = out + (size_t)i * ldo;
+        if (beta == 0.0f) {
+            for (int j = 0; j < cols; ++j) c[j] = 0.0f;
+        } else if (beta != 1.0f) {
+            for (int j = 0; j < cols; ++j) c[j] *= beta;
+        }
+    }
+
+    for (int k0 = k_begin; k0 < k_end; k0 += XDNN_PLAIN_KB) {
+        int kb = std::min(XDNN_PLAIN_KB, k_end - k0);
+        bool last = k0 + kb >= k_end;
+
+        for (int k = 0; k < kb; ++k) {
+            float *b = bbuf[k];
+            if constexpr (Fmt::quantized) {
+                int g = Group > 0 ? (k0 + k) / Group : 0;
+                if (g != group) {
+                    group = g;
+                    for (int j = 0; j < cols; ++j) {
+                        scale[j] = scaleB ? scaleB[(size_t)(n0 + j) * groups + g] : 1.0f;
+                        zero[j] = zeroB && !xdnn_is_codebook<Fmt> ? zeroB[(size_t)(n0 + j) * groups + g] : 0.0f;
+                    }
+                    if constexpr (xdnn_is_codebook<Fmt>) codebook = zeroB + XDNN_CODEBOOK_SIZE * g;
+                }
+                if constexpr (xdnn_is_codebook<Fmt>) {
+                    Fmt::decode(packedB + (k0 + k) * row_elems, n0, cols, codebook, b);
+                } else {
+                    Fmt::decode(packedB + (k0 + k) * row_elems, n0, cols, b);
+                }
+                for (int j = 0; j < cols; ++j) b[j] = b[j] * scale[j] + zero[j];
+            } else {
+                Fmt::decode(packedB + (k0 + k) * row_elems, n0, cols, b);
+            }
+            for (int j = cols; j < XDNN_PLAIN_NB; ++j) b[j] = 0.0f;
+        }
+
+        for (int i = 0; i < rows; ++i) {
+            float acc[XDNN_PLAIN_NB] = {0.0f};
+            int m = m0 + i;
+            for (int k = 0; k < kb; ++k) {
+                float a = transA ? A[(size_t)(k0 + k) * lda + m] : A[(size_t)m * lda + k0 + k];
+                #pragma omp simd
+                for (int j = 0; j < XDNN_PLAIN_NB; ++j) {
+                    acc[j] += a * bbuf[k][j];
+                }
+            }
+
+            float *c = out + (size_t)i * ldo;
+            for (int j = 0; j < cols; ++j) c[j] += alpha * acc[j];
+            if (last) xdnn_apply_post_ops(ops, m, n0, 1, cols, c, ldo);
+            if (last && stream) xdnn_store_stream(C + (size_t)m * ldc + n0, c, cols);
+        }
+    }
+    if (stream) _mm_sfence();
+
+    if (k_begin >= k_end) xdnn_apply_post_ops(ops, m0, n0, rows, cols, C + (size_t)m0 * ldc + n0, ldc);
+}
+
+// The same tile kernel code generated for each tier. The AVX2 tier must not use the
+// instructions of the build's -march: a target attribute only adds ISA extensions, and what
+// the tile inlines is compiled for the build, so when the build targets AVX-512 (the default
+// XDNN_CPU_ARCH=sapphirerapids) the AVX2 tiles are compiled once in src/gemm_portable_avx2.cpp
+// with -march=x86-64-v3 (the xdnn_portable_avx2 library) and only declared here. Builds for
+// x86-64-v3 define them inline.
+#if defined(__AVX512F__) && !defined(XDNN_PORTABLE_AVX2_TU)
+#define XDNN_PORTABLE_AVX2_EXTERN
+#define XDNN_PORTABLE_AVX2_TILE
+#elif defined(XDNN_PORTABLE_AVX2_TU)
+#define XDNN_PORTABLE_AVX2_TILE __attribute__((flatten))
+#else
+#define XDNN_PORTABLE_AVX2_TILE __attribute__((flatten)) inline
+#endif
+
+template <typename Fmt, int Group>
+__attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,fma,f16c"), flatten))
+inline void xdnn_plain_gemm_tile_avx512(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end) {
+    xdnn_plain_gemm_tile<Fmt, Group>(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+            m0, rows, n0, cols, k_begin, k_end);
+}
+
+template <typename Fmt, int Group>
+XDNN_PORTABLE_AVX2_TILE void xdnn_plain_gemm_tile_avx2(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end)
+#ifdef XDNN_PORTABLE_AVX2_EXTERN
+;
+#else
+{
+    xdnn_plain_gemm_tile<Fmt, Group>(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+            m0, rows, n0, cols, k_begin, k_end);
+}
+#endif
+
+// Compute the row m0 of C[:, n0:n0+cols] (rows = 1) for M = 1, as xdnn_plain_gemm_tile does
+// but without the decoded B block: each packed row segment is read once, decoded into
+// L1 and accumulated into cols sums kept over all of K. Quantized formats sum a * q and a
+// per group and dequantize once at the end of the group (scale * sum(a * q) + zero * sum(a)).
+// Rows XDNN_PLAIN_GEMV_PREFETCH ahead are prefetched non-temporally, since rows N values
+// apart are too far for the hardware prefetcher.
+template <typename Fmt, int Group = 0>
+inline void xdnn_plain_gemv_tile(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end) {
+    using T = typename Fmt::type;
+    constexpr int per = xdnn_values_per<T>;
+    const size_t row_elems = xdnn_plain_row_elems<Fmt>(N);
+    const int groups = xdnn_scale_groups(K, Group);
+    const size_t seg_bytes = (size_t)(cols + per - 1) / per * sizeof(T);
+    alignas(64) float acc[XDNN_PLAIN_GEMV_NB] = {0.0f};
+    alignas(64) float qacc[XDNN_PLAIN_GEMV_NB];
+    alignas(64) float b[XDNN_PLAIN_GEMV_KB][XDNN_PLAIN_GEMV_NB];
+
+    auto a_at = [&](int k) { return transA ? A[(size_t)k * lda + m0] : A[(size_t)m0 * lda + k]; };
+    auto segment = [&](int k) { return packedB + (size_t)k * row_elems; };
+    auto prefetch = [&](int k) {
+        const char *p = reinterpret_cast<const char *>(segment(k) + n0 / per);
+        for (size_t off = 0; off < seg_bytes; off += 64) __builtin_prefetch(p + off, 0, 0);
+    };
+
+    for (int k = k_begin; k < std::min(k_end, k_begin + XDNN_PLAIN_GEMV_PREFETCH); ++k) prefetch(k);
+
+    for (int g0 = k_begin; g0 < k_end;) {
+        int g1 = Group > 0 ? std::min(k_end, (g0 / Group + 1) * Group) : k_end;
+        float asum = 0.0f;
+        const float *codebook = nullptr;
+        if constexpr (Fmt::quantized) {
+            for (int j = 0; j < cols; ++j) qacc[j] = 0.0f;
+            if constexpr (xdnn_is_codebook<Fmt>) codebook = zeroB + XDNN_CODEBOOK_SIZE * (Group > 0 ? g0 / Group : 0);
+        }
+
+        float *sum = Fmt::quantized ? qacc : acc;
+        for (int k0 = g0; k0 < g1; k0 += XDNN_PLAIN_GEMV_KB) {
+            int kb = std::min(XDNN_PLAIN_GEMV_KB, g1 - k0);
+            float a[XDNN_PLAIN_GEMV_KB] = {0.0f};
+            for (int k = 0; k < kb; ++k) {
+                if (k0 + k + XDNN_PLAIN_GEMV_PREFETCH < k_end) prefetch(k0 + k + XDNN_PLAIN_GEMV_PREFETCH);
+                a[k] = a_at(k0 + k);
+                asum += a[k];
+                if constexpr (xdnn_is_codebook<Fmt>) {
+                    Fmt::decode(segment(k0 + k), n0, cols, codebook, b[k]);
+                } else {
+                    Fmt::decode(segment(k0 + k), n0, cols, b[k]);
+                }
+            }
+            for (int k = kb; k < XDNN_PLAIN_GEMV_KB; ++k) {
+                for (int j = 0; j < cols; ++j) b[k][j] = 0.0f;
+            }
+            // The rows of the step are summed in registers, one load and store of sum per step
+            #pragma omp simd
+            for (int j = 0; j < cols; ++j) sum[j] += a[0] * b[0][j] + a[1] * b[1][j] + a[2] * b[2][j] + a[3] * b[3][j];
+        }
+
+        if constexpr (Fmt::quantized) {
+            int g = Group > 0 ? g0 / Group : 0;
+            for (int j = 0; j < cols; ++j) {
+                float scale = scaleB ? scaleB[(size_t)(n0 + j) * groups + g] : 1.0f;
+                float zero = zeroB && !xdnn_is_codebook<Fmt> ? zeroB[(size_t)(n0 + j) * groups + g] : 0.0f;
+                acc[j] += scale * qacc[j] + zero * asum;
+            }
+        }
+        g0 = g1;
+    }
+
+    float *c = C + (size_t)m0 * ldc + n0;
+    if (beta == 0.0f && xdnn_post_ops_has(ops, XDNN_POST_OP_STREAM)) {
+        for (int j = 0; j < cols; ++j) acc[j] *= alpha;
+        xdnn_apply_post_ops(ops, m0, n0, 1, cols, acc, ldc);
+        xdnn_store_stream(c, acc, cols);
+        _mm_sfence();
+        return;
+    }
+    if (beta == 0.0f) {
+        for (int j = 0; j < cols; ++j) c[j] = alpha * acc[j];
+    } else {
+        for (int j = 0; j < cols; ++j) c[j] = beta * c[j] + alpha * acc[j];
+    }
+    xdnn_apply_post_ops(ops, m0, n0, 1, cols, c, ldc);
+}
+
+template <typename Fmt, int Group>
+__attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,fma,f16c"), flatten))
+inline void xdnn_plain_gemv_tile_avx512(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end) {
+    xdnn_plain_gemv_tile<Fmt, Group>(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+            m0, rows, n0, cols, k_begin, k_end);
+}
+
+template <typename Fmt, int Group>
+XDNN_PORTABLE_AVX2_TILE void xdnn_plain_gemv_tile_avx2(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows, int n0, int cols, int k_begin, int k_end)
+#ifdef XDNN_PORTABLE_AVX2_EXTERN
+;
+#else
+{
+    xdnn_plain_gemv_tile<Fmt, Group>(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+            m0, rows, n0, cols, k_begin, k_end);
+}
+#endif
+
+// Columns per GEMV tile: the widest of XDNN_PLAIN_GEMV_NB, 128 and 64 that still gives every
+// thread a tile, for long contiguous reads of each packed row
+inline int xdnn_plain_gemv_cols(int N, int threads) {
+    int nb = XDNN_PLAIN_GEMV_NB;
+    while (nb > XDNN_PLAIN_NB && (N + nb - 1) / nb < threads) nb /= 2;
+    return nb;
+}
+
+// Rows of K per slice when the M x N tiles leave threads idle, as in decode (M = 1) with a
+// large K; K (0 for no split) otherwise. Slices are whole XDNN_PLAIN_KB blocks of at least
+// XDNN_PLAIN_SPLITK_MIN rows.
+inline int xdnn_plain_splitk_rows(int tiles, int K, int threads) {
+    if (tiles >= threads || omp_in_parallel() || XDNN_THREAD_POOL::in_pool()) return K;
+    int splits = std::min(threads / tiles, K / XDNN_PLAIN_SPLITK_MIN);
+    if (splits < 2) return K;
+    int rows = (K + splits - 1) / splits;
+    return (rows + XDNN_PLAIN_KB - 1) / XDNN_PLAIN_KB * XDNN_PLAIN_KB;
+}
+
+// C[m0:m0+rows, :] = ops(alpha * A * packedB + beta * C) on the calling thread, in the tiles of
+// xdnn_plain_gemm_compute but without its tiling and split-K: for callers that have split the
+// work themselves, as a plan (gemm_plan.h) does with its row blocks x panels
+template <typename Fmt, XDNN_CPU_ISA isa, int Group = 0>
+inline void xdnn_plain_gemm_block(bool transA, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops, int m0, int rows) {
+    auto tile = isa >= XDNN_ISA_AVX512 ? xdnn_plain_gemm_tile_avx512<Fmt, Group> : xdnn_plain_gemm_tile_avx2<Fmt, Group>;
+    int nb_cols = XDNN_PLAIN_NB;
+    if (rows == 1) {
+        tile = isa >= XDNN_ISA_AVX512 ? xdnn_plain_gemv_tile_avx512<Fmt, Group> : xdnn_plain_gemv_tile_avx2<Fmt, Group>;
+        nb_cols = XDNN_PLAIN_GEMV_NB;
+    }
+
+    for (int i = m0; i < m0 + rows; i += XDNN_PLAIN_MB) {
+        for (int n0 = 0; n0 < N; n0 += nb_cols) {
+            tile(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+                    i, std::min(XDNN_PLAIN_MB, m0 + rows - i), n0, std::min(nb_cols, N - n0), 0, K);
+        }
+    }
+}
+
+// C = ops(alpha * A * packedB + beta * C), parallel over M x N tiles (xdnn_plain_gemv_tile for
+// M = 1), and over slices of K when there are fewer tiles than threads (split-K): each slice
+// sums into its own M x N partial, the partials are added pairwise in a tree (slice s takes
+// s + 1, then s + 2, ..., so each add reads a partial its neighbor just wrote), and beta and
+// the chain run once on the sum.
+template <typename Fmt, XDNN_CPU_ISA isa, int Group = 0>
+inline void xdnn_plain_gemm_compute(bool transA, int M, int N, int K, float alpha, const float *A, int lda,
+        const typename Fmt::type *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+        const XDNN_POST_OPS *ops) {
+    auto tile = isa >= XDNN_ISA_AVX512 ? xdnn_plain_gemm_tile_avx512<Fmt, Group> : xdnn_plain_gemm_tile_avx2<Fmt, Group>;
+    if (M == 1) tile = isa >= XDNN_ISA_AVX512 ? xdnn_plain_gemv_tile_avx512<Fmt, Group> : xdnn_plain_gemv_tile_avx2<Fmt, Group>;
+
+    int threads = omp_get_max_threads();
+    int nb_cols = M == 1 ? xdnn_plain_gemv_cols(N, threads) : XDNN_PLAIN_NB;
+    int mblocks = (M + XDNN_PLAIN_MB - 1) / XDNN_PLAIN_MB;
+    int nblocks = (N + nb_cols - 1) / nb_cols;
+    int slice = xdnn_plain_splitk_rows(mblocks * nblocks, K, threads);
+
+    // Threads done with their tiles prefetch their share of the next weight (prefetch.h): the
+    // share tasks come after the tile tasks, so they are claimed in the tail of the call
+    const XDNN_PREFETCH_HINT *next = xdnn_current_prefetch_hint();
+    const XDNN_PREFETCH_LEVEL level = xdnn_prefetch_share_level(next);
+    int shares = xdnn_prefetch_tasks(next, threads);
+    int tiles = mblocks * nblocks;
+
+    // The loops run on xdnn_parallel_for, so on the pool of the thread context if it has one
+    if (slice >= K) {
+        xdnn_parallel_for(tiles + shares, [&](int t) {
+            if (t >= tiles) {
+                xdnn_prefetch_share(next, t - tiles, shares, level);
+                return;
+            }
+            int m0 = t / nblocks * XDNN_PLAIN_MB;
+            int n0 = t % nblocks * nb_cols;
+            tile(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops,
+                    m0, std::min(XDNN_PLAIN_MB, M - m0), n0, std::min(nb_cols, N - n0), 0, K);
+        });
+        return;
+    }
+
+    int splits = (K + slice - 1) / slice;
+    size_t size = (size_t)M * N;
+    std::vector<float> partial(splits * size);
+
+    xdnn_parallel_for(splits * tiles + shares, [&](int t) {
+        if (t >= splits * tiles) {
+            xdnn_prefetch_share(next, t - splits * tiles, shares, level);
+            return;
+        }
+        int s = t / tiles;
+        int m0 = t % tiles / nblocks * XDNN_PLAIN_MB;
+        int n0 = t % nblocks * nb_cols;
+        tile(transA, N, K, alpha, A, lda, packedB, scaleB, zeroB, 0.0f, partial.data() + s * size, N,
+                nullptr, m0, std::min(XDNN_PLAIN_MB, M - m0), n0, std::min(nb_cols, N - n0),
+                s * slice, std::min(K, (s + 1) * slice));
+    });
+
+    // Tree reduction into partial 0, each level over pairs x blocks of XDNN_PLAIN_NB values
+    int blocks = (int)((size + XDNN_PLAIN_NB - 1) / XDNN_PLAIN_NB);
+    for (int step = 1; step < splits; step *= 2) {
+        int pairs = (splits + 2 * step - 1) / (2 * step);
+        xdnn_parallel_for(pairs * blocks, [&](int t) {
+            int s = t / blocks * 2 * step;
+            int b = t % blocks;
+            if (s + step >= splits) return;
+            float *dst = partial.data() + s * size;
+            const float *src = partial.data() + (s + step) * size;
+            size_t i1 = std::min(size, (size_t)(b + 1) * XDNN_PLAIN_NB);
+            #pragma omp simd
+            for (size_t i = (size_t)b * XDNN_PLAIN_NB; i < i1; ++i) dst[i] += src[i];
+        });
+    }
+
+    const bool stream = beta == 0.0f && xdnn_post_ops_has(ops, XDNN_POST_OP_STREAM);
+    xdnn_parallel_for(M, [&](int m) {
+        float *c = C + (size_t)m * ldc;
+        float *sum = partial.data() + (size_t)m * N;
+        if (stream) {
+            // The chain runs on the reduced row, which is then streamed to C
+            xdnn_apply_post_ops(ops, m, 0, 1, N, sum, N);
+            xdnn_store_stream(c, sum, N);
+            _mm_sfence();
+            return;
+        }
+        if (beta == 0.0f) {
+            for (int j = 0; j < N; ++j) c[j] = sum[j];
+        } else {
+            for (int j = 0; j < N; ++j) c[j] = beta * c[j] + sum[j];
+        }
+        xdnn_apply_post_ops(ops, m, 0, 1, N, c, ldc);
+    });
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+
+#include <omp.h>
+
+#include "packed_b.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+// One destination of a split output: N columns, stored as dtype (FP32, FP16 or BF16)
+struct XDNN_SPLIT_OUTPUT {
+    int N;
+    void *data;
+    int ld;
+    XDNN_DATA_TYPE dtype;
+};
+
+// C[m0:m0+rows, panel p] = ops(A * packedB), scattered to the outputs the panel columns belong to.
+// The tile is computed XDNN_TILE_SCRATCH / panel_cols rows at a time in an L1 buffer, and each
+// output gets its columns converted on the way out.
+template <typename TB>
+inline void xdnn_split_tile(const XDNN_PACKED_B<TB> &packedB, bool transA, int m0, int rows, int p,
+        const float *A, int lda, int count, const XDNN_SPLIT_OUTPUT *outputs, const XDNN_POST_OPS *ops) {
+    float tile[XDNN_TILE_SCRATCH];
+    int ldt = packedB.panel_cols;
+    int chunk = std::max(1, XDNN_TILE_SCRATCH / ldt);
+    int n0 = p * packedB.panel_cols;
+    int cols = xdnn_panel_cols_of(packedB, p);
+    size_t offset = xdnn_scale_offset(*packedB.kernels, packedB.K, n0);
+    size_t zero_offset = xdnn_zero_offset(*packedB.kernels, packedB.K, n0);
+
+    for (int i0 = m0; i0 < m0 + rows; i0 += chunk) {
+        int mb = std::min(chunk, m0 + rows - i0);
+        const float *a = transA ? A + i0 : A + (size_t)i0 * lda;
+        XDNN_POST_OPS sub = xdnn_post_ops_at(ops, i0, n0);
+
+        xdnn_gemm_compute(*packedB.kernels, transA, mb, cols, packedB.K, 1.0f, a, lda,
+                packedB.data + p * packedB.panel_stride,
+                packedB.scaleB ? packedB.scaleB + offset : nullptr, packedB.zeroB ? packedB.zeroB + zero_offset : nullptr,
+                0.0f, tile, ldt, &sub);
+
+        // Columns [start, start + N) of the concatenated output go to outputs[o]
+        int start = 0;
+        for (int o = 0; o < count; ++o) {
+            const XDNN_SPLIT_OUTPUT &out = outputs[o];
+            int s0 = std::max(start, n0);
+            int s1 = std::min(start + out.N, n0 + cols);
+            if (s0 < s1) {
+                XDNN_POST_OP store = xdnn_post_op_convert(out.dtype, out.data, out.ld);
+                for (int i = 0; i < mb; ++i) {
+                    xdnn_apply_post_op(store, i0 + i, s0 - start, s1 - s0, tile + i * ldt + (s0 - n0));
+                }
+            }
+            start += out.N;
+        }
+    }
+}
+
+// To compute A * packedB with the columns of packedB split into several outputs, e.g. a
+// concatenated [Wq Wk Wv] weight writing Q, K and V without a split copy:
+//   [out0 out1 ...] = ops(A * packedB)
+// The N of the outputs add up to packedB.N; ops are in the coordinates of the concatenated output.
+template <typename TB>
+inline void xdnn_gemm_compute_split(const XDNN_PACKED_B<TB> &packedB, bool transA, int M, const float *A, int lda,
+        int count, const XDNN_SPLIT_OUTPUT *outputs, const XDNN_POST_OPS *ops = nullptr) {
+    assert(packedB.panel_cols <= XDNN_TILE_SCRATCH);
+    int panels = packedB.panels;
+    int mblocks = xdnn_row_blocks(M, panels, omp_get_max_threads());
+    int rows = (M + mblocks - 1) / mblocks;
+
+    xdnn_parallel_for(mblocks * panels, [&](int t) {
+        int m0 = (t / panels) * rows;
+        int p = t % panels;
+        if (m0 < M) {
+            xdnn_split_tile(packedB, transA, m0, std::min(rows, M - m0), p, A, lda, count, outputs, ops);
+        }
+    });
+}
+
+// To compute the QKV projection from one packed concatenated [Wq Wk Wv] weight (K x (Nq + Nk + Nv)):
+//   [Q K V] = A * packedQKV + bias
+// bias is in Nq + Nk + Nv and may be null
+template <typename TB>
+inline void xdnn_gemm_compute_qkv(const XDNN_PACKED_B<TB> &packedQKV, bool transA, int M, const float *A, int lda,
+        const XDNN_SPLIT_OUTPUT &q, const XDNN_SPLIT_OUTPUT &k, const XDNN_SPLIT_OUTPUT &v, const float *bias = nullptr) {
+    XDNN_SPLIT_OUTPUT outputs[3] = {q, k, v};
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias)});
+    xdnn_gemm_compute_split(packedQKV, transA, M, A, lda, 3, outputs, bias ? &ops : nullptr);
+}
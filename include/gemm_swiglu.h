@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+
+#include <omp.h>
+
+#include "packed_b.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+// C[m0:m0+rows, panel p] = ops(SILU(A * packedGate) * (A * packedUp)), single threaded.
+// The gate of XDNN_TILE_SCRATCH / panel_cols rows at a time goes to a buffer in L1, which
+// the up projection of the same rows multiplies in its epilogue; A rows are still in cache.
+template <typename TB>
+inline void xdnn_swiglu_tile(const XDNN_PACKED_B<TB> &packedGate, const XDNN_PACKED_B<TB> &packedUp,
+        bool transA, int m0, int rows, int p, const float *A, int lda, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    float gated[XDNN_TILE_SCRATCH];
+    int ldg = packedGate.panel_cols;
+    int chunk = std::max(1, XDNN_TILE_SCRATCH / ldg);
+    int n0 = p * packedGate.panel_cols;
+    int cols = xdnn_panel_cols_of(packedGate, p);
+    size_t offset = xdnn_scale_offset(*packedGate.kernels, packedGate.K, n0);
+    size_t zero_offset = xdnn_zero_offset(*packedGate.kernels, packedGate.K, n0);
+    XDNN_POST_OPS silu = xdnn_post_ops({xdnn_post_op_silu()});
+
+    for (int i0 = m0; i0 < m0 + rows; i0 += chunk) {
+        int mb = std::min(chunk, m0 + rows - i0);
+        const float *a = transA ? A + i0 : A + (size_t)i0 * lda;
+
+        xdnn_gemm_compute(*packedGate.kernels, transA, mb, cols, packedGate.K, 1.0f, a, lda,
+                packedGate.data + p * packedGate.panel_stride,
+                packedGate.scaleB ? packedGate.scaleB + offset : nullptr, packedGate.zeroB ? packedGate.zeroB + zero_offset : nullptr,
+                0.0f, gated, ldg, &silu);
+
+        XDNN_POST_OPS chain = xdnn_post_ops({xdnn_post_op_res_mul(gated, ldg)});
+        XDNN_POST_OPS sub = xdnn_post_ops_at(ops, i0, n0);
+        xdnn_post_ops_append(&chain, &sub);
+
+        xdnn_gemm_compute(*packedUp.kernels, transA, mb, cols, packedUp.K, 1.0f, a, lda,
+                packedUp.data + p * packedUp.panel_stride,
+                packedUp.scaleB ? packedUp.scaleB + offset : nullptr, packedUp.zeroB ? packedUp.zeroB + zero_offset : nullptr,
+                0.0f, C + (size_t)i0 * ldc + n0, ldc, &chain);
+    }
+}
+
+// To compute the gate/up projection of a SwiGLU MLP in one call, without the M x N intermediate:
+//   C = ops(SILU(A * packedGate) * (A * packedUp))
+// packedGate and packedUp are packed by xdnn_packb_panels with the same table, N, K and panel_cols.
+// ops may hold up to XDNN_MAX_POST_OPS - 1 ops.
+template <typename TB>
+inline void xdnn_gemm_compute_swiglu(const XDNN_PACKED_B<TB> &packedGate, const XDNN_PACKED_B<TB> &packedUp,
+        bool transA, int M, const float *A, int lda, float *C, int ldc, const XDNN_POST_OPS *ops = nullptr) {
+    assert(packedGate.panel_cols <= XDNN_TILE_SCRATCH);
+    int panels = packedGate.panels;
+    int mblocks = xdnn_row_blocks(M, panels, omp_get_max_threads());
+    int rows = (M + mblocks - 1) / mblocks;
+
+    xdnn_parallel_for(mblocks * panels, [&](int t) {
+        int m0 = (t / panels) * rows;
+        int p = t % panels;
+        if (m0 < M) {
+            xdnn_swiglu_tile(packedGate, packedUp, transA, m0, std::min(rows, M - m0), p, A, lda, C, ldc, ops);
+        }
+    });
+}
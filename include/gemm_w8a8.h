@@ -0,0 +1,442 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "cpu_isa.h"
+#include "gemm_kernels.h"
+#include "gemm_portable.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+#define XDNN_W8A8_NB 16 // columns per block of packed B (16 x int32 = one zmm, one AMX tile row)
+#define XDNN_W8A8_KB 64 // K is padded to a multiple of this, the depth of an AMX tile
+#define XDNN_W8A8_MB 32 // rows of A per tile of the compute
+#define XDNN_W8A8_TN 64 // columns per tile of the compute
+
+// ================================================================================
+// W8A8 sgemm: fp32 A is quantized per row (token) to int8 on the fly, multiplied with the
+// per column int8 weights of the s8 quantization (s8 x s8 -> s32 dot products with
+// AMX-INT8/VNNI), and dequantized in the epilogue with scaleA, scaleB and zeroB:
+//   C = alpha * (scaleA[m] * scaleB[n] * sum_k qA * qB + zeroB[n] * sum_k A) + beta * C
+// A row m is stored as qA + 128 (u8) for VPDPBUSD/TDPBUSD, the 128 * sum_k qB[k, n] this
+// adds is kept with the packed B and taken off before the epilogue.
+//
+// Packed B: for each block of 16 columns, K/4 rows of 64 bytes (16 columns x 4 adjacent k),
+// K padded to XDNN_W8A8_KB with zeros, followed by the int32 compensation of every column.
+// The block is the B operand of an AMX tile as is.
+// ================================================================================
+inline int xdnn_w8a8_padded_k(int K) {
+    return (K + XDNN_W8A8_KB - 1) / XDNN_W8A8_KB * XDNN_W8A8_KB;
+}
+
+inline int xdnn_w8a8_padded_n(int N) {
+    return (N + XDNN_W8A8_NB - 1) / XDNN_W8A8_NB * XDNN_W8A8_NB;
+}
+
+inline size_t xdnn_w8a8_sgemm_f32s8f32_packb_size(int N, int K) {
+    size_t Np = xdnn_w8a8_padded_n(N);
+    return Np * xdnn_w8a8_padded_k(K) + Np * sizeof(int32_t);
+}
+
+// Same quantization as the s8 families: per column, symmetric, zeroB = 0
+inline void xdnn_w8a8_sgemm_f32s8f32_quantize(bool transB, int N, int K, const float *B, int ldb,
+        float quantization_rate, int8_t *quantizedB, int ldqb, float *scaleB, float *zeroB) {
+    xdnn_plain_quantize<xdnn_fmt_s8>(transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB);
+}
+
+// To pack the quantized B into packedB (64 bytes aligned, packb_size elements)
+// B is in K x N if transB = false
+// B is in N x K if transB = true
+inline void xdnn_w8a8_sgemm_f32s8f32_packb(bool transB, int N, int K, const int8_t *B, int ldb, int8_t *packedB) {
+    const int Kp = xdnn_w8a8_padded_k(K);
+    const int Np = xdnn_w8a8_padded_n(N);
+    int32_t *comp = (int32_t *)(packedB + (size_t)Np * Kp);
+
+    memset(packedB, 0, (size_t)Np * Kp);
+    for (int n = 0; n < Np; ++n) {
+        int8_t *block = packedB + (size_t)(n / XDNN_W8A8_NB) * XDNN_W8A8_NB * Kp + (n % XDNN_W8A8_NB) * 4;
+        int32_t sum = 0;
+        for (int k = 0; n < N && k < K; ++k) {
+            int8_t b = transB ? B[(size_t)n * ldb + k] : B[(size_t)k * ldb + n];
+            block[(k / 4) * XDNN_W8A8_NB * 4 + k % 4] = b;
+            sum += b;
+        }
+        comp[n] = 128 * sum;
+    }
+}
+
+// Rows [m0, m0 + rows) of A quantized into qA (rows of ldqa bytes, qA + 128, padded with 128),
+// with their scale and fp32 sum
+inline void xdnn_w8a8_quantize_a(bool transA, int K, const float *A, int lda, int m0, int rows,
+        uint8_t *qA, int ldqa, float *scaleA, float *sumA) {
+    std::vector<float> row(K);
+    for (int m = m0; m < m0 + rows; ++m) {
+        for (int k = 0; k < K; ++k) row[k] = transA ? A[(size_t)k * lda + m] : A[(size_t)m * lda + k];
+
+        float amax = 0.0f;
+        float sum = 0.0f;
+        for (int k = 0; k < K; ++k) {
+            amax = std::max(amax, std::fabs(row[k]));
+            sum += row[k];
+        }
+
+        float scale = amax > 0.0f ? amax / 127.0f : 1.0f;
+        float inv = 1.0f / scale;
+        uint8_t *q = qA + (size_t)m * ldqa;
+        for (int k = 0; k < K; ++k) {
+            int v = (int)std::nearbyint(row[k] * inv);
+            q[k] = (uint8_t)(std::clamp(v, -127, 127) + 128);
+        }
+        memset(q + K, 128, ldqa - K);
+        scaleA[m] = scale;
+        sumA[m] = sum;
+    }
+}
+
+// ================================================================================
+// Tile kernels: acc[i][j] (XDNN_W8A8_TN int32 per row) = sum_k qA[i][k] * qB[k][j] for the
+// 'rows' rows of qA (stride ldqa, Kp columns) and 'blocks' blocks of 16 columns of packedB.
+// The VNNI and AMX kernels accumulate (qA + 128) * qB, the compensation is taken off later.
+// qA has rows up to a multiple of XDNN_W8A8_MB, so rows are computed by groups.
+// ================================================================================
+enum XDNN_W8A8_KERNEL {
+    XDNN_W8A8_AVX2 = 0,     // VPMADDUBSW + VPMADDWD, exact, on AVX2 (and AVX-512 without VNNI)
+    XDNN_W8A8_AVX_VNNI,     // VPDPBUSD on ymm (Alder Lake and later)
+    XDNN_W8A8_AVX512_VNNI,  // VPDPBUSD on zmm (Cascade Lake and later)
+    XDNN_W8A8_AMX_INT8,     // TDPBUSD (Sapphire Rapids and later)
+};
+
+inline int32_t xdnn_load_u32(const uint8_t *p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// s8 x s8 dot of 4 bytes per int32 lane: |a| * (b with the sign of a) stays within int16
+inline __m256i xdnn_dpbssd_avx2(__m256i acc, __m256i a, __m256i b) {
+    __m256i p = _mm256_maddubs_epi16(_mm256_sign_epi8(a, a), _mm256_sign_epi8(b, a));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(p, _mm256_set1_epi16(1)));
+}
+
+// Compiled for x86-64-v3 as the AVX2 tier of the other families (gemm_portable.h)
+XDNN_PORTABLE_AVX2_TILE void xdnn_w8a8_tile_avx2(const uint8_t *qA, int ldqa, int Kp, const int8_t *B, int rows, int blocks,
+        int32_t *acc)
+#ifdef XDNN_PORTABLE_AVX2_EXTERN
+;
+#else
+{
+    for (int i = 0; i < rows; i += 4) {
+        for (int b = 0; b < blocks; ++b) {
+            const int8_t *pb = B + (size_t)b * XDNN_W8A8_NB * Kp;
+            __m256i c[4][2];
+            for (int r = 0; r < 4; ++r) c[r][0] = c[r][1] = _mm256_setzero_si256();
+
+            for (int q = 0; q < Kp / 4; ++q) {
+                __m256i b0 = _mm256_loadu_si256((const __m256i *)(pb + q * 64));
+                __m256i b1 = _mm256_loadu_si256((const __m256i *)(pb + q * 64 + 32));
+                for (int r = 0; r < 4; ++r) {
+                    int32_t a = xdnn_load_u32(qA + (size_t)(i + r) * ldqa + q * 4);
+                    __m256i va = _mm256_set1_epi32(a ^ (int32_t)0x80808080); // back to s8
+                    c[r][0] = xdnn_dpbssd_avx2(c[r][0], va, b0);
+                    c[r][1] = xdnn_dpbssd_avx2(c[r][1], va, b1);
+                }
+            }
+
+            for (int r = 0; r < 4; ++r) {
+                int32_t *dst = acc + (size_t)(i + r) * XDNN_W8A8_TN + b * XDNN_W8A8_NB;
+                _mm256_storeu_si256((__m256i *)dst, c[r][0]);
+                _mm256_storeu_si256((__m256i *)(dst + 8), c[r][1]);
+            }
+        }
+    }
+}
+#endif
+
+__attribute__((target("avx2,avxvnni")))
+inline void xdnn_w8a8_tile_avx_vnni(const uint8_t *qA, int ldqa, int Kp, const int8_t *B, int rows, int blocks, int32_t *acc) {
+    for (int i = 0; i < rows; i += 4) {
+        for (int b = 0; b < blocks; ++b) {
+            const int8_t *pb = B + (size_t)b * XDNN_W8A8_NB * Kp;
+            __m256i c[4][2];
+            for (int r = 0; r < 4; ++r) c[r][0] = c[r][1] = _mm256_setzero_si256();
+
+            for (int q = 0; q < Kp / 4; ++q) {
+                __m256i b0 = _mm256_loadu_si256((const __m256i *)(pb + q * 64));
+                __m256i b1 = _mm256_loadu_si256((const __m256i *)(pb + q * 64 + 32));
+                for (int r = 0; r < 4; ++r) {
+                    __m256i va = _mm256_set1_epi32(xdnn_load_u32(qA + (size_t)(i + r) * ldqa + q * 4));
+                    c[r][0] = _mm256_dpbusd_avx_epi32(c[r][0], va, b0);
+                    c[r][1] = _mm256_dpbusd_avx_epi32(c[r][1], va, b1);
+                }
+            }
+
+            for (int r = 0; r < 4; ++r) {
+                int32_t *dst = acc + (size_t)(i + r) * XDNN_W8A8_TN + b * XDNN_W8A8_NB;
+                _mm256_storeu_si256((__m256i *)dst, c[r][0]);
+                _mm256_storeu_si256((__m256i *)(dst + 8), c[r][1]);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+inline void xdnn_w8a8_tile_avx512_vnni(const uint8_t *qA, int ldqa, int Kp, const int8_t *B, int rows, int blocks,
+        int32_t *acc) {
+    for (int i = 0; i < rows; i += 4) {
+        for (int b = 0; b < blocks; b += 2) {
+            const int8_t *pb0 = B + (size_t)b * XDNN_W8A8_NB * Kp;
+            const int8_t *pb1 = b + 1 < blocks ? pb0 + (size_t)XDNN_W8A8_NB * Kp : pb0;
+            __m512i c[4][2];
+            for (int r = 0; r < 4; ++r) c[r][0] = c[r][1] = _mm512_setzero_si512();
+
+            for (int q = 0; q < Kp / 4; ++q) {
+                __m512i b0 = _mm512_loadu_si512(pb0 + q * 64);
+                __m512i b1 = _mm512_loadu_si512(pb1 + q * 64);
+                for (int r = 0; r < 4; ++r) {
+                    __m512i va = _mm512_set1_epi32(xdnn_load_u32(qA + (size_t)(i + r) * ldqa + q * 4));
+                    c[r][0] = _mm512_dpbusd_epi32(c[r][0], va, b0);
+                    c[r][1] = _mm512_dpbusd_epi32(c[r][1], va, b1);
+                }
+            }
+
+            for (int r = 0; r < 4; ++r) {
+                int32_t *dst = acc + (size_t)(i + r) * XDNN_W8A8_TN + b * XDNN_W8A8_NB;
+                _mm512_storeu_si512(dst, c[r][0]);
+                if (b + 1 < blocks) _mm512_storeu_si512(dst + XDNN_W8A8_NB, c[r][1]);
+            }
+        }
+    }
+}
+
+// Palette 1 tile configuration
+struct alignas(64) XDNN_AMX_TILECFG {
+    uint8_t palette;
+    uint8_t start_row;
+    uint8_t reserved[14];
+    uint16_t colsb[16];
+    uint8_t rows[16];
+};
+
+// Tile configuration of xdnn_w8a8_tile_amx, loaded once per thread and call
+__attribute__((target("amx-tile")))
+inline void xdnn_w8a8_amx_config() {
+    XDNN_AMX_TILECFG cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.palette = 1;
+    for (int t = 0; t < 8; ++t) {
+        cfg.rows[t] = 16;
+        cfg.colsb[t] = 64;
+    }
+    _tile_loadconfig(&cfg);
+}
+
+__attribute__((target("amx-tile")))
+inline void xdnn_w8a8_amx_release() {
+    _tile_release();
+}
+
+// tmm0-3: C of 2 x 2 tiles of 16 x 16 int32, tmm4-5: A (16 rows x 64 k), tmm6-7: B (16 x 4 k x 16 columns)
+// Runs between xdnn_w8a8_amx_config and xdnn_w8a8_amx_release
+__attribute__((target("amx-tile,amx-int8,avx512f")))
+inline void xdnn_w8a8_tile_amx(const uint8_t *qA, int ldqa, int Kp, const int8_t *B, int rows, int blocks, int32_t *acc) {
+    const int stride = XDNN_W8A8_TN * sizeof(int32_t);
+    for (int b = 0; b < blocks; b += 2) {
+        const int8_t *pb0 = B + (size_t)b * XDNN_W8A8_NB * Kp;
+        const int8_t *pb1 = b + 1 < blocks ? pb0 + (size_t)XDNN_W8A8_NB * Kp : pb0;
+        _tile_zero(0);
+        _tile_zero(1);
+        _tile_zero(2);
+        _tile_zero(3);
+
+        for (int k0 = 0; k0 < Kp; k0 += XDNN_W8A8_KB) {
+            _tile_loadd(4, qA + k0, ldqa);
+            _tile_loadd(6, pb0 + k0 * XDNN_W8A8_NB, 64);
+            _tile_loadd(7, pb1 + k0 * XDNN_W8A8_NB, 64);
+            _tile_dpbusd(0, 4, 6);
+            _tile_dpbusd(1, 4, 7);
+            if (rows > 16) {
+                _tile_loadd(5, qA + (size_t)16 * ldqa + k0, ldqa);
+                _tile_dpbusd(2, 5, 6);
+                _tile_dpbusd(3, 5, 7);
+            }
+        }
+
+        int32_t *dst = acc + b * XDNN_W8A8_NB;
+        _tile_stored(0, dst, stride);
+        if (b + 1 < blocks) _tile_stored(1, dst + XDNN_W8A8_NB, stride);
+        if (rows > 16) {
+            _tile_stored(2, dst + 16 * XDNN_W8A8_TN, stride);
+            if (b + 1 < blocks) _tile_stored(3, dst + 16 * XDNN_W8A8_TN + XDNN_W8A8_NB, stride);
+        }
+    }
+}
+
+// The fastest kernel the CPU has within an ISA tier
+inline XDNN_W8A8_KERNEL xdnn_w8a8_kernel(XDNN_CPU_ISA isa) {
+    const XDNN_CPU_FEATURES &f = xdnn_cpu_features();
+    if (isa >= XDNN_ISA_AMX && f.amx_tile && f.amx_int8) return XDNN_W8A8_AMX_INT8;
+    if (isa >= XDNN_ISA_AVX512 && f.avx512_vnni) return XDNN_W8A8_AVX512_VNNI;
+    if (f.avx_vnni) return XDNN_W8A8_AVX_VNNI;
+    return XDNN_W8A8_AVX2;
+}
+
+// C = ops(alpha * A * packedB + beta * C), A quantized per row, parallel over M x N tiles.
+// scaleB may be null for scales of 1 and zeroB for zero points of 0 (the s8 quantization's).
+inline void xdnn_w8a8_gemm_compute(XDNN_W8A8_KERNEL kernel, bool transA, int M, int N, int K, float alpha,
+        const float *A, int lda, const int8_t *packedB, const float *scaleB, const float *zeroB,
+        float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    if (M <= 0 || N <= 0) return;
+
+    auto tile = kernel == XDNN_W8A8_AMX_INT8 ? xdnn_w8a8_tile_amx
+            : kernel == XDNN_W8A8_AVX512_VNNI ? xdnn_w8a8_tile_avx512_vnni
+            : kernel == XDNN_W8A8_AVX_VNNI ? xdnn_w8a8_tile_avx_vnni : xdnn_w8a8_tile_avx2;
+    const bool biased = kernel != XDNN_W8A8_AVX2;
+
+    const int Kp = xdnn_w8a8_padded_k(K);
+    const int Np = xdnn_w8a8_padded_n(N);
+    const int32_t *comp = (const int32_t *)(packedB + (size_t)Np * Kp);
+    const int mblocks = (M + XDNN_W8A8_MB - 1) / XDNN_W8A8_MB;
+    const int nblocks = (N + XDNN_W8A8_TN - 1) / XDNN_W8A8_TN;
+
+    std::vector<uint8_t> qA((size_t)mblocks * XDNN_W8A8_MB * Kp);
+    std::vector<float> scaleA(M), sumA(M);
+    xdnn_parallel_for(mblocks, [&](int mb) {
+        int m0 = mb * XDNN_W8A8_MB;
+        int rows = std::min(XDNN_W8A8_MB, M - m0);
+        xdnn_w8a8_quantize_a(transA, K, A, lda, m0, rows, qA.data(), Kp, scaleA.data(), sumA.data());
+        memset(qA.data() + (size_t)(m0 + rows) * Kp, 128, (size_t)(XDNN_W8A8_MB - rows) * Kp);
+    });
+
+    const bool stream = beta == 0.0f && xdnn_post_ops_has(ops, XDNN_POST_OP_STREAM);
+    auto run_tile = [&](int t) {
+        int m0 = t / nblocks * XDNN_W8A8_MB;
+        int n0 = t % nblocks * XDNN_W8A8_TN;
+        int rows = std::min(XDNN_W8A8_MB, M - m0);
+        int cols = std::min(XDNN_W8A8_TN, N - n0);
+        alignas(64) int32_t acc[XDNN_W8A8_MB * XDNN_W8A8_TN];
+
+        tile(qA.data() + (size_t)m0 * Kp, Kp, Kp, packedB + (size_t)n0 * Kp, rows,
+                (cols + XDNN_W8A8_NB - 1) / XDNN_W8A8_NB, acc);
+
+        for (int i = 0; i < rows; ++i) {
+            int m = m0 + i;
+            const int32_t *a = acc + (size_t)i * XDNN_W8A8_TN;
+            float *c = C + (size_t)m * ldc + n0;
+            alignas(64) float row[XDNN_W8A8_TN];
+            float *y = stream ? row : c; // a STREAM op stores the finished row with streaming stores
+            for (int j = 0; j < cols; ++j) {
+                int n = n0 + j;
+                int32_t dot = biased ? a[j] - comp[n] : a[j];
+                float v = scaleA[m] * (scaleB ? scaleB[n] : 1.0f) * (float)dot;
+                if (zeroB) v += zeroB[n] * sumA[m];
+                y[j] = beta == 0.0f ? alpha * v : alpha * v + beta * c[j];
+            }
+            xdnn_apply_post_ops(ops, m, n0, 1, cols, y, ldc);
+            if (stream) xdnn_store_stream(c, row, cols);
+        }
+        if (stream) _mm_sfence();
+    };
+
+    const int tiles = mblocks * nblocks;
+    if (kernel != XDNN_W8A8_AMX_INT8) {
+        xdnn_parallel_for(tiles, run_tile);
+        return;
+    }
+
+    // AMX: one task per thread, each a contiguous run of tiles under a single tile configuration
+    const int tasks = std::min(tiles, omp_get_max_threads());
+    xdnn_parallel_for(tasks, [&](int w) {
+        xdnn_w8a8_amx_config();
+        for (int t = (int)((int64_t)tiles * w / tasks); t < (int)((int64_t)tiles * (w + 1) / tasks); ++t) run_tile(t);
+        xdnn_w8a8_amx_release();
+    });
+}
+
+// Kernel table of the W8A8 family, the same layout of packed B on every tier
+template <XDNN_CPU_ISA isa>
+struct xdnn_w8a8_kernels {
+    using TB = int8_t;
+
+    static void compute_post_ops(bool transA, int M, int N, int K, float alpha, const float *A, int lda,
+            const TB *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc,
+            const XDNN_POST_OPS *ops) {
+        static const XDNN_W8A8_KERNEL kernel = xdnn_w8a8_kernel(isa);
+        xdnn_w8a8_gemm_compute(kernel, transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, ops);
+    }
+
+    static void run(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, XDNN_POST_OPS ops) {
+        compute_post_ops(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, &ops);
+    }
+
+    static void compute(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({}));
+    }
+
+    static void compute_silu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_silu()}));
+    }
+
+    static void compute_gelu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_gelu()}));
+    }
+
+    static void compute_biasadd(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc, xdnn_post_ops({xdnn_post_op_bias(bias)}));
+    }
+
+    static void compute_biasadd_relu(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_relu()}));
+    }
+
+    static void compute_residential(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres)}));
+    }
+
+    static void compute_resext(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *bias,
+            float gamma, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres, gamma)}));
+    }
+
+    static void compute_resmul(bool transA, int M, int N, int K, float alpha, const float *A, int lda, const TB *packedB,
+            const float *scaleB, const float *zeroB, float beta, float *C, int ldc, const float *res, int ldres) {
+        run(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc,
+                xdnn_post_ops({xdnn_post_op_res_mul(res, ldres)}));
+    }
+
+    static XDNN_GEMM_KERNELS<TB> table(const char *name) {
+        return {name, isa, xdnn_w8a8_sgemm_f32s8f32_packb_size, xdnn_w8a8_sgemm_f32s8f32_quantize,
+                xdnn_w8a8_sgemm_f32s8f32_packb, compute, compute_silu, compute_gelu, compute_biasadd,
+                compute_biasadd_relu, compute_residential, compute_resext, compute_resmul, compute_post_ops,
+                xdnn_quantize_then_packb<TB, xdnn_w8a8_sgemm_f32s8f32_quantize, xdnn_w8a8_sgemm_f32s8f32_packb>, 0, false};
+    }
+};
+
+inline const XDNN_GEMM_KERNELS<int8_t> &xdnn_w8a8_sgemm_f32s8f32_kernels(XDNN_CPU_ISA isa = xdnn_cpu_isa()) {
+    static const XDNN_GEMM_KERNELS<int8_t> amx = xdnn_w8a8_kernels<XDNN_ISA_AMX>::table("w8a8_sgemm_f32s8f32");
+    static const XDNN_GEMM_KERNELS<int8_t> avx512 = xdnn_w8a8_kernels<XDNN_ISA_AVX512>::table("w8a8_sgemm_f32s8f32");
+    static const XDNN_GEMM_KERNELS<int8_t> avx2 = xdnn_w8a8_kernels<XDNN_ISA_AVX2>::table("w8a8_sgemm_f32s8f32");
+    return xdnn_select_kernels(isa, amx, avx512, avx2);
+}
+
+// C = alpha * A * packedB + beta * C with the table of the running CPU
+inline void xdnn_w8a8_sgemm_f32s8f32_compute(bool transA, int M, int N, int K, float alpha, const float *A, int lda,
+        const int8_t *packedB, const float *scaleB, const float *zeroB, float beta, float *C, int ldc) {
+    xdnn_w8a8_sgemm_f32s8f32_kernels().compute(transA, M, N, K, alpha, A, lda, packedB, scaleB, zeroB, beta, C, ldc);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "data_types/data_types.h"
+#include "tuning_db.h"
+
+#include "sgemm.h"
+#include "sgemm_f32f16f32.h"
+#include "sgemm_f32s8f32.h"
+#include "sgemm_f32i8f32.h"
+#include "sgemm_f32u4f32.h"
+#include "sgemm_f32nf4f32.h"
+#include "hgemm.h"
+#include "hgemm_f16f16f32.h"
+#include "hgemm_f32f16f16.h"
+#include "hgemm_f32f16f32.h"
+#include "hgemm_f32s8f32.h"
+#include "hgemm_f32i8f32.h"
+#include "hgemm_f32u4f32.h"
+#include "bgemm_f32bf16f32.h"
+#include "amx_sgemm_bf16bf16bf16.h"
+
+#define XDNN_PACKB_ALIGN 64 // alignment of every packed B buffer, in bytes
+
+// Memory a packed B needs: 'elems' elements of the weight type, 'bytes' in total,
+// at an address aligned to 'alignment' bytes
+struct XDNN_PACKB_LAYOUT {
+    size_t elems;
+    size_t bytes;
+    size_t alignment;
+};
+
+// Number of TB elements before weight 'values' (rounded down)
+template <typename TB>
+inline size_t xdnn_elems(size_t values) {
+    return values / xdnn_values_per<TB>;
+}
+
+// Number of TB elements holding 'values' weights (rounded up)
+template <typename TB>
+inline size_t xdnn_elems_for(size_t values) {
+    return (values + xdnn_values_per<TB> - 1) / xdnn_values_per<TB>;
+}
+
+// Compact packed formats (no ldb): K rows of N values, 4/3/2-bit rows padded to whole elements
+template <typename TB>
+inline size_t xdnn_dense_packb_size(int N, int K) {
+    return (size_t)K * xdnn_elems_for<TB>(N);
+}
+
+template <typename TB>
+inline XDNN_PACKB_LAYOUT xdnn_packb_layout_of(size_t elems) {
+    return {elems, elems * sizeof(TB), XDNN_PACKB_ALIGN};
+}
+
+// ================================================================================
+// Size of the buffer of xdnn_<family>_packb, in elements of the weight type. The layouts of
+// the prebuilt library are opaque, so they get the K x N elements upper bound; the formats
+// of the portable kernels (FP8, 2-bit, 3-bit) are sized exactly.
+// ================================================================================
+#define XDNN_DEFINE_LIBRARY_PACKB_SIZE(family) \
+    inline size_t xdnn_##family##_packb_size(int N, int K) { \
+        return (size_t)K * N; \
+    }
+
+#define XDNN_DEFINE_PACKB_SIZE(family, TB) \
+    inline size_t xdnn_##family##_packb_size(int N, int K) { \
+        return xdnn_dense_packb_size<TB>(N, K); \
+    }
+
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm_f32f16f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm_f32s8f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm_f32i8f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm_f32u4f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(sgemm_f32nf4f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm_f16f16f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm_f32f16f16)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm_f32s8f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm_f32i8f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(hgemm_f32u4f32)
+XDNN_DEFINE_LIBRARY_PACKB_SIZE(amx_sgemm_bf16bf16bf16)
+XDNN_DEFINE_PACKB_SIZE(sgemm_f32e4m3f32, XDNN_FP8_E4M3)
+XDNN_DEFINE_PACKB_SIZE(sgemm_f32e5m2f32, XDNN_FP8_E5M2)
+XDNN_DEFINE_PACKB_SIZE(sgemm_f32u2f32, XDNN_UINT2x4)
+XDNN_DEFINE_PACKB_SIZE(sgemm_f32u3f32, XDNN_UINT3x8)
+
+// The blocked formats with the default block of the kernel table's packb; a tuned block is
+// chosen per weight by xdnn_packb_panels (the packb_block entries of the table)
+inline size_t xdnn_bgemm_f32bf16f32_packb_size(int N, int K) {
+    return xdnn_bgemm_f32bf16f32_packb_size(N, K, 16, 64);
+}
+
+// xdnn_hgemm_f32f16f32_packb_block pads K and N up to whole blocks, block_rows = 0 is the unblocked packb
+inline size_t xdnn_hgemm_f32f16f32_packb_size(int N, int K, int block_rows, int block_cols) {
+    if (block_rows <= 0) return (size_t)K * N;
+    size_t rows = (K + block_rows - 1) / block_rows * block_rows;
+    size_t cols = (N + block_cols - 1) / block_cols * block_cols;
+    return rows * cols;
+}
+
+inline size_t xdnn_hgemm_f32f16f32_packb_size(int N, int K) {
+    return xdnn_hgemm_f32f16f32_packb_size(N, K, 0, 0);
+}
+
+// The small AMX kernel is single threaded and doesn't depend on the block, so it isn't tuned
+inline size_t xdnn_small_amx_sgemm_bf16bf16bf16_packb_size(int N, int K) {
+    return xdnn_small_amx_sgemm_bf16bf16bf16_packb_size(N, K, 32, 32);
+}
+
+// ================================================================================
+// Offsets of several packed weights in one arena, e.g. a huge page mapping:
+//   XDNN_PACKB_ARENA arena;
+//   size_t wq = arena.reserve(xdnn_packb_layout(kernels, N, K));
+//   ...
+//   char *base = map_huge_pages(arena.size(XDNN_HUGE_PAGE));
+//   kernels.packb(false, N, K, B, ldb, (int8_t *)(base + wq));
+// base must be aligned to max_alignment().
+// ================================================================================
+#define XDNN_HUGE_PAGE (2ul << 20)
+
+class XDNN_PACKB_ARENA {
+public:
+    // Offset of a new buffer of the given layout
+    size_t reserve(const XDNN_PACKB_LAYOUT &layout) {
+        size_t offset = (size_ + layout.alignment - 1) / layout.alignment * layout.alignment;
+        size_ = offset + layout.bytes;
+        if (layout.alignment > max_alignment_) max_alignment_ = layout.alignment;
+        return offset;
+    }
+
+    // Bytes of the arena, rounded up to a multiple of 'round'
+    size_t size(size_t round = 1) const {
+        return (size_ + round - 1) / round * round;
+    }
+
+    size_t max_alignment() const {
+        return max_alignment_;
+    }
+
+private:
+    size_t size_ = 0;
+    size_t max_alignment_ = 1;
+};
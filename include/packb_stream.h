@@ -0,0 +1,355 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "gemm_kernels.h"
+#include "gemm_portable.h"
+#include "packed_b.h"
+#include "parallel.h"
+
+// ================================================================================
+// Quantize + pack of a weight fed a chunk of rows at a time, e.g. as it is read from a
+// checkpoint, so the fp32 weight is never held in memory as a whole. The result is the
+// panel packed B of packed_b.h, in a buffer of xdnn_packb_panels_size elements.
+//
+// transB = true (B is N x K, the usual [out, in] layout of a checkpoint): each chunk of rows
+// is a set of columns of B with all of K, so whole panels are quantized (by the family's
+// _quantize) and packed as soon as their rows arrive, in parallel; only a partial panel is kept.
+//
+// transB = false (B is K x N, chunks along K) is not memory bounded: every panel needs all of
+// K, so push() converts the chunks into a K x N copy of the weight in the weight type, which
+// finish() packs and frees. Prefer transB = true whenever the loader can give rows of N x K.
+// With a per column quantized table (group_size = 0), a column needs the range of all of K,
+// so the chunks are also given twice: observe() collects the range of each column, then push()
+// quantizes each chunk. Only quantization_rate = 1 (no clipping) is supported there.
+//   XDNN_PACKB_STREAM<int8_t> stream(kernels, false, N, K, buffer, scaleB, zeroB);
+//   for (chunk : layer) stream.observe(chunk.data, chunk.rows, N);
+//   for (chunk : layer) stream.push(chunk.data, chunk.rows, N);
+//   XDNN_PACKED_B<int8_t> packed = stream.finish();
+// Group-wise tables (group_size > 0) take one pass: the rows of a group are staged as they
+// arrive and quantized once the group is complete; observe() does nothing there. Families
+// without quantization skip observe() and convert to the weight type.
+// With a codebook table, zeroB holds the codebooks and is only read.
+// ================================================================================
+template <typename TB>
+class XDNN_PACKB_STREAM {
+public:
+    // buffer holds xdnn_packb_panels_size(kernels, N, K, panel_cols, threads) elements
+    XDNN_PACKB_STREAM(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, TB *buffer,
+            float *scaleB = nullptr, float *zeroB = nullptr, float quantization_rate = 1.0f, int panel_cols = XDNN_PANEL_COLS,
+            int threads = xdnn_packb_threads())
+            : kernels_(kernels), transB_(transB), N_(N), K_(K), buffer_(buffer), scaleB_(scaleB), zeroB_(zeroB),
+              rate_(quantization_rate), panel_cols_(panel_cols) {
+        assert(!kernels.quantize || (scaleB && zeroB));
+        assert(transB || !kernels.quantize || quantization_rate >= 1.0f);
+        block_ = xdnn_panel_block(kernels, K, panel_cols, threads);
+        stride_ = xdnn_panel_stride(kernels, K, panel_cols, block_);
+        groups_ = xdnn_scale_groups(K, kernels.group_size);
+        group_ = kernels.group_size > 0 ? kernels.group_size : K;
+        if (transB) {
+            staged_.resize((size_t)panel_cols * K);
+        } else {
+            weight_.resize(xdnn_elems_for<TB>((size_t)K * N));
+            if (grouped()) {
+                staged_.resize((size_t)group_ * N);
+            } else if (kernels.quantize) {
+                lo_.assign((size_t)N, FLT_MAX);
+                hi_.assign((size_t)N, -FLT_MAX);
+            }
+        }
+    }
+
+    // Pass 1 of transB = false, per column quantized families: the next 'rows' rows of B
+    void observe(const float *B, int rows, int ldb) {
+        assert(!transB_ && observed_ + rows <= K_);
+        observed_ += rows;
+        if (grouped()) return;
+        xdnn_parallel_for((N_ + XDNN_STREAM_COLS - 1) / XDNN_STREAM_COLS, [&](int t) {
+            int n1 = std::min(N_, (t + 1) * XDNN_STREAM_COLS);
+            for (int k = 0; k < rows; ++k) {
+                const float *b = B + (size_t)k * ldb;
+                for (int n = t * XDNN_STREAM_COLS; n < n1; ++n) {
+                    lo_[n] = std::min(lo_[n], b[n]);
+                    hi_[n] = std::max(hi_[n], b[n]);
+                }
+            }
+        });
+    }
+
+    // The next 'rows' rows of B: rows of K x N if transB = false, rows of N x K (columns of B) otherwise
+    void push(const float *B, int rows, int ldb) {
+        if (transB_) {
+            push_columns(B, rows, ldb);
+        } else {
+            push_rows(B, rows, ldb);
+        }
+    }
+
+    // Pack what is left once all rows are pushed
+    XDNN_PACKED_B<TB> finish() {
+        if (transB_) {
+            assert(pushed_ == N_);
+            int p = pushed_ / panel_cols_;
+            if (staged_rows_ > 0) pack_panel(p, staged_.data(), K_);
+        } else {
+            assert(pushed_ == K_);
+            xdnn_parallel_for((N_ + panel_cols_ - 1) / panel_cols_, [&](int p) {
+                int n0 = p * panel_cols_;
+                int cols = std::min(panel_cols_, N_ - n0);
+                xdnn_packb_with(kernels_, false, cols, K_, weight_.data() + xdnn_elems<TB>((size_t)n0), N_,
+                        buffer_ + p * stride_, block_);
+            });
+            std::vector<TB>().swap(weight_);
+        }
+
+        XDNN_PACKED_B<TB> packed;
+        packed.kernels = &kernels_;
+        packed.N = N_;
+        packed.K = K_;
+        packed.panel_cols = panel_cols_;
+        packed.panels = (N_ + panel_cols_ - 1) / panel_cols_;
+        packed.panel_stride = stride_;
+        packed.block = block_;
+        packed.data = buffer_;
+        packed.scaleB = kernels_.quantize ? scaleB_ : nullptr;
+        packed.zeroB = kernels_.quantize ? zeroB_ : nullptr;
+        return packed;
+    }
+
+private:
+    static constexpr int XDNN_STREAM_COLS = 256; // columns per task of the K chunk passes, a multiple of 8
+
+    // transB = true: columns [pushed_, pushed_ + rows), each row of B holding all of K
+    void push_columns(const float *B, int rows, int ldb) {
+        assert(pushed_ + rows <= N_);
+
+        // Complete the staged panel first
+        if (staged_rows_ > 0) {
+            int take = std::min(rows, panel_cols_ - staged_rows_);
+            stage(B, take, ldb);
+            B += (size_t)take * ldb;
+            rows -= take;
+            if (staged_rows_ == panel_cols_) {
+                pack_panel(pushed_ / panel_cols_ - 1, staged_.data(), K_);
+                staged_rows_ = 0;
+            }
+        }
+
+        // Whole panels straight from the chunk
+        int whole = rows / panel_cols_;
+        int p0 = pushed_ / panel_cols_;
+        xdnn_parallel_for(whole, [&](int i) {
+            pack_panel(p0 + i, B + (size_t)i * panel_cols_ * ldb, ldb);
+        });
+        pushed_ += whole * panel_cols_;
+        B += (size_t)whole * panel_cols_ * ldb;
+        rows -= whole * panel_cols_;
+
+        if (rows > 0) stage(B, rows, ldb);
+    }
+
+    void stage(const float *B, int rows, int ldb) {
+        for (int i = 0; i < rows; ++i) {
+            memcpy(staged_.data() + (size_t)(staged_rows_ + i) * K_, B + (size_t)i * ldb, K_ * sizeof(float));
+        }
+        staged_rows_ += rows;
+        pushed_ += rows;
+    }
+
+    // Panel p from its columns B (cols x K, stride ldb), single threaded
+    void pack_panel(int p, const float *B, int ldb) {
+        int n0 = p * panel_cols_;
+        int cols = std::min(panel_cols_, N_ - n0);
+        TB *dst = buffer_ + p * stride_;
+
+        if constexpr (std::is_same_v<TB, float>) {
+            xdnn_packb_with(kernels_, true, cols, K_, B, ldb, dst, block_);
+        } else {
+            std::vector<TB> converted(xdnn_elems_for<TB>((size_t)cols * K_));
+            if (kernels_.quantize) {
+                kernels_.quantize(true, cols, K_, B, ldb, rate_, converted.data(), K_,
+                        scaleB_ + xdnn_scale_offset(kernels_, K_, n0), zeroB_ + xdnn_zero_offset(kernels_, K_, n0));
+            } else if constexpr (std::is_convertible_v<float, TB>) {
+                for (int n = 0; n < cols; ++n) {
+                    for (int k = 0; k < K_; ++k) converted[(size_t)n * K_ + k] = static_cast<TB>(B[(size_t)n * ldb + k]);
+                }
+            }
+            xdnn_packb_with(kernels_, true, cols, K_, converted.data(), K_, dst, block_);
+        }
+    }
+
+    // transB = false: rows [pushed_, pushed_ + rows) of K into the K x N weight buffer
+    void push_rows(const float *B, int rows, int ldb) {
+        assert(pushed_ + rows <= K_);
+        if (grouped()) {
+            push_groups(B, rows, ldb);
+            return;
+        }
+        assert(!kernels_.quantize || observed_ == K_);
+
+        if (kernels_.quantize && pushed_ == 0) {
+            for (int n = 0; n < N_; ++n) column_params(n, 0, lo_[n], hi_[n]);
+        }
+
+        int k0 = pushed_;
+        xdnn_parallel_for(row_tasks(), [&](int t) {
+            int n0, n1;
+            row_task_cols(t, n0, n1);
+            for (int k = 0; k < rows; ++k) {
+                const float *b = B + (size_t)k * ldb;
+                size_t row = (size_t)(k0 + k) * N_;
+                if (kernels_.quantize) {
+                    for (int n = n0; n < n1; ++n) quantize_value(b[n], scaleB_[n], kernels_.codebook ? 0.0f : zeroB_[n], row + n, 0);
+                } else if constexpr (std::is_convertible_v<float, TB>) {
+                    for (int n = n0; n < n1; ++n) weight_[row + n] = static_cast<TB>(b[n]);
+                }
+            }
+        });
+        pushed_ += rows;
+    }
+
+    // Group-wise tables: each group is quantized as soon as its last row arrives, straight from
+    // the chunk when it holds the whole group, from the staged rows otherwise
+    void push_groups(const float *B, int rows, int ldb) {
+        while (rows > 0) {
+            int g = pushed_ / group_;
+            int k1 = std::min(K_, (g + 1) * group_);
+            int take = std::min(rows, k1 - pushed_);
+            if (staged_rows_ == 0 && take == k1 - g * group_) {
+                quantize_group(g, B, ldb);
+            } else {
+                for (int k = 0; k < take; ++k) {
+                    memcpy(staged_.data() + (size_t)(staged_rows_ + k) * N_, B + (size_t)k * ldb, N_ * sizeof(float));
+                }
+                staged_rows_ += take;
+                if (pushed_ + take == k1) {
+                    quantize_group(g, staged_.data(), N_);
+                    staged_rows_ = 0;
+                }
+            }
+            pushed_ += take;
+            B += (size_t)take * ldb;
+            rows -= take;
+        }
+    }
+
+    // Rows of group g (B, stride ldb) into the weight buffer, with the scales of the group
+    void quantize_group(int g, const float *B, int ldb) {
+        int k0 = g * group_;
+        int rows = std::min(group_, K_ - k0);
+        xdnn_parallel_for(row_tasks(), [&](int t) {
+            int n0, n1;
+            row_task_cols(t, n0, n1);
+            for (int n = n0; n < n1; ++n) {
+                float lo = FLT_MAX, hi = -FLT_MAX;
+                for (int k = 0; k < rows; ++k) {
+                    lo = std::min(lo, B[(size_t)k * ldb + n]);
+                    hi = std::max(hi, B[(size_t)k * ldb + n]);
+                }
+                size_t i = (size_t)n * groups_ + g;
+                column_params(i, g, lo, hi);
+                for (int k = 0; k < rows; ++k) {
+                    quantize_value(B[(size_t)k * ldb + n], scaleB_[i], kernels_.codebook ? 0.0f : zeroB_[i],
+                            (size_t)(k0 + k) * N_ + n, g);
+                }
+            }
+        });
+    }
+
+    // Column tasks over a row of the weight buffer: rows of 4/3/2-bit weights share elements
+    // when N is not a multiple of xdnn_values_per, one task then
+    int row_tasks() const {
+        return N_ % xdnn_values_per<TB> ? 1 : (N_ + XDNN_STREAM_COLS - 1) / XDNN_STREAM_COLS;
+    }
+
+    void row_task_cols(int t, int &n0, int &n1) const {
+        int cols = (N_ + row_tasks() - 1) / row_tasks();
+        n0 = t * cols;
+        n1 = std::min(N_, n0 + cols);
+    }
+
+    bool grouped() const {
+        return !transB_ && kernels_.quantize && kernels_.group_size > 0;
+    }
+
+    // scaleB/zeroB[i] (of group g) from the range of its values
+    void column_params(size_t i, int g, float lo, float hi) {
+        if (kernels_.codebook) {
+            float zero; // the codebook stays in zeroB
+            xdnn_plain_quantize_params<xdnn_fmt_cb4>(lo, hi, scaleB_[i], zero, codebook(g));
+        } else {
+            quantize_params(lo, hi, scaleB_[i], zeroB_[i]);
+        }
+    }
+
+    // The quantization rules of the family, same as its _quantize with quantization_rate = 1
+    void quantize_params(float lo, float hi, float &scale, float &zero) const {
+        if constexpr (std::is_same_v<TB, int8_t>) {
+            xdnn_plain_quantize_params<xdnn_fmt_s8>(lo, hi, scale, zero);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT4x2>) {
+            if (nf4()) xdnn_plain_quantize_params<xdnn_fmt_nf4>(lo, hi, scale, zero);
+            else xdnn_plain_quantize_params<xdnn_fmt_u4>(lo, hi, scale, zero);
+        } else if constexpr (std::is_same_v<TB, XDNN_FP8_E4M3>) {
+            xdnn_plain_quantize_params<xdnn_fmt_e4m3>(lo, hi, scale, zero);
+        } else if constexpr (std::is_same_v<TB, XDNN_FP8_E5M2>) {
+            xdnn_plain_quantize_params<xdnn_fmt_e5m2>(lo, hi, scale, zero);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT2x4>) {
+            xdnn_plain_quantize_params<xdnn_fmt_u2>(lo, hi, scale, zero);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT3x8>) {
+            xdnn_plain_quantize_params<xdnn_fmt_u3>(lo, hi, scale, zero);
+        }
+    }
+
+    void quantize_value(float v, float scale, float zero, size_t idx, int g) {
+        if constexpr (std::is_same_v<TB, int8_t>) {
+            xdnn_plain_quantize_value<xdnn_fmt_s8>(v, scale, zero, weight_.data(), idx);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT4x2>) {
+            if (kernels_.codebook) xdnn_plain_quantize_value<xdnn_fmt_cb4>(v, scale, zero, weight_.data(), idx, codebook(g));
+            else if (nf4()) xdnn_plain_quantize_value<xdnn_fmt_nf4>(v, scale, zero, weight_.data(), idx);
+            else xdnn_plain_quantize_value<xdnn_fmt_u4>(v, scale, zero, weight_.data(), idx);
+        } else if constexpr (std::is_same_v<TB, XDNN_FP8_E4M3>) {
+            xdnn_plain_quantize_value<xdnn_fmt_e4m3>(v, scale, zero, weight_.data(), idx);
+        } else if constexpr (std::is_same_v<TB, XDNN_FP8_E5M2>) {
+            xdnn_plain_quantize_value<xdnn_fmt_e5m2>(v, scale, zero, weight_.data(), idx);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT2x4>) {
+            xdnn_plain_quantize_value<xdnn_fmt_u2>(v, scale, zero, weight_.data(), idx);
+        } else if constexpr (std::is_same_v<TB, XDNN_UINT3x8>) {
+            xdnn_plain_quantize_value<xdnn_fmt_u3>(v, scale, zero, weight_.data(), idx);
+        }
+    }
+
+    bool nf4() const {
+        return strstr(kernels_.name, "nf4") != nullptr;
+    }
+
+    const float *codebook(int g) const {
+        return zeroB_ + XDNN_CODEBOOK_SIZE * g;
+    }
+
+    const XDNN_GEMM_KERNELS<TB> &kernels_;
+    bool transB_;
+    int N_;
+    int K_;
+    TB *buffer_;
+    float *scaleB_;
+    float *zeroB_;
+    float rate_;
+    int panel_cols_;
+    size_t stride_;
+    XDNN_PACKB_BLOCK block_;
+    int groups_;                // scales per column
+    int group_;                 // rows of K per scale
+
+    int pushed_ = 0;            // rows of B pushed so far
+    int observed_ = 0;
+    int staged_rows_ = 0;
+    std::vector<float> staged_; // transB = true: the partial panel; group-wise transB = false: the partial group
+    std::vector<TB> weight_;    // transB = false: the converted/quantized K x N weight
+    std::vector<float> lo_;     // per column quantized transB = false: the range of each column
+    std::vector<float> hi_;
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "packb_size.h"
+#include "tuning_db.h"
+
+// ================================================================================
+// Families packing B in block_rows x block_cols blocks, as seen by the tuner
+//   packb_size(N, K, block) in elements of TB
+//   packb(N, K, B, ldb, packedB, block), B in K x N
+//   compute(M, N, K, A, lda, packedB, block, C, ldc): C = A * packedB
+// ================================================================================
+struct xdnn_blocked_bgemm_f32bf16f32 {
+    using TA = float;
+    using TB = XDNN_BF16;
+    using TC = float;
+    static constexpr const char *name = "bgemm_f32bf16f32";
+    static constexpr XDNN_PACKB_BLOCK fallback = {16, 64};
+
+    static size_t packb_size(int N, int K, XDNN_PACKB_BLOCK b) {
+        return xdnn_bgemm_f32bf16f32_packb_size(N, K, b.block_rows, b.block_cols);
+    }
+
+    static void packb(int N, int K, const TB *B, int ldb, TB *packedB, XDNN_PACKB_BLOCK b) {
+        xdnn_bgemm_f32bf16f32_packb(false, N, K, B, ldb, packedB, b.block_rows, b.block_cols);
+    }
+
+    static void compute(int M, int N, int K, const TA *A, int lda, const TB *packedB, XDNN_PACKB_BLOCK, TC *C, int ldc) {
+        xdnn_bgemm_f32bf16f32_compute(false, M, N, K, 1.0f, A, lda, packedB, 0.0f, C, ldc);
+    }
+};
+
+struct xdnn_blocked_hgemm_f32f16f32 {
+    using TA = float;
+    using TB = XDNN_FP16;
+    using TC = float;
+    static constexpr const char *name = "hgemm_f32f16f32";
+    static constexpr XDNN_PACKB_BLOCK fallback = {0, 0}; // xdnn_hgemm_f32f16f32_packb
+
+    static size_t packb_size(int N, int K, XDNN_PACKB_BLOCK b) {
+        return xdnn_hgemm_f32f16f32_packb_size(N, K, b.block_rows, b.block_cols);
+    }
+
+    static void packb(int N, int K, const TB *B, int ldb, TB *packedB, XDNN_PACKB_BLOCK b) {
+        if (b.block_rows > 0) {
+            xdnn_hgemm_f32f16f32_packb_block(false, N, K, B, ldb, packedB, b.block_rows, b.block_cols);
+        } else {
+            xdnn_hgemm_f32f16f32_packb(false, N, K, B, ldb, packedB);
+        }
+    }
+
+    static void compute(int M, int N, int K, const TA *A, int lda, const TB *packedB, XDNN_PACKB_BLOCK, TC *C, int ldc) {
+        xdnn_hgemm_f32f16f32_compute(false, M, N, K, 1.0f, A, lda, packedB, 0.0f, C, ldc);
+    }
+};
+
+// Candidates tried by default: block_rows (along K) x block_cols (along N)
+inline std::vector<XDNN_PACKB_BLOCK> xdnn_packb_block_candidates(int N, int K) {
+    std::vector<XDNN_PACKB_BLOCK> candidates;
+    for (int rows : {16, 32, 64, 128, 256}) {
+        for (int cols : {32, 64, 128, 256}) {
+            if ((rows <= K || rows == 16) && (cols <= N || cols == 32)) candidates.push_back({rows, cols});
+        }
+    }
+    return candidates;
+}
+
+// Best of 'repeat' runs of f, in microseconds
+template <typename F>
+inline float xdnn_time_us(int repeat, F &&f) {
+    float best = INFINITY;
+    for (int r = 0; r < repeat; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<float, std::micro>(t1 - t0).count());
+    }
+    return best;
+}
+
+// Whether C is the reference result up to the rounding of another summation order
+template <typename TC>
+inline bool xdnn_same_result(const std::vector<TC> &C, const std::vector<float> &refC) {
+    for (size_t i = 0; i < C.size(); ++i) {
+        float c = static_cast<float>(C[i]);
+        if (!(std::abs(c - refC[i]) <= 1e-3f * (1.0f + std::abs(refC[i])))) return false;
+    }
+    return true;
+}
+
+// Benchmark the candidate blockings of Family for N x K on this machine and the current thread
+// count, at M = m_lo, m_hi and their geometric mean, and add the fastest to db:
+//   xdnn_tune_packb_block<xdnn_blocked_bgemm_f32bf16f32>(1, 32, 4096, 4096);
+//   xdnn_tuning_db().save("xdnn_tuning.txt");    // then run with XDNN_TUNING_DB=xdnn_tuning.txt
+// The default blocking of the family is always among the candidates, and is tried first: a candidate
+// whose C at M = m_hi differs from the default's (a block the packb or the kernel doesn't support)
+// is rejected.
+template <typename Family>
+inline XDNN_TUNING_ENTRY xdnn_tune_packb_block(int m_lo, int m_hi, int N, int K,
+        std::vector<XDNN_PACKB_BLOCK> candidates = {}, int repeat = 5, XDNN_TUNING_DB &db = xdnn_tuning_db()) {
+    using TA = typename Family::TA;
+    using TB = typename Family::TB;
+    using TC = typename Family::TC;
+
+    if (candidates.empty()) candidates = xdnn_packb_block_candidates(N, K);
+    candidates.insert(candidates.begin(), Family::fallback);
+
+    int ms[3] = {m_lo, (int)std::lround(std::sqrt((double)m_lo * m_hi)), m_hi};
+    std::vector<TA> A((size_t)m_hi * K);
+    std::vector<TB> B((size_t)K * N);
+    std::vector<TC> C((size_t)m_hi * N);
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<TA>((float)(i % 17) / 17 - 0.5f);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<TB>((float)(i % 13) / 52 - 0.125f);
+
+    XDNN_TUNING_ENTRY best;
+    snprintf(best.family, sizeof(best.family), "%s", Family::name);
+    best.N = N;
+    best.K = K;
+    best.threads = omp_get_max_threads();
+    best.m_lo = m_lo;
+    best.m_hi = m_hi;
+    best.block = Family::fallback;
+    best.us = INFINITY;
+
+    std::vector<float> refC;
+    for (const XDNN_PACKB_BLOCK &block : candidates) {
+        size_t size = Family::packb_size(N, K, block);
+        std::unique_ptr<TB, decltype(&free)> packedB((TB *)aligned_alloc(64, (size * sizeof(TB) + 63) / 64 * 64), &free);
+        Family::packb(N, K, B.data(), N, packedB.get(), block);
+
+        float us = 0;
+        for (int i = 0; i < 3; ++i) {
+            if (i > 0 && ms[i] == ms[i - 1]) continue;
+            Family::compute(ms[i], N, K, A.data(), K, packedB.get(), block, C.data(), N); // warm up
+            us += xdnn_time_us(repeat, [&] {
+                Family::compute(ms[i], N, K, A.data(), K, packedB.get(), block, C.data(), N);
+            });
+        }
+
+        // C holds the run at M = m_hi
+        if (refC.empty()) {
+            refC.resize(C.size());
+            for (size_t i = 0; i < C.size(); ++i) refC[i] = static_cast<float>(C[i]);
+        } else if (!xdnn_same_result(C, refC)) {
+            continue;
+        }
+
+        if (us < best.us) {
+            best.block = block;
+            best.us = us;
+        }
+    }
+
+    db.add(best);
+    return best;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include <omp.h>
+
+#include "gemm_kernels.h"
+#include "packb_size.h"
+#include "parallel.h"
+#include "post_ops.h"
+
+#define XDNN_PANEL_COLS     64 // default columns per panel
+#define XDNN_PANEL_MIN_ROWS 16 // rows of a tile are not split below this
+#define XDNN_TILE_SCRATCH   4096 // floats of the per tile buffers, 16KB to stay in L1
+
+// ================================================================================
+// Packed B split in column panels, each one packed on its own by the family's packb,
+// so that any tile of columns can be computed without knowing the packed layout.
+//   panel p holds columns [p * panel_cols, min(N, (p + 1) * panel_cols))
+// For 4-bit weights panel_cols must be even.
+// The blocked families pack every panel with one block, chosen when the weight is packed
+// for the team it will run on (tuning_db.h) and kept in 'block'.
+// ================================================================================
+template <typename TB>
+struct XDNN_PACKED_B {
+    const XDNN_GEMM_KERNELS<TB> *kernels;
+    int N;
+    int K;
+    int panel_cols;
+    int panels;
+    size_t panel_stride; // in elements of TB, 64 bytes aligned
+    XDNN_PACKB_BLOCK block; // of the blocked families (kernels.packb_block), {0, 0} for the others
+    const TB *data;
+    const float *scaleB; // in N, quantized families only
+    const float *zeroB;
+};
+
+// Block the panels of a weight are packed with for a team of threads, {0, 0} for the families without blocks
+template <typename TB>
+inline XDNN_PACKB_BLOCK xdnn_panel_block(const XDNN_GEMM_KERNELS<TB> &kernels, int K, int panel_cols, int threads) {
+    return kernels.packb_block ? kernels.packb_block(panel_cols, K, threads) : XDNN_PACKB_BLOCK{0, 0};
+}
+
+// kernels.packb_size/packb, with the given block for the blocked families
+template <typename TB>
+inline size_t xdnn_packb_size_with(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K, XDNN_PACKB_BLOCK block) {
+    return kernels.packb_size_blocked ? kernels.packb_size_blocked(N, K, block) : kernels.packb_size(N, K);
+}
+
+template <typename TB>
+inline void xdnn_packb_with(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, const TB *B, int ldb,
+        TB *packedB, XDNN_PACKB_BLOCK block) {
+    if (kernels.packb_blocked) {
+        kernels.packb_blocked(transB, N, K, B, ldb, packedB, block);
+    } else {
+        kernels.packb(transB, N, K, B, ldb, packedB);
+    }
+}
+
+template <typename TB>
+inline size_t xdnn_panel_stride(const XDNN_GEMM_KERNELS<TB> &kernels, int K, int panel_cols, XDNN_PACKB_BLOCK block) {
+    size_t bytes = xdnn_packb_size_with(kernels, panel_cols, K, block) * sizeof(TB);
+    return (bytes + XDNN_PACKB_ALIGN - 1) / XDNN_PACKB_ALIGN * XDNN_PACKB_ALIGN / sizeof(TB);
+}
+
+// Buffer of kernels.packb for N x K
+template <typename TB>
+inline XDNN_PACKB_LAYOUT xdnn_packb_layout(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K) {
+    return xdnn_packb_layout_of<TB>(kernels.packb_size(N, K));
+}
+
+// Elements of TB needed by xdnn_packb_panels with the same panel_cols and threads
+template <typename TB>
+inline size_t xdnn_packb_panels_size(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K, int panel_cols = XDNN_PANEL_COLS,
+        int threads = xdnn_packb_threads()) {
+    int panels = (N + panel_cols - 1) / panel_cols;
+    return panels * xdnn_panel_stride(kernels, K, panel_cols, xdnn_panel_block(kernels, K, panel_cols, threads));
+}
+
+template <typename TB>
+inline XDNN_PACKB_LAYOUT xdnn_packb_panels_layout(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K,
+        int panel_cols = XDNN_PANEL_COLS, int threads = xdnn_packb_threads()) {
+    return xdnn_packb_layout_of<TB>(xdnn_packb_panels_size(kernels, N, K, panel_cols, threads));
+}
+
+// To pack matrix B into buffer (64 bytes aligned, xdnn_packb_panels_size elements)
+// B is in K x N if transB = false
+// B is in N x K if transB = true
+// scaleB/zeroB are referenced by the result, not copied
+// threads: team size the weight is packed for, which picks the tuned block of the blocked families
+template <typename TB>
+inline XDNN_PACKED_B<TB> xdnn_packb_panels(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K,
+        const TB *B, int ldb, const float *scaleB, const float *zeroB, TB *buffer, int panel_cols = XDNN_PANEL_COLS,
+        int threads = xdnn_packb_threads()) {
+    XDNN_PACKED_B<TB> packed;
+    packed.kernels = &kernels;
+    packed.N = N;
+    packed.K = K;
+    packed.panel_cols = panel_cols;
+    packed.panels = (N + panel_cols - 1) / panel_cols;
+    packed.block = xdnn_panel_block(kernels, K, panel_cols, threads);
+    packed.panel_stride = xdnn_panel_stride(kernels, K, panel_cols, packed.block);
+    packed.data = buffer;
+    packed.scaleB = scaleB;
+    packed.zeroB = zeroB;
+
+    xdnn_parallel_for(packed.panels, [&](int p) {
+        int n0 = p * panel_cols;
+        int cols = std::min(panel_cols, N - n0);
+        const TB *src = B + xdnn_elems<TB>(transB ? (size_t)n0 * ldb : (size_t)n0);
+        xdnn_packb_with(kernels, transB, cols, K, src, ldb, buffer + p * packed.panel_stride, packed.block);
+    });
+
+    return packed;
+}
+
+template <typename TB>
+inline int xdnn_panel_cols_of(const XDNN_PACKED_B<TB> &packedB, int p) {
+    return std::min(packedB.panel_cols, packedB.N - p * packedB.panel_cols);
+}
+
+// C[m0:m0+rows, panel p] = ops(alpha * A[m0:m0+rows, :] * packedB[:, panel p] + beta * C), single threaded
+template <typename TB>
+inline void xdnn_packed_b_compute_tile(const XDNN_PACKED_B<TB> &packedB, bool transA, int m0, int rows, int p,
+        float alpha, const float *A, int lda, float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    int n0 = p * packedB.panel_cols;
+    int cols = xdnn_panel_cols_of(packedB, p);
+    const float *a = transA ? A + m0 : A + (size_t)m0 * lda;
+    const float *scale = packedB.scaleB ? packedB.scaleB + xdnn_scale_offset(*packedB.kernels, packedB.K, n0) : nullptr;
+    const float *zero = packedB.zeroB ? packedB.zeroB + xdnn_zero_offset(*packedB.kernels, packedB.K, n0) : nullptr;
+    XDNN_POST_OPS sub = xdnn_post_ops_at(ops, m0, n0);
+
+    xdnn_gemm_compute(*packedB.kernels, transA, rows, cols, packedB.K, alpha, a, lda,
+            packedB.data + p * packedB.panel_stride, scale, zero, beta, C + (size_t)m0 * ldc + n0, ldc, &sub);
+}
+
+// Row blocks per problem so that a problem with the given panels makes about 2 tiles per thread
+inline int xdnn_row_blocks(int M, int panels, int threads) {
+    int max_blocks = std::max(1, (M + XDNN_PANEL_MIN_ROWS - 1) / XDNN_PANEL_MIN_ROWS);
+    int wanted = std::max(1, (2 * threads + panels - 1) / panels);
+    return std::min(max_blocks, wanted);
+}
+
+// C = ops(alpha * A * packedB + beta * C), parallel over row blocks x panels
+template <typename TB>
+inline void xdnn_packed_b_compute(const XDNN_PACKED_B<TB> &packedB, bool transA, int M,
+        float alpha, const float *A, int lda, float beta, float *C, int ldc, const XDNN_POST_OPS *ops) {
+    int mblocks = xdnn_row_blocks(M, packedB.panels, omp_get_max_threads());
+    int rows = (M + mblocks - 1) / mblocks;
+
+    xdnn_parallel_for(mblocks * packedB.panels, [&](int t) {
+        int m0 = (t / packedB.panels) * rows;
+        int p = t % packedB.panels;
+        if (m0 < M) {
+            xdnn_packed_b_compute_tile(packedB, transA, m0, std::min(rows, M - m0), p, alpha, A, lda, beta, C, ldc, ops);
+        }
+    });
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gemm_kernels.h"
+#include "packed_b.h"
+#include "tuning_db.h"
+
+#define XDNN_PACKED_FILE_MAGIC   "XDNNPKB"
+#define XDNN_PACKED_FILE_VERSION 1
+#define XDNN_PACKED_FILE_ALIGN   4096 // the data starts on a page, so a mapping can be used in place
+
+// ================================================================================
+// On-disk container of one panel packed B (packed_b.h), saved once after quantize + packb
+// and mapped read only by later processes, which pass it to the _compute paths without a copy.
+// Processes mapping the same file share its page cache.
+//   | header | pad to 4KB | panels (panels x panel_stride TB) | scaleB | zeroB |
+// scaleB holds xdnn_scale_count floats (N, or N x groups for the group-wise tables), zeroB
+// xdnn_zero_count (the same, or the codebooks of the codebook tables).
+// The layout of the panels is the one of the kernel table that packed them, so a file only
+// loads with a table of the same family and ISA tier. The blocked families record the block
+// the panels were packed with, which the loaded weight keeps whatever the team of the process.
+// ================================================================================
+struct XDNN_PACKED_FILE_HEADER {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    char family[32];        // XDNN_GEMM_KERNELS::name
+    uint32_t isa;           // XDNN_CPU_ISA of the table
+    uint32_t dtype;         // XDNN_DATA_TYPE of the weights
+    int32_t N;
+    int32_t K;
+    int32_t panel_cols;
+    int32_t panels;
+    int32_t block_rows;     // packb block of the blocked families, 0 otherwise
+    int32_t block_cols;
+    uint64_t panel_stride;  // in elements of TB
+    uint64_t data_offset;   // in bytes from the start of the file
+    uint64_t data_bytes;
+    uint64_t scale_offset;  // 0 if no scaleB
+    uint64_t zero_offset;   // 0 if no zeroB
+    uint64_t file_bytes;
+};
+
+template <typename TB>
+inline XDNN_DATA_TYPE xdnn_packed_dtype(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    if constexpr (std::is_same_v<TB, float>) return XDNN_DT_FP32;
+    else if constexpr (std::is_same_v<TB, XDNN_FP16>) return XDNN_DT_FP16;
+    else if constexpr (std::is_same_v<TB, XDNN_BF16>) return XDNN_DT_BF16;
+    else if constexpr (std::is_same_v<TB, int8_t>) return XDNN_DT_INT8;
+    else if constexpr (std::is_same_v<TB, XDNN_FP8_E4M3>) return XDNN_DT_FP8_E4M3;
+    else if constexpr (std::is_same_v<TB, XDNN_FP8_E5M2>) return XDNN_DT_FP8_E5M2;
+    else if constexpr (std::is_same_v<TB, XDNN_UINT2x4>) return XDNN_DT_UINT2;
+    else if constexpr (std::is_same_v<TB, XDNN_UINT3x8>) return XDNN_DT_UINT3;
+    else return strstr(kernels.name, "nf4") ? XDNN_DT_NF4 : XDNN_DT_UINT4;
+}
+
+template <typename TB>
+inline XDNN_PACKED_FILE_HEADER xdnn_packed_file_header(const XDNN_PACKED_B<TB> &packedB) {
+    XDNN_PACKED_FILE_HEADER h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, XDNN_PACKED_FILE_MAGIC, sizeof(h.magic));
+    h.version = XDNN_PACKED_FILE_VERSION;
+    h.header_size = sizeof(h);
+    snprintf(h.family, sizeof(h.family), "%s", packedB.kernels->name);
+    h.isa = packedB.kernels->isa;
+    h.dtype = xdnn_packed_dtype(*packedB.kernels);
+    h.N = packedB.N;
+    h.K = packedB.K;
+    h.panel_cols = packedB.panel_cols;
+    h.panels = packedB.panels;
+    h.block_rows = packedB.block.block_rows;
+    h.block_cols = packedB.block.block_cols;
+    h.panel_stride = packedB.panel_stride;
+    h.data_offset = XDNN_PACKED_FILE_ALIGN;
+    h.data_bytes = (uint64_t)packedB.panels * packedB.panel_stride * sizeof(TB);
+
+    uint64_t end = h.data_offset + h.data_bytes;
+    uint64_t scale_bytes = (xdnn_scale_count(*packedB.kernels, packedB.N, packedB.K) * sizeof(float) + 63) / 64 * 64;
+    uint64_t zero_bytes = (xdnn_zero_count(*packedB.kernels, packedB.N, packedB.K) * sizeof(float) + 63) / 64 * 64;
+    if (packedB.scaleB) {
+        h.scale_offset = end;
+        end += scale_bytes;
+    }
+    if (packedB.zeroB) {
+        h.zero_offset = end;
+        end += zero_bytes;
+    }
+    h.file_bytes = end;
+    return h;
+}
+
+// Write packedB to path, false on an I/O error
+template <typename TB>
+inline bool xdnn_save_packed_b(const char *path, const XDNN_PACKED_B<TB> &packedB) {
+    XDNN_PACKED_FILE_HEADER h = xdnn_packed_file_header(packedB);
+    FILE *fp = fopen(path, "wb");
+    if (fp == nullptr) return false;
+
+    auto write_at = [&](uint64_t offset, const void *data, size_t bytes) {
+        return fseek(fp, (long)offset, SEEK_SET) == 0 && fwrite(data, 1, bytes, fp) == bytes;
+    };
+
+    bool ok = write_at(0, &h, sizeof(h)) && write_at(h.data_offset, packedB.data, h.data_bytes);
+    size_t scale_bytes = xdnn_scale_count(*packedB.kernels, packedB.N, packedB.K) * sizeof(float);
+    size_t zero_bytes = xdnn_zero_count(*packedB.kernels, packedB.N, packedB.K) * sizeof(float);
+    if (ok && packedB.scaleB) ok = write_at(h.scale_offset, packedB.scaleB, scale_bytes);
+    if (ok && packedB.zeroB) ok = write_at(h.zero_offset, packedB.zeroB, zero_bytes);
+    ok = ok && fflush(fp) == 0 && ftruncate(fileno(fp), (off_t)h.file_bytes) == 0;
+    return fclose(fp) == 0 && ok;
+}
+
+// A packed B file mapped read only, the weights stay valid for the lifetime of the object:
+//   XDNN_PACKED_B_FILE<int8_t> file("wq.xpk", xdnn_sgemm_f32s8f32_kernels());
+//   if (!file.valid()) { fprintf(stderr, "%s\n", file.error()); ... }
+//   xdnn_packed_b_compute(file.packed(), false, M, 1.0f, A, lda, 0.0f, C, ldc, nullptr);
+template <typename TB>
+class XDNN_PACKED_B_FILE {
+public:
+    // populate: read the whole file in at load time instead of on first touch
+    XDNN_PACKED_B_FILE(const char *path, const XDNN_GEMM_KERNELS<TB> &kernels, bool populate = false) {
+        memset(&packed_, 0, sizeof(packed_));
+
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            error_ = "cannot open file";
+            return;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(XDNN_PACKED_FILE_HEADER)) {
+            error_ = "not a packed B file";
+            close(fd);
+            return;
+        }
+
+        bytes_ = st.st_size;
+        void *base = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED | (populate ? MAP_POPULATE : 0), fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            error_ = "mmap failed";
+            return;
+        }
+        base_ = base;
+
+        error_ = check(*(const XDNN_PACKED_FILE_HEADER *)base_, kernels);
+        if (error_ == nullptr) {
+            const XDNN_PACKED_FILE_HEADER &h = header();
+            const char *p = (const char *)base_;
+            packed_.kernels = &kernels;
+            packed_.N = h.N;
+            packed_.K = h.K;
+            packed_.panel_cols = h.panel_cols;
+            packed_.panels = h.panels;
+            packed_.panel_stride = h.panel_stride;
+            packed_.block = {h.block_rows, h.block_cols};
+            packed_.data = (const TB *)(p + h.data_offset);
+            packed_.scaleB = h.scale_offset ? (const float *)(p + h.scale_offset) : nullptr;
+            packed_.zeroB = h.zero_offset ? (const float *)(p + h.zero_offset) : nullptr;
+        }
+    }
+
+    ~XDNN_PACKED_B_FILE() {
+        if (base_) munmap(base_, bytes_);
+    }
+
+    XDNN_PACKED_B_FILE(const XDNN_PACKED_B_FILE &) = delete;
+    XDNN_PACKED_B_FILE &operator=(const XDNN_PACKED_B_FILE &) = delete;
+
+    bool valid() const {
+        return error_ == nullptr;
+    }
+
+    // Why the file did not load, nullptr if valid
+    const char *error() const {
+        return error_;
+    }
+
+    const XDNN_PACKED_FILE_HEADER &header() const {
+        return *(const XDNN_PACKED_FILE_HEADER *)base_;
+    }
+
+    const XDNN_PACKED_B<TB> &packed() const {
+        return packed_;
+    }
+
+private:
+    const char *check(const XDNN_PACKED_FILE_HEADER &h, const XDNN_GEMM_KERNELS<TB> &kernels) const {
+        if (memcmp(h.magic, XDNN_PACKED_FILE_MAGIC, sizeof(h.magic)) != 0) return "not a packed B file";
+        if (h.version != XDNN_PACKED_FILE_VERSION || h.header_size != sizeof(h)) return "unsupported version";
+        if (h.file_bytes > bytes_) return "truncated file";
+        if (strncmp(h.family, kernels.name, sizeof(h.family)) != 0) return "packed by another family";
+        if (h.isa != (uint32_t)kernels.isa) return "packed for another ISA tier";
+        if (h.dtype != (uint32_t)xdnn_packed_dtype(kernels)) return "packed with another data type";
+        if (h.N <= 0 || h.K <= 0 || h.panel_cols <= 0 || h.panels != (h.N + h.panel_cols - 1) / h.panel_cols) {
+            return "bad shape";
+        }
+        XDNN_PACKB_BLOCK block = {h.block_rows, h.block_cols};
+        if (kernels.packb_block ? block.block_rows < 0 || block.block_cols < 0 : block.block_rows != 0 || block.block_cols != 0) {
+            return "bad packb block";
+        }
+        if (h.panel_stride != xdnn_panel_stride(kernels, h.K, h.panel_cols, block)
+                || h.data_bytes != h.panels * h.panel_stride * sizeof(TB) || h.data_offset % 64 != 0
+                || h.data_offset + h.data_bytes > h.file_bytes) {
+            return "bad layout";
+        }
+        uint64_t scale_bytes = xdnn_scale_count(kernels, h.N, h.K) * sizeof(float);
+        uint64_t zero_bytes = xdnn_zero_count(kernels, h.N, h.K) * sizeof(float);
+        if ((h.scale_offset && (h.scale_offset % 64 != 0 || h.scale_offset + scale_bytes > h.file_bytes))
+                || (h.zero_offset && (h.zero_offset % 64 != 0 || h.zero_offset + zero_bytes > h.file_bytes))) {
+            return "bad layout";
+        }
+        // FP8 weights have no zeroB, and an FP8 checkpoint may come without scaleB
+        bool fp8 = h.dtype == XDNN_DT_FP8_E4M3 || h.dtype == XDNN_DT_FP8_E5M2;
+        if (kernels.quantize && !fp8 && (h.scale_offset == 0 || h.zero_offset == 0)) return "missing scaleB/zeroB";
+        return nullptr;
+    }
+
+    void *base_ = nullptr;
+    size_t bytes_ = 0;
+    const char *error_ = nullptr;
+    XDNN_PACKED_B<TB> packed_;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <omp.h>
+
+#include "thread_context.h"
+#include "thread_pool.h"
+
+// Run f(task) for task in [0, tasks) on the pool of the current thread context, or on the
+// OpenMP team. Kernels called from f run single threaded, as nested parallel regions are
+// inactive and the pool threads are limited to one OpenMP thread.
+template <typename F>
+inline void xdnn_parallel_for(int tasks, F &&f) {
+    if (tasks <= 0) return;
+    if (tasks == 1 || omp_in_parallel() || XDNN_THREAD_POOL::in_pool()) {
+        for (int t = 0; t < tasks; ++t) f(t);
+        return;
+    }
+
+    const XDNN_THREAD_CONTEXT *ctx = xdnn_current_thread_context();
+    if (ctx && ctx->pool) {
+        ctx->pool->run(tasks, f);
+        return;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int t = 0; t < tasks; ++t) {
+        f(t);
+    }
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "data_types/data_types.h"
+
+// One step of the epilogue of the _compute families with a kernel table (fp32 A and C), applied
+// on Y = alpha * A * packedB + beta * C. The fp16/bf16 A or C library families (hgemm,
+// hgemm_f16f16f32, hgemm_f32f16f16, sgemm_bf16bf16f32, amx_sgemm_bf16bf16bf16) take no chain.
+//   XDNN_POST_OP_BIAS:    Y = Y + vec[n] (vec may be null)
+//   XDNN_POST_OP_SCALE:   Y = Y * alpha * vec[n] (vec may be null)
+//   XDNN_POST_OP_SILU:    Y = SILU(Y)
+//   XDNN_POST_OP_GELU:    Y = GELU(Y)
+//   XDNN_POST_OP_RELU:    Y = RELU(Y)
+//   XDNN_POST_OP_RES_ADD: Y = Y + alpha * mat[m, n]
+//   XDNN_POST_OP_RES_MUL: Y = Y * mat[m, n]
+//   XDNN_POST_OP_CLAMP:   Y = min(max(Y, alpha), beta)
+//   XDNN_POST_OP_CONVERT: dst[m, n] = Y stored as dtype (FP32, FP16 or BF16), Y is unchanged
+//   XDNN_POST_OP_STREAM:  Y is unchanged; C is written once with non-temporal stores, so it does
+//                         not evict the packed weights from the LLC (beta == 0, portable and W8A8 kernels)
+enum XDNN_POST_OP_KIND {
+    XDNN_POST_OP_NONE = 0,
+    XDNN_POST_OP_BIAS,
+    XDNN_POST_OP_SCALE,
+    XDNN_POST_OP_SILU,
+    XDNN_POST_OP_GELU,
+    XDNN_POST_OP_RELU,
+    XDNN_POST_OP_RES_ADD,
+    XDNN_POST_OP_RES_MUL,
+    XDNN_POST_OP_CLAMP,
+    XDNN_POST_OP_CONVERT,
+    XDNN_POST_OP_STREAM,
+};
+
+// vec is in N, mat and dst are in M x N with stride ld
+struct XDNN_POST_OP {
+    XDNN_POST_OP_KIND kind;
+    const float *vec;
+    const float *mat;
+    void *dst;
+    int ld;
+    float alpha;
+    float beta;
+    XDNN_DATA_TYPE dtype;
+};
+
+#define XDNN_MAX_POST_OPS 8
+
+// Ordered list of post ops, applied on each C tile while it is still in cache.
+// count = 0 is the plain C = alpha * A * packedB + beta * C
+struct XDNN_POST_OPS {
+    int count;
+    XDNN_POST_OP ops[XDNN_MAX_POST_OPS];
+};
+
+inline XDNN_POST_OP xdnn_post_op_bias(const float *bias) {
+    return {XDNN_POST_OP_BIAS, bias};
+}
+
+inline XDNN_POST_OP xdnn_post_op_scale(float alpha, const float *scale = nullptr) {
+    return {XDNN_POST_OP_SCALE, scale, nullptr, nullptr, 0, alpha};
+}
+
+inline XDNN_POST_OP xdnn_post_op_silu() {
+    return {XDNN_POST_OP_SILU};
+}
+
+inline XDNN_POST_OP xdnn_post_op_gelu() {
+    return {XDNN_POST_OP_GELU};
+}
+
+inline XDNN_POST_OP xdnn_post_op_relu() {
+    return {XDNN_POST_OP_RELU};
+}
+
+inline XDNN_POST_OP xdnn_post_op_res_add(const float *res, int ldres, float gamma = 1.0f) {
+    return {XDNN_POST_OP_RES_ADD, nullptr, res, nullptr, ldres, gamma};
+}
+
+inline XDNN_POST_OP xdnn_post_op_res_mul(const float *res, int ldres) {
+    return {XDNN_POST_OP_RES_MUL, nullptr, res, nullptr, ldres};
+}
+
+inline XDNN_POST_OP xdnn_post_op_clamp(float lo, float hi) {
+    return {XDNN_POST_OP_CLAMP, nullptr, nullptr, nullptr, 0, lo, hi};
+}
+
+inline XDNN_POST_OP xdnn_post_op_convert(XDNN_DATA_TYPE dtype, void *dst, int lddst) {
+    return {XDNN_POST_OP_CONVERT, nullptr, nullptr, dst, lddst, 0.0f, 0.0f, dtype};
+}
+
+inline XDNN_POST_OP xdnn_post_op_stream() {
+    return {XDNN_POST_OP_STREAM};
+}
+
+// e.g. xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_gelu()})
+inline XDNN_POST_OPS xdnn_post_ops(std::initializer_list<XDNN_POST_OP> ops) {
+    assert(ops.size() <= XDNN_MAX_POST_OPS);
+    XDNN_POST_OPS chain = {0};
+    for (const XDNN_POST_OP &op : ops) {
+        if (chain.count < XDNN_MAX_POST_OPS) chain.ops[chain.count++] = op;
+    }
+    return chain;
+}
+
+inline int xdnn_post_ops_count(const XDNN_POST_OPS *ops) {
+    return ops ? ops->count : 0;
+}
+
+// Append the ops of 'more' at the end of chain
+inline void xdnn_post_ops_append(XDNN_POST_OPS *chain, const XDNN_POST_OPS *more) {
+    assert(chain->count + xdnn_post_ops_count(more) <= XDNN_MAX_POST_OPS);
+    for (int i = 0; i < xdnn_post_ops_count(more) && chain->count < XDNN_MAX_POST_OPS; ++i) {
+        chain->ops[chain->count++] = more->ops[i];
+    }
+}
+
+// The chain of the sub block starting at (m0, n0)
+inline XDNN_POST_OPS xdnn_post_ops_at(const XDNN_POST_OPS *ops, int m0, int n0) {
+    XDNN_POST_OPS sub = {0};
+    if (ops == nullptr) return sub;
+    sub = *ops;
+    for (int i = 0; i < sub.count; ++i) {
+        XDNN_POST_OP &op = sub.ops[i];
+        size_t offset = (size_t)m0 * op.ld + n0;
+        if (op.vec) op.vec += n0;
+        if (op.mat) op.mat += offset;
+        if (op.dst) {
+            size_t bytes = op.dtype == XDNN_DT_FP32 ? sizeof(float) : sizeof(uint16_t);
+            op.dst = (char *)op.dst + offset * bytes;
+        }
+    }
+    return sub;
+}
+
+// The chain without its first 'skip' ops
+inline XDNN_POST_OPS xdnn_post_ops_tail(const XDNN_POST_OPS *ops, int skip) {
+    XDNN_POST_OPS tail = {0};
+    for (int i = skip; i < xdnn_post_ops_count(ops); ++i) {
+        tail.ops[tail.count++] = ops->ops[i];
+    }
+    return tail;
+}
+
+inline bool xdnn_post_ops_has(const XDNN_POST_OPS *ops, XDNN_POST_OP_KIND kind) {
+    for (int i = 0; i < xdnn_post_ops_count(ops); ++i) {
+        if (ops->ops[i].kind == kind) return true;
+    }
+    return false;
+}
+
+// Whether b is the chain a but for its buffers: the same kinds and scalars, vec set on the same ops
+inline bool xdnn_post_ops_same_kinds(const XDNN_POST_OPS *a, const XDNN_POST_OPS *b) {
+    int n = xdnn_post_ops_count(a);
+    if (n != xdnn_post_ops_count(b)) return false;
+    for (int i = 0; i < n; ++i) {
+        const XDNN_POST_OP &x = a->ops[i];
+        const XDNN_POST_OP &y = b->ops[i];
+        if (x.kind != y.kind || x.alpha != y.alpha || x.beta != y.beta || x.dtype != y.dtype
+                || (x.vec == nullptr) != (y.vec == nullptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The chain without its ops of a kind
+inline XDNN_POST_OPS xdnn_post_ops_drop(const XDNN_POST_OPS *ops, XDNN_POST_OP_KIND kind) {
+    XDNN_POST_OPS rest = {0};
+    for (int i = 0; i < xdnn_post_ops_count(ops); ++i) {
+        if (ops->ops[i].kind != kind) rest.ops[rest.count++] = ops->ops[i];
+    }
+    return rest;
+}
+
+inline float xdnn_silu(float x) {
+    return x / (1.0f + std::exp(-x));
+}
+
+// tanh approximation, same as the _compute_gelu kernels
+inline float xdnn_gelu(float x) {
+    const float c = 0.7978845608028654f; // sqrt(2 / pi)
+    return 0.5f * x * (1.0f + std::tanh(c * (x + 0.044715f * x * x * x)));
+}
+
+// Apply one op on the row m of the tile, c points to (m, n0)
+inline void xdnn_apply_post_op(const XDNN_POST_OP &op, int m, int n0, int cols, float *c) {
+    const float *vec = op.vec ? op.vec + n0 : nullptr;
+    const float *mat = op.mat ? op.mat + (size_t)m * op.ld + n0 : nullptr;
+    size_t offset = (size_t)m * op.ld + n0;
+
+    switch (op.kind) {
+        case XDNN_POST_OP_BIAS:
+            if (vec == nullptr) break;
+            for (int j = 0; j < cols; ++j) c[j] += vec[j];
+            break;
+        case XDNN_POST_OP_SCALE:
+            if (vec) {
+                for (int j = 0; j < cols; ++j) c[j] *= op.alpha * vec[j];
+            } else {
+                for (int j = 0; j < cols; ++j) c[j] *= op.alpha;
+            }
+            break;
+        case XDNN_POST_OP_SILU:
+            for (int j = 0; j < cols; ++j) c[j] = xdnn_silu(c[j]);
+            break;
+        case XDNN_POST_OP_GELU:
+            for (int j = 0; j < cols; ++j) c[j] = xdnn_gelu(c[j]);
+            break;
+        case XDNN_POST_OP_RELU:
+            for (int j = 0; j < cols; ++j) c[j] = std::fmax(c[j], 0.0f);
+            break;
+        case XDNN_POST_OP_RES_ADD:
+            for (int j = 0; j < cols; ++j) c[j] += op.alpha * mat[j];
+            break;
+        case XDNN_POST_OP_RES_MUL:
+            for (int j = 0; j < cols; ++j) c[j] *= mat[j];
+            break;
+        case XDNN_POST_OP_CLAMP:
+            for (int j = 0; j < cols; ++j) c[j] = std::fmin(std::fmax(c[j], op.alpha), op.beta);
+            break;
+        case XDNN_POST_OP_CONVERT:
+            if (op.dtype == XDNN_DT_FP16) {
+                XDNN_FP16 *dst = (XDNN_FP16 *)op.dst + offset;
+                for (int j = 0; j < cols; ++j) dst[j] = c[j];
+            } else if (op.dtype == XDNN_DT_BF16) {
+                XDNN_BF16 *dst = (XDNN_BF16 *)op.dst + offset;
+                for (int j = 0; j < cols; ++j) dst[j] = c[j];
+            } else {
+                float *dst = (float *)op.dst + offset;
+                for (int j = 0; j < cols; ++j) dst[j] = c[j];
+            }
+            break;
+        case XDNN_POST_OP_STREAM: // how C is stored, xdnn_store_stream
+        default: break;
+    }
+}
+
+// Apply the chain in place on the tile C[m0:m0+rows, n0:n0+cols], C points to (m0, n0).
+// All ops run on one row before moving to the next, so the row stays in L1.
+inline void xdnn_apply_post_ops(const XDNN_POST_OPS *ops, int m0, int n0, int rows, int cols, float *C, int ldc) {
+    if (xdnn_post_ops_count(ops) == 0) return;
+
+    for (int i = 0; i < rows; ++i) {
+        float *c = C + (size_t)i * ldc;
+        for (int k = 0; k < ops->count; ++k) {
+            xdnn_apply_post_op(ops->ops[k], m0 + i, n0, cols, c);
+        }
+    }
+}
+
+// dst[0:cols] = src[0:cols] with non-temporal stores from the first 32 byte aligned element
+// of dst on. Callers order the stores with _mm_sfence() before C is read by another thread.
+inline void xdnn_store_stream(float *dst, const float *src, int cols) {
+    int j = 0;
+#if defined(__AVX__)
+    for (; j < cols && ((uintptr_t)(dst + j) & 31) != 0; ++j) dst[j] = src[j];
+    for (; j + 8 <= cols; j += 8) _mm256_stream_ps(dst + j, _mm256_loadu_ps(src + j));
+#endif
+    for (; j < cols; ++j) dst[j] = src[j];
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <immintrin.h>
+#include <omp.h>
+
+#include "thread_context.h"
+
+// ================================================================================
+// Software prefetch of packed weights, to warm the next layer's B while the current
+// gemm runs. xdnn_prefetch_packed prefetches a range on the calling thread (a helper
+// thread, or the caller between calls). An XDNN_PREFETCH_SCOPE sets a "next weight" hint
+// on the calling thread; inside it, each thread of the portable kernels prefetches its
+// share of the hint once its own tiles are done, in the idle tail of the call.
+// L1 and L2 are private to a core, so a share prefetched there only helps if the thread
+// that took it reads those bytes in the next call. The shares go to whichever thread is
+// free first, so the kernels prefetch them into the LLC, and keep the L1/L2 of the hint
+// only on a pool pinned to cpus (xdnn_prefetch_share_level).
+// ================================================================================
+#define XDNN_CACHE_LINE 64
+
+enum XDNN_PREFETCH_LEVEL {
+    XDNN_PREFETCH_L1,
+    XDNN_PREFETCH_L2,
+    XDNN_PREFETCH_LLC,
+};
+
+// Prefetch the cache lines of [ptr, ptr + bytes) into level. Only useful up to the size of
+// that level; for a large packed B, give the first panels (the rows of K read first).
+inline void xdnn_prefetch_packed(const void *ptr, size_t bytes, XDNN_PREFETCH_LEVEL level = XDNN_PREFETCH_L2) {
+    if (!ptr || bytes == 0) return;
+    uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(XDNN_CACHE_LINE - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + bytes;
+    for (uintptr_t p = begin; p < end; p += XDNN_CACHE_LINE) {
+        const char *line = reinterpret_cast<const char *>(p);
+        switch (level) {
+            case XDNN_PREFETCH_L1: _mm_prefetch(line, _MM_HINT_T0); break;
+            case XDNN_PREFETCH_L2: _mm_prefetch(line, _MM_HINT_T1); break;
+            default: _mm_prefetch(line, _MM_HINT_T2); break;
+        }
+    }
+}
+
+struct XDNN_PREFETCH_HINT {
+    const void *ptr;
+    size_t bytes;
+    XDNN_PREFETCH_LEVEL level;
+};
+
+// The hint current on the calling thread, nullptr outside of any XDNN_PREFETCH_SCOPE
+inline const XDNN_PREFETCH_HINT *&xdnn_current_prefetch_hint() {
+    static thread_local const XDNN_PREFETCH_HINT *current = nullptr;
+    return current;
+}
+
+// Bytes [begin, end) of a range of 'bytes' prefetched by thread t of a team of n: whole
+// cache lines, split evenly
+inline void xdnn_prefetch_share_range(size_t bytes, int t, int n, size_t &begin, size_t &end) {
+    size_t lines = (bytes + XDNN_CACHE_LINE - 1) / XDNN_CACHE_LINE;
+    size_t per = (lines + n - 1) / n;
+    begin = std::min(bytes, std::min(lines, (size_t)t * per) * XDNN_CACHE_LINE);
+    end = std::min(bytes, std::min(lines, (size_t)(t + 1) * per) * XDNN_CACHE_LINE);
+}
+
+// Level the shares of hint are prefetched into by the calls of the calling thread: the level of
+// the hint on the pool of a thread context pinned to cpus, whose workers stay on their cores
+// and take the tiles of back to back calls of a shape in about the same order; the LLC elsewhere
+inline XDNN_PREFETCH_LEVEL xdnn_prefetch_share_level(const XDNN_PREFETCH_HINT *hint) {
+    if (!hint || hint->level == XDNN_PREFETCH_LLC) return XDNN_PREFETCH_LLC;
+    const XDNN_THREAD_CONTEXT *ctx = xdnn_current_thread_context();
+    return ctx && ctx->pool && ctx->ncpus > 0 ? hint->level : XDNN_PREFETCH_LLC;
+}
+
+inline void xdnn_prefetch_share(const XDNN_PREFETCH_HINT *hint, int t, int n, XDNN_PREFETCH_LEVEL level) {
+    if (!hint || !hint->ptr || hint->bytes == 0) return;
+    size_t begin, end;
+    xdnn_prefetch_share_range(hint->bytes, t, n, begin, end);
+    if (begin < end) xdnn_prefetch_packed(static_cast<const char *>(hint->ptr) + begin, end - begin, level);
+}
+
+// Tasks to add after the tile tasks of a scheduler (xdnn_parallel_for, on the OpenMP team or
+// the pool) for the hint: one share per thread, claimed by threads done with their tiles
+inline int xdnn_prefetch_tasks(const XDNN_PREFETCH_HINT *hint, int threads) {
+    return hint && hint->ptr && hint->bytes > 0 ? std::max(1, threads) : 0;
+}
+
+// Make the next layer's packed B the hint of the gemm calls in the scope:
+//   {
+//       XDNN_PREFETCH_SCOPE next(layers[i + 1].packedB, bytes);
+//       xdnn_gemm_compute(layers[i].kernels, ...);
+//   }
+// Scopes nest; the previous hint comes back on exit. The library AMX kernels do not
+// consume the hint; call xdnn_prefetch_packed from a helper thread for those.
+// XDNN_PREFETCH_L2 pays off only with a pinned pool (see xdnn_prefetch_share_level).
+class XDNN_PREFETCH_SCOPE {
+public:
+    XDNN_PREFETCH_SCOPE(const void *ptr, size_t bytes, XDNN_PREFETCH_LEVEL level = XDNN_PREFETCH_LLC)
+            : hint_{ptr, bytes, level}, prev_(xdnn_current_prefetch_hint()) {
+        xdnn_current_prefetch_hint() = &hint_;
+    }
+
+    ~XDNN_PREFETCH_SCOPE() {
+        xdnn_current_prefetch_hint() = prev_;
+    }
+
+    XDNN_PREFETCH_SCOPE(const XDNN_PREFETCH_SCOPE &) = delete;
+    XDNN_PREFETCH_SCOPE &operator=(const XDNN_PREFETCH_SCOPE &) = delete;
+
+private:
+    XDNN_PREFETCH_HINT hint_;
+    const XDNN_PREFETCH_HINT *prev_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include "data_types/data_types.h"
+#include "gemm_kernels.h"
+#include "gemm_w8a8.h"
+#include "packed_b.h"
+#include "parallel.h"
+
+// ================================================================================
+// Quantization of B in fp32, fp16 or bf16 for the quantized families (s8, i8, u4, nf4, fp8, u2, u3, w8a8),
+// so a checkpoint in half precision is never expanded to a full fp32 copy.
+//   xdnn_quantize: same result as the fp32 _quantize of B converted to fp32
+//   xdnn_quantize_packb: quantize + pack in one call, same result as _quantize into
+//     a buffer then _packb of it. The portable tables quantize straight into the packed
+//     layout; the library ones go through a buffer of the weight type, since their packed
+//     layout is opaque.
+// ================================================================================
+
+// To quantize B into quantizedB (N x K if transB, K x N otherwise, stride ldqb)
+template <typename TB, typename TS>
+inline void xdnn_quantize(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, const TS *B, int ldb,
+        float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB) {
+    assert(kernels.quantize);
+    xdnn_quantize_from<TB>(kernels.quantize, transB, N, K, B, xdnn_data_type_of<TS>(), ldb, quantization_rate,
+            quantizedB, ldqb, scaleB, zeroB, xdnn_scale_offset(kernels, K, 1), xdnn_zero_offset(kernels, K, 1));
+}
+
+template <typename TB, typename TS>
+inline void xdnn_quantize_packb(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, const TS *B, int ldb,
+        float quantization_rate, TB *packedB, float *scaleB, float *zeroB) {
+    assert(kernels.quantize_packb);
+    kernels.quantize_packb(transB, N, K, B, xdnn_data_type_of<TS>(), ldb, quantization_rate, packedB, scaleB, zeroB);
+}
+
+// Same into column panels (packed_b.h), the panels quantized and packed in parallel
+template <typename TB, typename TS>
+inline XDNN_PACKED_B<TB> xdnn_quantize_packb_panels(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K,
+        const TS *B, int ldb, float quantization_rate, TB *buffer, float *scaleB, float *zeroB,
+        int panel_cols = XDNN_PANEL_COLS) {
+    assert(kernels.quantize_packb);
+    XDNN_PACKED_B<TB> packed;
+    packed.kernels = &kernels;
+    packed.N = N;
+    packed.K = K;
+    packed.panel_cols = panel_cols;
+    packed.panels = (N + panel_cols - 1) / panel_cols;
+    packed.block = {0, 0};
+    packed.panel_stride = xdnn_panel_stride(kernels, K, panel_cols, packed.block);
+    packed.data = buffer;
+    packed.scaleB = scaleB;
+    packed.zeroB = zeroB;
+
+    xdnn_parallel_for(packed.panels, [&](int p) {
+        int n0 = p * panel_cols;
+        int cols = std::min(panel_cols, N - n0);
+        const TS *src = B + (transB ? (size_t)n0 * ldb : (size_t)n0);
+        kernels.quantize_packb(transB, cols, K, src, xdnn_data_type_of<TS>(), ldb, quantization_rate,
+                buffer + p * packed.panel_stride, scaleB + xdnn_scale_offset(kernels, K, n0),
+                zeroB + xdnn_zero_offset(kernels, K, n0));
+    });
+
+    return packed;
+}
+
+// xdnn_<family>_quantize overloads for FP16/BF16 B and xdnn_<family>_quantize_packb,
+// with the table of the running CPU
+#define XDNN_DEFINE_QUANTIZE_PACKB(family, TB) \
+    inline void xdnn_##family##_quantize(bool transB, int N, int K, const XDNN_FP16 *B, int ldb, \
+            float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB) { \
+        xdnn_quantize(xdnn_##family##_kernels(), transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB); \
+    } \
+    inline void xdnn_##family##_quantize(bool transB, int N, int K, const XDNN_BF16 *B, int ldb, \
+            float quantization_rate, TB *quantizedB, int ldqb, float *scaleB, float *zeroB) { \
+        xdnn_quantize(xdnn_##family##_kernels(), transB, N, K, B, ldb, quantization_rate, quantizedB, ldqb, scaleB, zeroB); \
+    } \
+    template <typename TS> \
+    inline void xdnn_##family##_quantize_packb(bool transB, int N, int K, const TS *B, int ldb, \
+            float quantization_rate, TB *packedB, float *scaleB, float *zeroB) { \
+        xdnn_quantize_packb(xdnn_##family##_kernels(), transB, N, K, B, ldb, quantization_rate, packedB, scaleB, zeroB); \
+    }
+
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32s8f32, int8_t)
+XDNN_DEFINE_QUANTIZE_PACKB(hgemm_f32s8f32, int8_t)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32i8f32, int8_t)
+XDNN_DEFINE_QUANTIZE_PACKB(hgemm_f32i8f32, int8_t)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32u4f32, XDNN_UINT4x2)
+XDNN_DEFINE_QUANTIZE_PACKB(hgemm_f32u4f32, XDNN_UINT4x2)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32nf4f32, XDNN_NF4x2)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32e4m3f32, XDNN_FP8_E4M3)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32e5m2f32, XDNN_FP8_E5M2)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32u2f32, XDNN_UINT2x4)
+XDNN_DEFINE_QUANTIZE_PACKB(sgemm_f32u3f32, XDNN_UINT3x8)
+XDNN_DEFINE_QUANTIZE_PACKB(w8a8_sgemm_f32s8f32, int8_t)
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define XDNN_MAX_CPUS 1024
+
+// ================================================================================
+// Thread budget and CPU set of the gemm calls, so several inference instances can
+// share a socket. A context is made current on the calling thread by XDNN_THREAD_SCOPE;
+// inside the scope, the library entry points and the tile schedulers (xdnn_parallel_for)
+// run on a team of 'threads' threads, thread i pinned to cpus[i % ncpus].
+// The OpenMP team of a calling thread persists between parallel regions, so the pinning
+// is only done again when the thread switches to a context with other settings, and
+// undone when the outermost scope of the thread ends.
+// ================================================================================
+class XDNN_THREAD_POOL;
+
+struct XDNN_THREAD_CONTEXT {
+    int threads;
+    int ncpus;              // 0: the threads keep their affinity
+    int cpus[XDNN_MAX_CPUS];
+    XDNN_THREAD_POOL *pool; // tile schedulers run on this pool instead of OpenMP if not null
+};
+
+// threads <= 0 means one thread per cpu in cpus, or omp_get_max_threads() without cpus
+inline XDNN_THREAD_CONTEXT xdnn_thread_context(int threads, const int *cpus = nullptr, int ncpus = 0) {
+    XDNN_THREAD_CONTEXT ctx;
+    ctx.pool = nullptr;
+    ctx.ncpus = cpus ? std::min(ncpus, XDNN_MAX_CPUS) : 0;
+    for (int i = 0; i < ctx.ncpus; ++i) {
+        ctx.cpus[i] = cpus[i];
+    }
+    ctx.threads = threads > 0 ? threads : (ctx.ncpus > 0 ? ctx.ncpus : omp_get_max_threads());
+    return ctx;
+}
+
+// One thread per cpu of mask, e.g. the cores of one instance
+inline XDNN_THREAD_CONTEXT xdnn_thread_context(const cpu_set_t &mask, int threads = 0) {
+    int cpus[XDNN_MAX_CPUS];
+    int ncpus = 0;
+    for (int c = 0; c < CPU_SETSIZE && ncpus < XDNN_MAX_CPUS; ++c) {
+        if (CPU_ISSET(c, &mask)) cpus[ncpus++] = c;
+    }
+    return xdnn_thread_context(threads, cpus, ncpus);
+}
+
+inline bool xdnn_same_thread_context(const XDNN_THREAD_CONTEXT &a, const XDNN_THREAD_CONTEXT &b) {
+    return a.threads == b.threads && a.ncpus == b.ncpus && a.pool == b.pool && memcmp(a.cpus, b.cpus, a.ncpus * sizeof(int)) == 0;
+}
+
+// The context current on the calling thread, nullptr outside of any XDNN_THREAD_SCOPE
+inline const XDNN_THREAD_CONTEXT *&xdnn_current_thread_context() {
+    static thread_local const XDNN_THREAD_CONTEXT *current = nullptr;
+    return current;
+}
+
+inline bool xdnn_pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Affinity of the calling thread before its first pinning by a scope
+struct XDNN_SAVED_AFFINITY {
+    bool saved;
+    cpu_set_t mask;
+};
+
+inline XDNN_SAVED_AFFINITY &xdnn_saved_affinity() {
+    static thread_local XDNN_SAVED_AFFINITY saved = {false};
+    return saved;
+}
+
+// Pin the OpenMP team of the calling thread to the cpus of ctx, each thread saving its
+// affinity the first time
+inline void xdnn_pin_omp_team(const XDNN_THREAD_CONTEXT &ctx) {
+    if (ctx.ncpus == 0) return;
+
+    #pragma omp parallel num_threads(ctx.threads)
+    {
+        XDNN_SAVED_AFFINITY &saved = xdnn_saved_affinity();
+        if (!saved.saved) {
+            saved.saved = pthread_getaffinity_np(pthread_self(), sizeof(saved.mask), &saved.mask) == 0;
+        }
+        int t = omp_get_thread_num();
+        xdnn_pin_current_thread(ctx.cpus[t % ctx.ncpus]);
+    }
+}
+
+// Give a team of 'threads' threads back the affinity they had before xdnn_pin_omp_team
+inline void xdnn_unpin_omp_team(int threads) {
+    #pragma omp parallel num_threads(threads)
+    {
+        XDNN_SAVED_AFFINITY &saved = xdnn_saved_affinity();
+        if (saved.saved) {
+            pthread_setaffinity_np(pthread_self(), sizeof(saved.mask), &saved.mask);
+            saved.saved = false;
+        }
+    }
+}
+
+// Make a copy of ctx current on the calling thread for the lifetime of the scope:
+//   XDNN_THREAD_SCOPE scope(ctx);
+//   xdnn_sgemm_compute(...);
+// Scopes nest; the previous context and OpenMP thread count come back on exit, and the
+// team gets its affinity from before the first pinning back when the outermost scope ends.
+class XDNN_THREAD_SCOPE {
+public:
+    explicit XDNN_THREAD_SCOPE(const XDNN_THREAD_CONTEXT &ctx) : ctx_(ctx), prev_(xdnn_current_thread_context()),
+            prev_threads_(omp_get_max_threads()) {
+        activate(ctx_);
+    }
+
+    ~XDNN_THREAD_SCOPE() {
+        xdnn_current_thread_context() = prev_;
+        omp_set_num_threads(prev_threads_);
+        if (prev_) {
+            activate(*prev_);
+        } else if (pinned().ncpus > 0) {
+            xdnn_unpin_omp_team(pinned_team());
+            pinned() = {0, 0, {}, nullptr};
+            pinned_team() = 0;
+        }
+    }
+
+    XDNN_THREAD_SCOPE(const XDNN_THREAD_SCOPE &) = delete;
+    XDNN_THREAD_SCOPE &operator=(const XDNN_THREAD_SCOPE &) = delete;
+
+private:
+    // Settings the team of this thread was last pinned with
+    static XDNN_THREAD_CONTEXT &pinned() {
+        static thread_local XDNN_THREAD_CONTEXT ctx = {0, 0, {}, nullptr};
+        return ctx;
+    }
+
+    // Largest team pinned since the outermost scope began
+    static int &pinned_team() {
+        static thread_local int threads = 0;
+        return threads;
+    }
+
+    static void activate(const XDNN_THREAD_CONTEXT &ctx) {
+        xdnn_current_thread_context() = &ctx;
+        omp_set_num_threads(ctx.threads);
+        if (ctx.ncpus > 0 && !xdnn_same_thread_context(ctx, pinned())) {
+            xdnn_pin_omp_team(ctx);
+            pinned() = ctx;
+            pinned_team() = std::max(pinned_team(), ctx.threads);
+        }
+    }
+
+    XDNN_THREAD_CONTEXT ctx_;
+    const XDNN_THREAD_CONTEXT *prev_;
+    int prev_threads_;
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <immintrin.h>
+#include <omp.h>
+
+#include "thread_context.h"
+
+#define XDNN_POOL_SPIN_US 200 // idle workers spin this long before they sleep
+
+// ================================================================================
+// Library owned worker pool, an alternative to the OpenMP team for the tile schedulers
+// (xdnn_parallel_for) when back-to-back small gemms make fork/join latency visible.
+// The workers stay alive and pinned, spin for spin_us after their last job and then
+// sleep. A job is published and its tasks are claimed with one 64-bit atomic:
+//   | epoch (20 bits) | tasks (22 bits) | next task (22 bits) |
+// so a worker lagging behind can never claim a task of another job.
+// The calling thread runs tasks too; kernels called from a task are single threaded.
+// If tasks throw, the other tasks of the job are skipped and run() rethrows the first
+// exception on the calling thread once the workers are done with the job.
+// ================================================================================
+class XDNN_THREAD_POOL {
+public:
+    // threads - 1 workers pinned to the cpus of ctx, the calling thread is the last one
+    explicit XDNN_THREAD_POOL(const XDNN_THREAD_CONTEXT &ctx, int spin_us = XDNN_POOL_SPIN_US)
+            : threads_(std::max(1, ctx.threads)), spin_us_(spin_us) {
+        for (int id = 1; id < threads_; ++id) {
+            int cpu = ctx.ncpus > 0 ? ctx.cpus[id % ctx.ncpus] : -1;
+            workers_.emplace_back([this, id, cpu] { worker_main(id, cpu); });
+        }
+    }
+
+    ~XDNN_THREAD_POOL() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread &w : workers_) w.join();
+    }
+
+    XDNN_THREAD_POOL(const XDNN_THREAD_POOL &) = delete;
+    XDNN_THREAD_POOL &operator=(const XDNN_THREAD_POOL &) = delete;
+
+    int threads() const {
+        return threads_;
+    }
+
+    // Jobs run so far, one per run() of up to XDNN_POOL_MAX_TASKS tasks
+    uint64_t jobs() const {
+        return jobs_.load(std::memory_order_relaxed);
+    }
+
+    // True on the workers, and on the calling thread while it runs tasks
+    static bool in_pool() {
+        return in_pool_flag();
+    }
+
+    // Run f(task) for task in [0, tasks) on the pool, one dispatcher at a time
+    template <typename F>
+    void run(int tasks, F &&f) {
+        for (int t0 = 0; t0 < tasks; t0 += XDNN_POOL_MAX_TASKS) {
+            int n = std::min(tasks - t0, (int)XDNN_POOL_MAX_TASKS);
+            auto chunk = [&f, t0](int t) { f(t0 + t); };
+            run_job(n, [](void *arg, int t) { (*(decltype(chunk) *)arg)(t); }, &chunk);
+        }
+    }
+
+private:
+    static constexpr uint64_t XDNN_POOL_MAX_TASKS = (1ull << 22) - 1;
+
+    static uint64_t epoch_of(uint64_t s) { return s >> 44; }
+    static uint64_t tasks_of(uint64_t s) { return (s >> 22) & XDNN_POOL_MAX_TASKS; }
+    static uint64_t next_of(uint64_t s) { return s & XDNN_POOL_MAX_TASKS; }
+
+    static bool &in_pool_flag() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    // The calling thread in pool mode (single threaded OpenMP) while it runs tasks
+    struct caller_scope {
+        int omp_threads = omp_get_max_threads();
+
+        caller_scope() {
+            omp_set_num_threads(1);
+            in_pool_flag() = true;
+        }
+
+        ~caller_scope() {
+            in_pool_flag() = false;
+            omp_set_num_threads(omp_threads);
+        }
+    };
+
+    void run_job(int tasks, void (*fn)(void *, int), void *arg) {
+        std::lock_guard<std::mutex> dispatch(dispatch_);
+        jobs_.fetch_add(1, std::memory_order_relaxed);
+
+        fn_ = fn;
+        arg_ = arg;
+        error_ = nullptr;
+        failed_.store(false, std::memory_order_relaxed);
+        done_.store(0, std::memory_order_relaxed);
+        uint64_t epoch = (epoch_of(state_.load(std::memory_order_relaxed)) + 1) & ((1ull << 20) - 1);
+        state_.store((epoch << 44) | ((uint64_t)tasks << 22), std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            wake_.notify_all();
+        }
+
+        // Tasks run single threaded on the calling thread as well
+        {
+            caller_scope scope;
+            work(epoch);
+        }
+
+        for (int spins = 0; done_.load(std::memory_order_acquire) < tasks; ++spins) {
+            if (spins < 4096) _mm_pause();
+            else std::this_thread::yield();
+        }
+        if (failed_.load(std::memory_order_acquire)) std::rethrow_exception(error_);
+    }
+
+    // Claim and run the tasks of job 'epoch' until none is left
+    void work(uint64_t epoch) {
+        uint64_t s = state_.load(std::memory_order_acquire);
+        while (epoch_of(s) == epoch && next_of(s) < tasks_of(s)) {
+            if (state_.compare_exchange_weak(s, s + 1, std::memory_order_acq_rel)) {
+                // The job cannot complete while this task is claimed, so fn_/arg_ are still its own.
+                // A task that throws never leaves the pool: the first exception is kept for run().
+                if (!failed_.load(std::memory_order_relaxed)) {
+                    try {
+                        fn_(arg_, (int)next_of(s));
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex_);
+                        if (!failed_.load(std::memory_order_relaxed)) {
+                            error_ = std::current_exception();
+                            failed_.store(true, std::memory_order_release);
+                        }
+                    }
+                }
+                done_.fetch_add(1, std::memory_order_release);
+                s = state_.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    void worker_main(int id, int cpu) {
+        if (cpu >= 0) xdnn_pin_current_thread(cpu);
+        omp_set_num_threads(1);
+        in_pool_flag() = true;
+
+        uint64_t seen = epoch_of(state_.load(std::memory_order_acquire));
+        auto idle = std::chrono::steady_clock::now();
+        for (int spins = 0; ; ++spins) {
+            uint64_t epoch = epoch_of(state_.load(std::memory_order_acquire));
+            if (epoch != seen) {
+                seen = epoch;
+                work(epoch);
+                idle = std::chrono::steady_clock::now();
+                spins = 0;
+                continue;
+            }
+
+            _mm_pause();
+            if ((spins & 63) != 0) continue;
+            if (std::chrono::steady_clock::now() - idle < std::chrono::microseconds(spin_us_)) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            wake_.wait(lock, [&] { return stop_ || epoch_of(state_.load(std::memory_order_seq_cst)) != seen; });
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            if (stop_) return;
+            idle = std::chrono::steady_clock::now();
+        }
+    }
+
+    int threads_;
+    int spin_us_;
+    std::vector<std::thread> workers_;
+
+    std::mutex dispatch_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> sleepers_{0};
+    std::atomic<uint64_t> jobs_{0};
+    bool stop_ = false;
+
+    void (*fn_)(void *, int) = nullptr;
+    void *arg_ = nullptr;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+    alignas(64) std::atomic<uint64_t> state_{0};
+    alignas(64) std::atomic<int> done_{0};
+};
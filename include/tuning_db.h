@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <omp.h>
+
+#define XDNN_TUNING_DB_HEADER "# xdnn tuning db v1"
+
+// Block sizes of the families packing B in blocks (xdnn_bgemm_f32bf16f32_packb,
+// xdnn_hgemm_f32f16f32_packb_block)
+struct XDNN_PACKB_BLOCK {
+    int block_rows;
+    int block_cols;
+};
+
+// Fastest blocking measured for a family and shape on this machine, for M in [m_lo, m_hi]
+struct XDNN_TUNING_ENTRY {
+    char family[32];
+    int N;
+    int K;
+    int threads;
+    int m_lo;
+    int m_hi;
+    XDNN_PACKB_BLOCK block;
+    float us; // time of the winner, summed over the M of the range it was measured at
+};
+
+// ================================================================================
+// Tuning results, stored as a text file, one entry per line:
+//   family N K threads m_lo m_hi block_rows block_cols us
+// The process wide db (xdnn_tuning_db) is loaded from env XDNN_TUNING_DB on first use,
+// and is what the packb entry points of the kernel tables look up. Lookups are thread safe;
+// results are added by xdnn_tune_packb_block (packb_tuner.h) or by hand.
+// ================================================================================
+class XDNN_TUNING_DB {
+public:
+    // Entries of path are added to (or replace) the ones in the db; false if path can't be read
+    bool load(const char *path) {
+        FILE *fp = fopen(path, "r");
+        if (fp == nullptr) return false;
+
+        char line[256];
+        bool ok = fgets(line, sizeof(line), fp) && strncmp(line, XDNN_TUNING_DB_HEADER, strlen(XDNN_TUNING_DB_HEADER)) == 0;
+        while (ok && fgets(line, sizeof(line), fp)) {
+            XDNN_TUNING_ENTRY e;
+            if (line[0] == '#' || line[0] == '\n') continue;
+            if (sscanf(line, "%31s %d %d %d %d %d %d %d %f", e.family, &e.N, &e.K, &e.threads, &e.m_lo, &e.m_hi,
+                        &e.block.block_rows, &e.block.block_cols, &e.us) == 9) {
+                add(e);
+            }
+        }
+        fclose(fp);
+        return ok;
+    }
+
+    bool save(const char *path) const {
+        FILE *fp = fopen(path, "w");
+        if (fp == nullptr) return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        fprintf(fp, "%s\n", XDNN_TUNING_DB_HEADER);
+        for (const XDNN_TUNING_ENTRY &e : entries_) {
+            fprintf(fp, "%s %d %d %d %d %d %d %d %.3f\n", e.family, e.N, e.K, e.threads, e.m_lo, e.m_hi,
+                    e.block.block_rows, e.block.block_cols, e.us);
+        }
+        return fclose(fp) == 0;
+    }
+
+    // Replaces the entry of the same family, shape, threads and M range
+    void add(const XDNN_TUNING_ENTRY &e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (XDNN_TUNING_ENTRY &old : entries_) {
+            if (same_key(old, e) && old.m_lo == e.m_lo && old.m_hi == e.m_hi) {
+                old = e;
+                return;
+            }
+        }
+        entries_.push_back(e);
+    }
+
+    // Block of the entry whose range holds M (M < 0: of any range, the widest one), or fallback
+    XDNN_PACKB_BLOCK find(const char *family, int N, int K, int threads, int M, XDNN_PACKB_BLOCK fallback) const {
+        XDNN_TUNING_ENTRY key;
+        snprintf(key.family, sizeof(key.family), "%s", family);
+        key.N = N;
+        key.K = K;
+        key.threads = threads;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const XDNN_TUNING_ENTRY *best = nullptr;
+        for (const XDNN_TUNING_ENTRY &e : entries_) {
+            if (!same_key(e, key)) continue;
+            if (M >= 0 ? (e.m_lo <= M && M <= e.m_hi) : (best == nullptr || e.m_hi - e.m_lo > best->m_hi - best->m_lo)) {
+                best = &e;
+                if (M >= 0) break;
+            }
+        }
+        return best ? best->block : fallback;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    static bool same_key(const XDNN_TUNING_ENTRY &a, const XDNN_TUNING_ENTRY &b) {
+        return strcmp(a.family, b.family) == 0 && a.N == b.N && a.K == b.K && a.threads == b.threads;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<XDNN_TUNING_ENTRY> entries_;
+};
+
+inline XDNN_TUNING_DB &xdnn_tuning_db() {
+    static XDNN_TUNING_DB *db = [] {
+        XDNN_TUNING_DB *d = new XDNN_TUNING_DB();
+        const char *path = getenv("XDNN_TUNING_DB");
+        if (path && *path) d->load(path);
+        return d;
+    }();
+    return *db;
+}
+
+// Block to pack B of family with, for a team of 'threads' threads: the tuned one if any, else fallback.
+// M < 0 when the weight serves every M.
+inline XDNN_PACKB_BLOCK xdnn_packb_block(const char *family, int N, int K, XDNN_PACKB_BLOCK fallback, int threads,
+        int M = -1) {
+    return xdnn_tuning_db().find(family, N, K, threads, M, fallback);
+}
+
+// Team size a weight is packed for when the caller doesn't give one (xdnn_packb_panels):
+// the OpenMP team of the process when first asked, not of the thread that packs, so that
+// sizing and packing a weight agree on pool workers and inside thread scopes. Assign it
+// before packing to tune the weights for another team.
+inline int &xdnn_packb_threads() {
+    static int threads = omp_get_max_threads();
+    return threads;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "data_types/data_types.h"
+#include "cpu_isa.h"
 #include "intrinsic_ext.h"
 #include "transpose.h"
 #include "softmax.h"
@@ -24,3 +25,23 @@
 #include "bgemm_f32bf16f32.h"
 
 #include "amx_sgemm_bf16bf16bf16.h"
+
+#include "post_ops.h"
+#include "gemm_kernels.h"
+#include "packed_b.h"
+#include "packb_size.h"
+#include "packb_stream.h"
+#include "quantize_packb.h"
+#include "gemm_plan.h"
+#include "tuning_db.h"
+#include "packb_tuner.h"
+#include "packed_file.h"
+#include "gemm_grouped.h"
+#include "gemm_batched.h"
+#include "gemm_swiglu.h"
+#include "gemm_qkv.h"
+#include "gemm_w8a8.h"
+#include "thread_context.h"
+#include "thread_pool.h"
+#include "prefetch.h"
+#include "gemm_async.h"
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <type_traits>
+#include <iostream>
+
+#include "gemm_batched.h"
+#include "../utils/utils.h"
+
+// Attention scores of all heads: Q (seq x heads * headSize) * K^T -> heads x seq x seq
+void benchmark_xdnn_amx_sgemm_bf16bf16bf16_batch_strided(int heads, int seq, int headSize, int loop = 5) {
+    const int M = seq, N = seq, K = headSize;
+    const int lda = heads * headSize;
+    const int ldb = heads * headSize;
+    const int ldc = seq;
+    const float alpha = 1.0f / std::sqrt(headSize);
+
+    ALLOC(XDNN_BF16, Q, seq * lda);
+    ALLOC(XDNN_BF16, Kc, seq * ldb);
+    ALLOC(XDNN_BF16, C, heads * seq * ldc);
+
+    test_utils::init(Q.get(), seq * lda, std::remove_pointer<decltype(Q.get())>::type(1.1));
+    test_utils::init(Kc.get(), seq * ldb, std::remove_pointer<decltype(Kc.get())>::type(1.1));
+
+    // Per head loop, one parallel region per head
+    xdnn_amx_sgemm_bf16bf16bf16(false, true, M, N, K, alpha, Q.get(), lda, Kc.get(), ldb, 0.0f, C.get(), ldc);
+    Timer t0;
+    for (int i = 0; i < loop; ++i) {
+        for (int h = 0; h < heads; ++h) {
+            xdnn_amx_sgemm_bf16bf16bf16(false, true, M, N, K, alpha, Q.get() + h * headSize, lda,
+                    Kc.get() + h * headSize, ldb, 0.0f, C.get() + h * seq * ldc, ldc);
+        }
+    }
+    float loop_latency = t0.getTime() / loop;
+
+    xdnn_amx_sgemm_bf16bf16bf16_batch_strided(false, true, M, N, K, alpha, Q.get(), lda, headSize,
+            Kc.get(), ldb, headSize, 0.0f, C.get(), ldc, (size_t)seq * ldc, heads);
+    Timer t1;
+    for (int i = 0; i < loop; ++i) {
+        xdnn_amx_sgemm_bf16bf16bf16_batch_strided(false, true, M, N, K, alpha, Q.get(), lda, headSize,
+                Kc.get(), ldb, headSize, 0.0f, C.get(), ldc, (size_t)seq * ldc, heads);
+    }
+    float batch_latency = t1.getTime() / loop;
+
+    float gflops = 2LL * heads * M * N * K / batch_latency / 1000000;
+    printf("xdnn_amx_sgemm_bf16bf16bf16_batch_strided, heads: %d, seq: %d, headSize: %d, latency: %f ms (per head loop: %f ms), perf: %.2f gflops\n",
+            heads, seq, headSize, batch_latency, loop_latency, gflops);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 5) {
+        int heads = std::stoi(argv[1]);
+        int seq = std::stoi(argv[2]);
+        int headSize = std::stoi(argv[3]);
+        int loop = std::stoi(argv[4]);
+
+        benchmark_xdnn_amx_sgemm_bf16bf16bf16_batch_strided(heads, seq, headSize, loop);
+
+        return 0;
+    }
+
+    int heads[] = {32, 64};
+    int seqs[] = {128, 512, 1024, 2048};
+    for (int h : heads) {
+        for (int s : seqs) {
+            benchmark_xdnn_amx_sgemm_bf16bf16bf16_batch_strided(h, s, 128);
+        }
+    }
+
+    return 0;
+}
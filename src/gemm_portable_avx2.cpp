@@ -0,0 +1,32 @@
+// Copyright (C) 2023-2024 Intel Corporation
+// The AVX2 tier of the portable kernels, built with -march=x86-64-v3 (see CMakeLists.txt) so that
+// no AVX-512 instruction of the build's own -march reaches the tiles run on AVX2 nodes.
+#define XDNN_PORTABLE_AVX2_TU
+#include "gemm_portable.h"
+#include "gemm_w8a8.h"
+
+#define XDNN_INSTANTIATE_AVX2_TILES(Fmt, Group) \
+    template void xdnn_plain_gemm_tile_avx2<Fmt, Group>(bool, int, int, float, const float *, int, \
+            const typename Fmt::type *, const float *, const float *, float, float *, int, const XDNN_POST_OPS *, \
+            int, int, int, int, int, int); \
+    template void xdnn_plain_gemv_tile_avx2<Fmt, Group>(bool, int, int, float, const float *, int, \
+            const typename Fmt::type *, const float *, const float *, float, float *, int, const XDNN_POST_OPS *, \
+            int, int, int, int, int, int);
+
+#define XDNN_INSTANTIATE_AVX2_GROUP_TILES(Fmt) \
+    XDNN_INSTANTIATE_AVX2_TILES(Fmt, 0) \
+    XDNN_INSTANTIATE_AVX2_TILES(Fmt, 32) \
+    XDNN_INSTANTIATE_AVX2_TILES(Fmt, 64) \
+    XDNN_INSTANTIATE_AVX2_TILES(Fmt, 128)
+
+XDNN_INSTANTIATE_AVX2_TILES(xdnn_fmt_f32, 0)
+XDNN_INSTANTIATE_AVX2_TILES(xdnn_fmt_f16, 0)
+XDNN_INSTANTIATE_AVX2_TILES(xdnn_fmt_bf16, 0)
+XDNN_INSTANTIATE_AVX2_TILES(xdnn_fmt_e4m3, 0)
+XDNN_INSTANTIATE_AVX2_TILES(xdnn_fmt_e5m2, 0)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_s8)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_u4)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_u2)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_u3)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_nf4)
+XDNN_INSTANTIATE_AVX2_GROUP_TILES(xdnn_fmt_cb4)
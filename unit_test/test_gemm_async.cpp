@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <omp.h>
+
+#include "gemm_async.h"
+#include "quantize_packb.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+// C of an async call is, bit for bit, the C of xdnn_gemm_compute; the post op chain is
+// copied at submission, so it may go out of scope before the wait
+template <typename TB>
+void test_xdnn_gemm_async(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K, float beta) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), C((size_t)M * N), refC;
+    std::vector<float> scaleB(xdnn_scale_count(kernels, N, K)), zeroB(xdnn_zero_count(kernels, N, K));
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(C.data(), C.size(), -1.00f, 1.00f);
+    refC = C;
+
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+
+    XDNN_ASYNC_HANDLE h;
+    {
+        XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_silu()});
+        xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+                beta, refC.data(), N, &ops);
+        h = xdnn_gemm_compute_async(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(),
+                zeroB.data(), beta, C.data(), N, &ops);
+        ops = xdnn_post_ops({xdnn_post_op_relu()});
+    }
+    xdnn_wait(h);
+
+    printf("\t%-20s %-6s beta=%.1f", kernels.name, xdnn_cpu_isa_name(kernels.isa), beta);
+    if (!xdnn_done(h) || memcmp(C.data(), refC.data(), C.size() * sizeof(float)) != 0) {
+        printf("\tFailed: M=%5d, N=%5d, K=%5d, differs from the synchronous call\n", M, N, K);
+    } else {
+        printf("\tPassed: M=%5d, N=%5d, K=%5d\n", M, N, K);
+    }
+}
+
+// Calls run in submission order: a chain of layers, each one reading the C of the one
+// before, submitted back to back and waited for once, with and without a pool
+void test_xdnn_gemm_async_chain(bool with_pool) {
+    const int layers = 8, N = 256;
+    const auto &kernels = xdnn_sgemm_kernels();
+    std::vector<float> B((size_t)N * N), packedB(kernels.packb_size(N, N));
+    std::vector<std::vector<float>> x(layers + 1, std::vector<float>(N)), refx = x;
+    test_utils::init(B.data(), B.size(), -0.1f, 0.1f);
+    test_utils::init(x[0].data(), N, -1.00f, 1.00f);
+    refx[0] = x[0];
+    kernels.packb(false, N, N, B.data(), N, packedB.data());
+
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(4);
+    std::unique_ptr<XDNN_THREAD_POOL> pool;
+    if (with_pool) {
+        pool.reset(new XDNN_THREAD_POOL(ctx));
+        ctx.pool = pool.get();
+    }
+    XDNN_THREAD_SCOPE scope(ctx);
+
+    for (int l = 0; l < layers; ++l) {
+        xdnn_gemm_compute(kernels, false, 1, N, N, 1.0f, refx[l].data(), N, packedB.data(), nullptr, nullptr,
+                0.0f, refx[l + 1].data(), N, nullptr);
+    }
+    XDNN_ASYNC_HANDLE last;
+    for (int l = 0; l < layers; ++l) {
+        last = xdnn_sgemm_compute_async(false, 1, N, N, 1.0f, x[l].data(), N, packedB.data(), nullptr, nullptr,
+                0.0f, x[l + 1].data(), N);
+    }
+    xdnn_wait(last);
+
+    bool ok = true;
+    for (int l = 1; l <= layers; ++l) ok &= memcmp(x[l].data(), refx[l].data(), N * sizeof(float)) == 0;
+    printf("\t%s: %d layers in order%s\n", ok ? "Passed" : "Failed", layers, with_pool ? " on a pool" : "");
+}
+
+// A call runs with the thread settings of the submitting thread, and rethrows at the wait
+void test_xdnn_async_queue() {
+    XDNN_ASYNC_QUEUE queue;
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(3);
+    char next[64];
+    int threads = 0;
+    const void *hint = nullptr;
+    const XDNN_THREAD_CONTEXT *seen = nullptr;
+
+    XDNN_ASYNC_HANDLE h;
+    {
+        XDNN_THREAD_SCOPE scope(ctx);
+        XDNN_PREFETCH_SCOPE prefetch(next, sizeof(next));
+        h = queue.submit([&] {
+            threads = omp_get_max_threads();
+            hint = xdnn_current_prefetch_hint() ? xdnn_current_prefetch_hint()->ptr : nullptr;
+            seen = xdnn_current_thread_context();
+        });
+    }
+    xdnn_wait(h);
+    bool ok = threads == 3 && hint == next && seen != nullptr && seen != &ctx;
+
+    XDNN_ASYNC_HANDLE bad = queue.submit([] { throw std::runtime_error("async"); });
+    try {
+        xdnn_wait(bad);
+        ok = false;
+    } catch (const std::runtime_error &) {
+    }
+    ok &= xdnn_done(bad) && xdnn_done(XDNN_ASYNC_HANDLE());
+
+    printf("\t%s: XDNN_ASYNC_QUEUE\n", ok ? "Passed" : "Failed");
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test async gemm:\n");
+    test_xdnn_async_queue();
+    test_xdnn_gemm_async_chain(false);
+    test_xdnn_gemm_async_chain(true);
+
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        XDNN_CPU_ISA tier = (XDNN_CPU_ISA)isa;
+        test_xdnn_gemm_async(xdnn_sgemm_kernels(tier), 128, 300, 200, 0.0f);
+        test_xdnn_gemm_async(xdnn_hgemm_f32f16f32_kernels(tier), 1, 700, 500, 0.5f);
+        test_xdnn_gemm_async(xdnn_sgemm_f32u4f32_group_kernels(64, tier), 70, 200, 320, 0.0f);
+        test_xdnn_gemm_async(xdnn_w8a8_sgemm_f32s8f32_kernels(tier), 100, 300, 256, 0.0f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "gemm_batched.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.03f
+
+template <typename T>
+using batch_strided_fn = void (*)(bool transA, bool transB, int M, int N, int K,
+        float alpha, const T *A, int lda, size_t strideA, const T *B, int ldb, size_t strideB,
+        float beta, T *C, int ldc, size_t strideC, int batch);
+
+// Attention scores: Q (seq x heads * headSize) * K^T (keys x kvHeads * headSize) -> heads x seq x keys
+template <typename T>
+void test_batch_strided_scores(batch_strided_fn<T> fn, int heads, int kvHeads, int seq, int keys, int headSize) {
+    int lda = heads * headSize;
+    int ldb = kvHeads * headSize;
+    int ldc = keys;
+    int group = heads / kvHeads;
+    float alpha = 1.0f / sqrtf(headSize);
+
+    ALLOC(T, Q, seq * lda);
+    ALLOC(T, K, keys * ldb);
+    ALLOC(T, C, heads * seq * ldc);
+    ALLOC(float, refC, heads * seq * ldc);
+
+    test_utils::init(Q.get(), seq * lda, -1.00f, 1.00f);
+    test_utils::init(K.get(), keys * ldb, -1.00f, 1.00f);
+
+    for (int h = 0; h < heads; ++h) {
+        test_utils::gemm_ref(false, true, seq, keys, headSize, alpha, Q.get() + h * headSize, lda,
+                K.get() + h / group * headSize, ldb, 0.0f, refC.get() + h * seq * ldc, ldc);
+    }
+
+    if (group == 1) {
+        fn(false, true, seq, keys, headSize, alpha, Q.get(), lda, headSize, K.get(), ldb, headSize,
+                0.0f, C.get(), ldc, (size_t)seq * ldc, heads);
+    } else {
+        // One call per query head of a group, batched over the KV heads
+        for (int g = 0; g < group; ++g) {
+            fn(false, true, seq, keys, headSize, alpha, Q.get() + g * headSize, lda, group * headSize,
+                    K.get(), ldb, headSize, 0.0f, C.get() + g * seq * ldc, ldc, (size_t)group * seq * ldc, kvHeads);
+        }
+    }
+
+    test_utils::validate(heads * seq, keys, headSize, lda, ldb, ldc, refC.get(), C.get(), ACCURACY);
+}
+
+// Attention output: P (heads x seq x keys) * V (keys x heads * headSize) -> seq x heads * headSize
+template <typename T>
+void test_batch_strided_context(batch_strided_fn<T> fn, int heads, int seq, int keys, int headSize) {
+    int lda = keys;
+    int ldb = heads * headSize;
+    int ldc = heads * headSize;
+
+    ALLOC(T, P, heads * seq * lda);
+    ALLOC(T, V, keys * ldb);
+    ALLOC(T, C, seq * ldc);
+    ALLOC(float, refC, seq * ldc);
+
+    test_utils::init(P.get(), heads * seq * lda, 0.00f, 0.10f);
+    test_utils::init(V.get(), keys * ldb, -1.00f, 1.00f);
+    test_utils::init(C.get(), seq * ldc, -1.00f, 1.00f);
+    for (int i = 0; i < seq * ldc; ++i) {
+        refC.get()[i] = C.get()[i];
+    }
+
+    for (int h = 0; h < heads; ++h) {
+        test_utils::gemm_ref(false, false, seq, headSize, keys, 1.0f, P.get() + h * seq * lda, lda,
+                V.get() + h * headSize, ldb, 0.5f, refC.get() + h * headSize, ldc);
+    }
+
+    fn(false, false, seq, headSize, keys, 1.0f, P.get(), lda, (size_t)seq * lda, V.get(), ldb, headSize,
+            0.5f, C.get(), ldc, headSize, heads);
+
+    test_utils::validate(seq, heads * headSize, keys, lda, ldb, ldc, refC.get(), C.get(), ACCURACY);
+}
+
+template <typename T>
+void test_batch_strided(const char *name, batch_strided_fn<T> fn) {
+    // heads, kvHeads, seq, headSize
+    int cases[][4] = {{32, 32, 128, 128}, {32, 32, 17, 128}, {64, 64, 256, 64}, {32, 8, 128, 128}, {4, 4, 2048, 64}, {1, 1, 1, 64}};
+
+    printf("Test %s (scores, %s):\n", name, xdnn_cpu_isa_name(xdnn_cpu_isa()));
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        test_batch_strided_scores<T>(fn, cases[i][0], cases[i][1], cases[i][2], cases[i][2], cases[i][3]);
+    }
+
+    printf("Test %s (context, %s):\n", name, xdnn_cpu_isa_name(xdnn_cpu_isa()));
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        test_batch_strided_context<T>(fn, cases[i][0], cases[i][2], cases[i][2], cases[i][3]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    test_batch_strided<float>("xdnn_sgemm_batch_strided", xdnn_sgemm_batch_strided);
+    test_batch_strided<XDNN_FP16>("xdnn_hgemm_batch_strided", xdnn_hgemm_batch_strided);
+    test_batch_strided<XDNN_BF16>("xdnn_amx_sgemm_bf16bf16bf16_batch_strided", xdnn_amx_sgemm_bf16bf16bf16_batch_strided);
+
+    return 0;
+}
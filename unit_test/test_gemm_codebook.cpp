@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "quantize_packb.h"
+#include "packb_stream.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.05f
+
+// The 16 values of FP4-E2M1
+static const float FP4_E2M1[XDNN_CODEBOOK_SIZE] = {
+    0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 3.0f, 4.0f, 6.0f, -0.0f, -0.5f, -1.0f, -1.5f, -2.0f, -3.0f, -4.0f, -6.0f};
+
+// Codebooks of a table: the given one for every group
+static std::vector<float> codebooks(const XDNN_GEMM_KERNELS<XDNN_NF4x2> &kernels, int N, int K, const float *codebook) {
+    std::vector<float> zeroB(xdnn_zero_count(kernels, N, K));
+    for (size_t i = 0; i < zeroB.size(); ++i) zeroB[i] = codebook[i % XDNN_CODEBOOK_SIZE];
+    return zeroB;
+}
+
+// B (K x N) dequantized from quantizedB (K x N) as codebook[q] * scale
+static std::vector<float> dequantize(int N, int K, int group_size, const XDNN_NF4x2 *quantizedB,
+        const float *scaleB, const float *zeroB) {
+    int groups = xdnn_scale_groups(K, group_size);
+    int rows = group_size > 0 ? group_size : K;
+    std::vector<float> B((size_t)K * N);
+    for (int k = 0; k < K; ++k) {
+        float *b = B.data() + (size_t)k * N;
+        int g = k / rows;
+        xdnn_fmt_cb4::decode(quantizedB + xdnn_elems<XDNN_NF4x2>((size_t)k * N), 0, N, zeroB + XDNN_CODEBOOK_SIZE * g, b);
+        for (int n = 0; n < N; ++n) b[n] *= scaleB[(size_t)n * groups + g];
+    }
+    return B;
+}
+
+// Every quantized value is the nearest entry of the codebook to B / scale
+static bool nearest(int N, int K, int group_size, const float *B, const XDNN_NF4x2 *quantizedB,
+        const float *scaleB, const float *zeroB) {
+    int groups = xdnn_scale_groups(K, group_size);
+    int rows = group_size > 0 ? group_size : K;
+    std::vector<float> b(N);
+    for (int k = 0; k < K; ++k) {
+        int g = k / rows;
+        const float *codebook = zeroB + XDNN_CODEBOOK_SIZE * g;
+        xdnn_fmt_cb4::decode(quantizedB + xdnn_elems<XDNN_NF4x2>((size_t)k * N), 0, N, codebook, b.data());
+        for (int n = 0; n < N; ++n) {
+            float v = B[(size_t)k * N + n] / scaleB[(size_t)n * groups + g];
+            for (int i = 0; i < XDNN_CODEBOOK_SIZE; ++i) {
+                if (std::fabs(codebook[i] - v) < std::fabs(b[n] - v) - 1e-5f) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// quantize + packb and fused quantize_packb, then compute with every epilogue against fp32 A x dequantized B
+void test_xdnn_codebook_compute(const XDNN_GEMM_KERNELS<XDNN_NF4x2> &kernels, const float *codebook, bool transB,
+        int M, int N, int K) {
+    int ldb = transB ? K : N;
+    size_t scales = xdnn_scale_count(kernels, N, K);
+
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), res((size_t)M * N), C0((size_t)M * N);
+    std::vector<XDNN_NF4x2> quantizedB(xdnn_elems<XDNN_NF4x2>((size_t)K * N + 1));
+    std::vector<float> scaleB(scales), refScaleB(scales);
+    std::vector<float> zeroB = codebooks(kernels, N, K, codebook), refZeroB = zeroB;
+    ALLOC(XDNN_NF4x2, packedB, kernels.packb_size(N, K));
+    ALLOC(XDNN_NF4x2, fusedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C0.data(), C0.size(), -1.00f, 1.00f);
+
+    // Reference from K x N quantized values
+    kernels.quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, refScaleB.data(), refZeroB.data());
+    std::vector<float> roundedB = dequantize(N, K, kernels.group_size, quantizedB.data(), refScaleB.data(), refZeroB.data());
+    bool ok = nearest(N, K, kernels.group_size, B.data(), quantizedB.data(), refScaleB.data(), refZeroB.data());
+    ok &= refZeroB == zeroB;
+
+    std::vector<float> transposedB;
+    if (transB) {
+        transposedB.resize(B.size());
+        test_utils::transpose(N, K, B.data(), N, transposedB.data());
+    }
+    const float *src = transB ? transposedB.data() : B.data();
+    kernels.quantize(transB, N, K, src, ldb, 1.0f, quantizedB.data(), ldb, scaleB.data(), zeroB.data());
+    kernels.packb(transB, N, K, quantizedB.data(), ldb, packedB.get());
+    ok &= scaleB == refScaleB;
+    xdnn_quantize_packb(kernels, transB, N, K, src, ldb, 1.0f, fusedB.get(), scaleB.data(), zeroB.data());
+    ok &= scaleB == refScaleB && refZeroB == zeroB;
+    ok &= memcmp(packedB.get(), fusedB.get(), kernels.packb_size(N, K) * sizeof(XDNN_NF4x2)) == 0;
+    if (!ok) {
+        printf("\tFailed: %s, transB=%d, M=%d, N=%d, K=%d, quantized values differ\n", kernels.name, transB, M, N, K);
+        return;
+    }
+
+    float gamma = 2.0f;
+    struct Case {
+        const char *name;
+        XDNN_POST_OPS ops;
+    } cases[] = {
+        {"compute", xdnn_post_ops({})},
+        {"compute_silu", xdnn_post_ops({xdnn_post_op_silu()})},
+        {"compute_gelu", xdnn_post_ops({xdnn_post_op_gelu()})},
+        {"compute_biasadd", xdnn_post_ops({xdnn_post_op_bias(bias.data())})},
+        {"compute_biasadd_relu", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_relu()})},
+        {"compute_residential", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), N)})},
+        {"compute_resext", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), N, gamma)})},
+        {"compute_resmul", xdnn_post_ops({xdnn_post_op_res_mul(res.data(), N)})},
+    };
+
+    for (int c = 0; c < 8; ++c) {
+        std::vector<float> C = C0, refC = C0;
+        test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), K, roundedB.data(), N, 0.5f, refC.data(), N);
+        xdnn_apply_post_ops(&cases[c].ops, 0, 0, M, N, refC.data(), N);
+
+        const XDNN_NF4x2 *p = packedB.get();
+        const float *s = scaleB.data(), *z = zeroB.data();
+        switch (c) {
+            case 0: kernels.compute(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 1: kernels.compute_silu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 2: kernels.compute_gelu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 3: kernels.compute_biasadd(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, bias.data()); break;
+            case 4: kernels.compute_biasadd_relu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, bias.data()); break;
+            case 5:
+                kernels.compute_residential(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N,
+                        bias.data(), res.data(), N);
+                break;
+            case 6:
+                kernels.compute_resext(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N,
+                        bias.data(), gamma, res.data(), N);
+                break;
+            default: kernels.compute_resmul(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, res.data(), N);
+        }
+
+        printf("\t%-24s %-6s %-20s transB=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), cases[c].name, transB);
+        test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+    }
+}
+
+// With XDNN_NORMAL_FLOAT32 as its codebook, the codebook table gives the NF4 values and
+// scales of the NF4 tables, and the same C
+template <int Group>
+void test_xdnn_codebook_nf4(XDNN_CPU_ISA isa, int M, int N, int K) {
+    using Nf4 = xdnn_plain_kernels<xdnn_fmt_nf4, XDNN_ISA_AVX512, Group>;
+    const XDNN_GEMM_KERNELS<XDNN_NF4x2> &kernels = xdnn_sgemm_f32nf4f32_codebook_kernels<Group>(isa);
+    const XDNN_GEMM_KERNELS<XDNN_NF4x2> nf4 = isa >= XDNN_ISA_AVX512
+            ? Nf4::table("nf4") : xdnn_plain_kernels<xdnn_fmt_nf4, XDNN_ISA_AVX2, Group>::table("nf4");
+    size_t scales = xdnn_scale_count(kernels, N, K);
+
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), C((size_t)M * N), refC((size_t)M * N);
+    std::vector<float> scaleB(scales), refScaleB(scales), refZeroB(scales);
+    std::vector<float> zeroB = codebooks(kernels, N, K, XDNN_NORMAL_FLOAT32);
+    ALLOC(XDNN_NF4x2, packedB, kernels.packb_size(N, K));
+    ALLOC(XDNN_NF4x2, refPackedB, nf4.packb_size(N, K));
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+
+    xdnn_quantize_packb(kernels, true, N, K, B.data(), K, 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+    xdnn_quantize_packb(nf4, true, N, K, B.data(), K, 1.0f, refPackedB.get(), refScaleB.data(), refZeroB.data());
+    kernels.compute(false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(), 0.0f, C.data(), N);
+    nf4.compute(false, M, N, K, 1.0f, A.data(), K, refPackedB.get(), refScaleB.data(), refZeroB.data(), 0.0f, refC.data(), N);
+
+    bool ok = memcmp(packedB.get(), refPackedB.get(), kernels.packb_size(N, K) * sizeof(XDNN_NF4x2)) == 0;
+    ok &= scaleB == refScaleB && C == refC;
+    if (ok) {
+        printf("\tPassed: %s %s matches nf4\n", kernels.name, xdnn_cpu_isa_name(isa));
+    } else {
+        printf("\tFailed: %s %s does not match nf4\n", kernels.name, xdnn_cpu_isa_name(isa));
+    }
+}
+
+// Streamed K chunks (transB = false) give the packed B and scales of xdnn_quantize_packb_panels
+// and leave the codebooks as they are
+void test_xdnn_codebook_stream(const XDNN_GEMM_KERNELS<XDNN_NF4x2> &kernels, const float *codebook, int N, int K, int chunk) {
+    size_t scales = xdnn_scale_count(kernels, N, K);
+    size_t size = xdnn_packb_panels_size(kernels, N, K);
+
+    std::vector<float> B((size_t)K * N);
+    std::vector<float> scaleB(scales), refScaleB(scales);
+    std::vector<float> zeroB = codebooks(kernels, N, K, codebook), refZeroB = zeroB;
+    ALLOC(XDNN_NF4x2, packedB, size);
+    ALLOC(XDNN_NF4x2, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(XDNN_NF4x2));
+    memset((void *)refPackedB.get(), 0, size * sizeof(XDNN_NF4x2));
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+
+    xdnn_quantize_packb_panels(kernels, false, N, K, B.data(), N, 1.0f, refPackedB.get(), refScaleB.data(), refZeroB.data());
+
+    XDNN_PACKB_STREAM<XDNN_NF4x2> stream(kernels, false, N, K, packedB.get(), scaleB.data(), zeroB.data());
+    for (int k = 0; k < K; k += chunk) stream.observe(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    for (int k = 0; k < K; k += chunk) stream.push(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    stream.finish();
+
+    bool ok = memcmp(packedB.get(), refPackedB.get(), size * sizeof(XDNN_NF4x2)) == 0;
+    ok &= scaleB == refScaleB && zeroB == refZeroB;
+    if (ok) {
+        printf("\tPassed: %s stream, N=%d, K=%d, chunk=%d\n", kernels.name, N, K, chunk);
+    } else {
+        printf("\tFailed: %s stream, N=%d, K=%d, chunk=%d\n", kernels.name, N, K, chunk);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    float learned[XDNN_CODEBOOK_SIZE];
+    test_utils::init(learned, XDNN_CODEBOOK_SIZE, -1.0f, 1.0f);
+    std::sort(learned, learned + XDNN_CODEBOOK_SIZE);
+
+    printf("Test xdnn_sgemm_f32nf4f32_codebook_kernels:\n");
+    for (const float *codebook : {FP4_E2M1, (const float *)learned}) {
+        for (int group_size : {0, 32, 128}) {
+            for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+                const auto &kernels = xdnn_sgemm_f32nf4f32_codebook_kernels(group_size, (XDNN_CPU_ISA)isa);
+                for (bool transB : {false, true}) {
+                    test_xdnn_codebook_compute(kernels, codebook, transB, 1, 256, 1024);
+                    test_xdnn_codebook_compute(kernels, codebook, transB, 37, 130, 300);
+                }
+            }
+            test_xdnn_codebook_stream(xdnn_sgemm_f32nf4f32_codebook_kernels(group_size), codebook, 300, 200, 50);
+        }
+    }
+
+    printf("Test codebook = XDNN_NORMAL_FLOAT32:\n");
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        test_xdnn_codebook_nf4<0>((XDNN_CPU_ISA)isa, 17, 160, 256);
+        test_xdnn_codebook_nf4<64>((XDNN_CPU_ISA)isa, 17, 160, 256);
+    }
+
+    return 0;
+}
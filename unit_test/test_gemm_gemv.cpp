@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "quantize_packb.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.001f
+
+// C of an M = 1 call (xdnn_plain_gemv_tile) against row 0 of the same call with M = 2
+// (xdnn_plain_gemm_tile), on the same packed B, with beta and a post op chain
+template <typename TB>
+void test_xdnn_gemv(const XDNN_GEMM_KERNELS<TB> &kernels, bool transA, int N, int K, float beta) {
+    const int M = 2;
+    int lda = transA ? M : K;
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), res((size_t)M * N);
+    std::vector<float> C((size_t)M * N), gemvC(N), scaleB(xdnn_scale_count(kernels, N, K));
+    std::vector<float> zeroB(xdnn_zero_count(kernels, N, K));
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -1.00f, 1.00f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C.data(), C.size(), -1.00f, 1.00f);
+    memcpy(gemvC.data(), C.data(), N * sizeof(float));
+
+    if (kernels.codebook) {
+        for (size_t i = 0; i < zeroB.size(); ++i) zeroB[i] = XDNN_NORMAL_FLOAT32[i % XDNN_CODEBOOK_SIZE];
+    }
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_silu(),
+            xdnn_post_op_res_add(res.data(), N)});
+
+    xdnn_gemm_compute(kernels, transA, M, N, K, 1.0f, A.data(), lda, packedB.get(), scaleB.data(), zeroB.data(),
+            beta, C.data(), N, &ops);
+    xdnn_gemm_compute(kernels, transA, 1, N, K, 1.0f, A.data(), lda, packedB.get(), scaleB.data(), zeroB.data(),
+            beta, gemvC.data(), N, &ops);
+
+    printf("\t%-24s %-6s transA=%d beta=%.1f", kernels.name, xdnn_cpu_isa_name(kernels.isa), transA, beta);
+    test_utils::validate(1, N, K, lda, N, N, C.data(), gemvC.data(), ACCURACY);
+}
+
+template <typename TB>
+void test_xdnn_gemv_shapes(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    // Odd widths and depths end tiles, the 4 row steps and groups part way
+    int shapes[][2] = {{1, 1}, {63, 17}, {100, 130}, {257, 64}, {1000, 301}, {4096, 256}};
+    for (auto &s : shapes) test_xdnn_gemv(kernels, false, s[0], s[1], 0.0f);
+    test_xdnn_gemv(kernels, true, 300, 200, 0.0f);
+    test_xdnn_gemv(kernels, false, 300, 200, 0.5f);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test gemv (M = 1):\n");
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        XDNN_CPU_ISA tier = (XDNN_CPU_ISA)isa;
+        test_xdnn_gemv_shapes(xdnn_sgemm_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_hgemm_f32f16f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_bgemm_f32bf16f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32s8f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32u4f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32nf4f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32u4f32_group_kernels(64, tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32nf4f32_codebook_kernels(32, tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32u2f32_kernels(tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32u3f32_group_kernels(128, tier));
+        test_xdnn_gemv_shapes(xdnn_sgemm_f32e4m3f32_kernels(tier));
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "quantize_packb.h"
+#include "packb_stream.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.05f
+
+// B (K x N) dequantized from quantizedB (K x N, N even) with the group scales
+template <typename Fmt>
+std::vector<float> dequantize(int N, int K, int group_size, const typename Fmt::type *quantizedB,
+        const float *scaleB, const float *zeroB) {
+    int groups = xdnn_scale_groups(K, group_size);
+    std::vector<float> B((size_t)K * N);
+    for (int k = 0; k < K; ++k) {
+        float *b = B.data() + (size_t)k * N;
+        Fmt::decode(quantizedB + xdnn_elems<typename Fmt::type>((size_t)k * N), 0, N, b);
+        for (int n = 0; n < N; ++n) {
+            size_t i = (size_t)n * groups + k / group_size;
+            b[n] = b[n] * scaleB[i] + zeroB[i];
+        }
+    }
+    return B;
+}
+
+// Compute with group scales against fp32 A x group dequantized B, with a post op chain
+template <typename Fmt>
+void test_xdnn_group_compute(const XDNN_GEMM_KERNELS<typename Fmt::type> &kernels, bool transB, int M, int N, int K) {
+    using TB = typename Fmt::type;
+    int ldb = transB ? K : N;
+    size_t scales = xdnn_scale_count(kernels, N, K);
+
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), C((size_t)M * N), refC((size_t)M * N);
+    std::vector<TB> quantizedB(xdnn_elems<TB>((size_t)K * N + 1));
+    std::vector<float> scaleB(scales), zeroB(scales), refScaleB(scales), refZeroB(scales);
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+
+    // Reference from K x N quantized values, compute from B packed in one call
+    std::vector<float> transposedB;
+    if (transB) {
+        transposedB.resize(B.size());
+        test_utils::transpose(N, K, B.data(), N, transposedB.data());
+    }
+    kernels.quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, refScaleB.data(), refZeroB.data());
+    std::vector<float> roundedB = dequantize<Fmt>(N, K, kernels.group_size, quantizedB.data(), refScaleB.data(), refZeroB.data());
+    xdnn_quantize_packb(kernels, transB, N, K, transB ? transposedB.data() : B.data(), ldb, 1.0f, packedB.get(),
+            scaleB.data(), zeroB.data());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_gelu()});
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), K, roundedB.data(), N, 0.0f, refC.data(), N);
+    xdnn_apply_post_ops(&ops, 0, 0, M, N, refC.data(), N);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            0.0f, C.data(), N, &ops);
+
+    printf("\t%-24s %-6s transB=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), transB);
+    if (memcmp(scaleB.data(), refScaleB.data(), scales * sizeof(float)) != 0
+            || memcmp(zeroB.data(), refZeroB.data(), scales * sizeof(float)) != 0) {
+        printf("\tFailed: M=%5d, N=%5d, K=%5d, scales differ from _quantize\n", M, N, K);
+        return;
+    }
+    test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+}
+
+// Mean error of dequantized B per group is below the one per column, for a B whose
+// rows have ranges that differ along K
+template <typename Fmt>
+void test_xdnn_group_error(const XDNN_GEMM_KERNELS<typename Fmt::type> &column,
+        const XDNN_GEMM_KERNELS<typename Fmt::type> &grouped, int N, int K) {
+    using TB = typename Fmt::type;
+    std::vector<float> B((size_t)K * N);
+    test_utils::init(B.data(), B.size(), -1.0f, 1.0f);
+    for (int k = 0; k < K; ++k) {
+        float range = 0.01f + 0.99f * (k % 97) / 96.0f;
+        for (int n = 0; n < N; ++n) B[(size_t)k * N + n] *= range;
+    }
+
+    auto error = [&](const XDNN_GEMM_KERNELS<TB> &kernels) {
+        size_t scales = xdnn_scale_count(kernels, N, K);
+        std::vector<TB> quantizedB(xdnn_elems<TB>((size_t)K * N + 1));
+        std::vector<float> scaleB(scales), zeroB(scales);
+        kernels.quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, scaleB.data(), zeroB.data());
+        std::vector<float> roundedB = dequantize<Fmt>(N, K, kernels.group_size > 0 ? kernels.group_size : K,
+                quantizedB.data(), scaleB.data(), zeroB.data());
+        double sum = 0;
+        for (size_t i = 0; i < B.size(); ++i) sum += std::fabs(roundedB[i] - B[i]);
+        return sum / B.size();
+    };
+
+    double e0 = error(column);
+    double e1 = error(grouped);
+    if (e1 < e0) {
+        printf("\tPassed: %s, mean error %.5f (per column %.5f)\n", grouped.name, e1, e0);
+    } else {
+        printf("\tFailed: %s, mean error %.5f not below per column %.5f\n", grouped.name, e1, e0);
+    }
+}
+
+// Streamed K chunks (transB = false) give the packed B and scales of xdnn_quantize_packb,
+// in one pass or with the observe() pass of per column tables
+template <typename Fmt>
+void test_xdnn_group_stream(const XDNN_GEMM_KERNELS<typename Fmt::type> &kernels, int N, int K, int chunk, bool observe) {
+    using TB = typename Fmt::type;
+    size_t scales = xdnn_scale_count(kernels, N, K);
+    size_t size = xdnn_packb_panels_size(kernels, N, K);
+
+    std::vector<float> B((size_t)K * N);
+    std::vector<float> scaleB(scales), zeroB(scales), refScaleB(scales), refZeroB(scales);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(TB));
+    memset((void *)refPackedB.get(), 0, size * sizeof(TB));
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+
+    xdnn_quantize_packb_panels(kernels, false, N, K, B.data(), N, 1.0f, refPackedB.get(), refScaleB.data(), refZeroB.data());
+
+    XDNN_PACKB_STREAM<TB> stream(kernels, false, N, K, packedB.get(), scaleB.data(), zeroB.data());
+    if (observe) {
+        for (int k = 0; k < K; k += chunk) stream.observe(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    }
+    for (int k = 0; k < K; k += chunk) stream.push(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    stream.finish();
+
+    bool ok = memcmp(packedB.get(), refPackedB.get(), size * sizeof(TB)) == 0;
+    ok &= memcmp(scaleB.data(), refScaleB.data(), scales * sizeof(float)) == 0;
+    ok &= memcmp(zeroB.data(), refZeroB.data(), scales * sizeof(float)) == 0;
+    if (ok) {
+        printf("\tPassed: %s, N=%d, K=%d, chunk=%d, observe=%d\n", kernels.name, N, K, chunk, observe);
+    } else {
+        printf("\tFailed: %s, N=%d, K=%d, chunk=%d, observe=%d\n", kernels.name, N, K, chunk, observe);
+    }
+}
+
+template <typename Fmt, typename Kernels>
+void test_xdnn_group_family(Kernels group_kernels) {
+    for (int group_size : {32, 64, 128}) {
+        for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+            const auto &kernels = group_kernels(group_size, (XDNN_CPU_ISA)isa);
+            for (bool transB : {false, true}) {
+                test_xdnn_group_compute<Fmt>(kernels, transB, 1, 256, 4096);
+                test_xdnn_group_compute<Fmt>(kernels, transB, 37, 130, 300);
+            }
+        }
+        test_xdnn_group_stream<Fmt>(group_kernels(group_size, xdnn_cpu_isa()), 300, 200, 50, true);
+        test_xdnn_group_stream<Fmt>(group_kernels(group_size, xdnn_cpu_isa()), 300, 200, 50, false);
+        test_xdnn_group_stream<Fmt>(group_kernels(group_size, xdnn_cpu_isa()), 300, 300, 256, false);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test xdnn_sgemm_f32s8f32_group_kernels:\n");
+    test_xdnn_group_family<xdnn_fmt_s8>([](int g, XDNN_CPU_ISA isa) -> const auto & {
+        return xdnn_sgemm_f32s8f32_group_kernels(g, isa);
+    });
+    printf("Test xdnn_sgemm_f32u4f32_group_kernels:\n");
+    test_xdnn_group_family<xdnn_fmt_u4>([](int g, XDNN_CPU_ISA isa) -> const auto & {
+        return xdnn_sgemm_f32u4f32_group_kernels(g, isa);
+    });
+    printf("Test xdnn_sgemm_f32nf4f32_group_kernels:\n");
+    test_xdnn_group_family<xdnn_fmt_nf4>([](int g, XDNN_CPU_ISA isa) -> const auto & {
+        return xdnn_sgemm_f32nf4f32_group_kernels(g, isa);
+    });
+
+    printf("Test group-wise error:\n");
+    test_xdnn_group_error<xdnn_fmt_s8>(xdnn_sgemm_f32s8f32_kernels(XDNN_ISA_AVX512), xdnn_sgemm_f32s8f32_group_kernels(64), 256, 1024);
+    test_xdnn_group_error<xdnn_fmt_u4>(xdnn_sgemm_f32u4f32_kernels(XDNN_ISA_AVX512), xdnn_sgemm_f32u4f32_group_kernels(64), 256, 1024);
+    test_xdnn_group_error<xdnn_fmt_nf4>(xdnn_sgemm_f32nf4f32_kernels(XDNN_ISA_AVX512), xdnn_sgemm_f32nf4f32_group_kernels(64), 256, 1024);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gemm_grouped.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.01f
+
+struct test_problem {
+    int M, N, K;
+    std::vector<float> A, B, C, refC, bias;
+    std::vector<float> scaleB, zeroB;
+    std::unique_ptr<void, decltype(&free)> packedB{nullptr, &free};
+};
+
+template <typename TB>
+void test_xdnn_gemm_compute_grouped(const XDNN_GEMM_KERNELS<TB> &kernels, int count, const int (*mnk)[3],
+        bool gelu) {
+    std::vector<test_problem> tests(count);
+    std::vector<XDNN_PACKED_B<TB>> packed(count);
+    std::vector<XDNN_GEMM_PROBLEM<TB>> problems(count);
+
+    for (int i = 0; i < count; ++i) {
+        test_problem &t = tests[i];
+        t.M = mnk[i][0];
+        t.N = mnk[i][1];
+        t.K = mnk[i][2];
+        t.A.resize(t.M * t.K);
+        t.B.resize(t.K * t.N);
+        t.C.resize(t.M * t.N);
+        t.refC.resize(t.M * t.N);
+        t.bias.resize(t.N);
+        t.scaleB.resize(t.N);
+        t.zeroB.resize(t.N);
+
+        test_utils::init(t.A.data(), t.M * t.K, -1.00f, 1.00f);
+        test_utils::init(t.B.data(), t.K * t.N, -0.25f, 0.25f);
+        test_utils::init(t.bias.data(), t.N, -1.00f, 1.00f);
+
+        // Convert B into the weight type, B keeps the values the kernels really see
+        ALLOC(TB, convertedB, t.K * t.N);
+        prepare_weight(kernels, false, t.N, t.K, t.B.data(), t.N, 0.99f, convertedB.get(), t.scaleB.data(), t.zeroB.data(),
+                t.B.data());
+
+        t.packedB.reset(aligned_alloc(64, xdnn_packb_panels_size(kernels, t.N, t.K) * sizeof(TB)));
+        packed[i] = xdnn_packb_panels(kernels, false, t.N, t.K, convertedB.get(), t.N,
+                t.scaleB.data(), t.zeroB.data(), (TB *)t.packedB.get());
+
+        XDNN_POST_OPS ops = gelu ? xdnn_post_ops({xdnn_post_op_bias(t.bias.data()), xdnn_post_op_gelu()})
+                                 : xdnn_post_ops({xdnn_post_op_bias(t.bias.data())});
+        test_utils::gemm_ref(false, false, t.M, t.N, t.K, 1.0f, t.A.data(), t.K, t.B.data(), t.N, 0.0f, t.refC.data(), t.N);
+        xdnn_apply_post_ops(&ops, 0, 0, t.M, t.N, t.refC.data(), t.N);
+
+        problems[i] = {false, t.M, 1.0f, t.A.data(), t.K, &packed[i], 0.0f, t.C.data(), t.N, ops};
+    }
+
+    xdnn_gemm_compute_grouped(count, problems.data());
+
+    for (int i = 0; i < count; ++i) {
+        test_problem &t = tests[i];
+        test_utils::validate(t.M, t.N, t.K, t.K, t.N, t.N, t.refC.data(), t.C.data(), ACCURACY);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    // MoE experts: different M against the same shaped weights
+    int experts[][3] = {{1, 1408, 2048}, {7, 1408, 2048}, {0, 1408, 2048}, {33, 1408, 2048}, {2, 1408, 2048}, {16, 1408, 2048}};
+    // Multi-tower: different shapes
+    int towers[][3] = {{4, 768, 768}, {4, 3072, 768}, {64, 128, 128}, {1, 4096, 4096}, {18, 1710, 512}};
+
+    printf("Test xdnn_gemm_compute_grouped (%s):\n", xdnn_sgemm_kernels().name);
+    test_xdnn_gemm_compute_grouped(xdnn_sgemm_kernels(), 6, experts, true);
+    test_xdnn_gemm_compute_grouped(xdnn_sgemm_kernels(), 5, towers, false);
+
+    printf("Test xdnn_gemm_compute_grouped (%s):\n", xdnn_bgemm_f32bf16f32_kernels().name);
+    test_xdnn_gemm_compute_grouped(xdnn_bgemm_f32bf16f32_kernels(), 6, experts, false);
+    test_xdnn_gemm_compute_grouped(xdnn_bgemm_f32bf16f32_kernels(), 5, towers, true);
+
+    printf("Test xdnn_gemm_compute_grouped (%s):\n", xdnn_sgemm_f32s8f32_kernels().name);
+    test_xdnn_gemm_compute_grouped(xdnn_sgemm_f32s8f32_kernels(), 6, experts, false);
+    test_xdnn_gemm_compute_grouped(xdnn_sgemm_f32s8f32_kernels(), 5, towers, true);
+
+    return 0;
+}
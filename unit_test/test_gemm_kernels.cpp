@@ -0,0 +1,158 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+
+#include "gemm_kernels.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.10f
+
+#define POST_OPS_CASES 13
+
+// Post op chains under test, dst receives the output of the CONVERT op
+XDNN_POST_OPS make_post_ops(int index, const float *bias, const float *res, int ldres, void *dst) {
+    switch (index) {
+        // chains of the fixed entry points
+        case 1: return xdnn_post_ops({xdnn_post_op_silu()});
+        case 2: return xdnn_post_ops({xdnn_post_op_gelu()});
+        case 3: return xdnn_post_ops({xdnn_post_op_bias(bias)});
+        case 4: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_relu()});
+        case 5: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres)});
+        case 6: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_res_add(res, ldres, 2.5f)});
+        case 7: return xdnn_post_ops({xdnn_post_op_res_mul(res, ldres)});
+        // chains without one
+        case 8: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_gelu()});
+        case 9: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_silu(), xdnn_post_op_res_mul(res, ldres)});
+        case 10: return xdnn_post_ops({xdnn_post_op_scale(0.5f), xdnn_post_op_bias(bias), xdnn_post_op_clamp(-0.5f, 0.5f)});
+        case 11: return xdnn_post_ops({xdnn_post_op_scale(2.0f, bias), xdnn_post_op_res_add(res, ldres, -1.0f)});
+        case 12: return xdnn_post_ops({xdnn_post_op_bias(bias), xdnn_post_op_relu(),
+                xdnn_post_op_convert(XDNN_DT_BF16, dst, ldres)});
+        default: return xdnn_post_ops({});
+    }
+}
+
+template <typename TB>
+void test_xdnn_gemm_kernels_compute(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K,
+        int post_ops, unsigned int padA = 0, unsigned int padB = 0, unsigned int padC = 0) {
+    int lda = K + padA;
+    int ldb = N + padB;
+    int ldc = N + padC;
+
+    ALLOC(float, A, M * lda);
+    ALLOC(float, B, K * ldb);
+    ALLOC(float, roundedB, K * ldb);
+    ALLOC(TB, convertedB, K * ldb);
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+    ALLOC(float, scaleB, N);
+    ALLOC(float, zeroB, N);
+    ALLOC(float, bias, N);
+    ALLOC(float, res, M * ldc);
+    ALLOC(float, C, M * ldc);
+    ALLOC(float, refC, M * ldc);
+    ALLOC(XDNN_BF16, dst, M * ldc);
+    ALLOC(XDNN_BF16, refDst, M * ldc);
+
+    test_utils::init(A.get(), M * lda, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * ldb, -0.25f, 0.25f);
+    test_utils::init(bias.get(), N, -1.00f, 1.00f);
+    test_utils::init(res.get(), M * ldc, -1.00f, 1.00f);
+    test_utils::init(C.get(), M * ldc, -1.00f, 1.00f);
+    memcpy(refC.get(), C.get(), M * ldc * sizeof(float));
+
+    prepare_weight(kernels, false, N, K, B.get(), ldb, 0.99f, convertedB.get(), scaleB.get(), zeroB.get(), roundedB.get());
+
+    XDNN_POST_OPS ops = make_post_ops(post_ops, bias.get(), res.get(), ldc, dst.get());
+    XDNN_POST_OPS refOps = make_post_ops(post_ops, bias.get(), res.get(), ldc, refDst.get());
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), lda, roundedB.get(), ldb, 0.5f, refC.get(), ldc);
+    xdnn_apply_post_ops(&refOps, 0, 0, M, N, refC.get(), ldc);
+
+    kernels.packb(false, N, K, convertedB.get(), ldb, packedB.get());
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.get(), lda, packedB.get(), scaleB.get(), zeroB.get(),
+            0.5f, C.get(), ldc, &ops);
+
+    test_utils::validate(M, N, K, lda, ldb, ldc, refC.get(), C.get(), ACCURACY);
+    if (ops.count > 0 && ops.ops[ops.count - 1].kind == XDNN_POST_OP_CONVERT) {
+        test_utils::validate(M, N, K, lda, ldb, ldc, refDst.get(), dst.get(), ACCURACY);
+    }
+}
+
+// Check if the transpose result is the same (between the non-transpose and transpose version)
+template <typename TB>
+void test_xdnn_gemm_kernels_packb(const XDNN_GEMM_KERNELS<TB> &kernels, int K, int N) {
+    // 4-bit weights are transposed nibble by nibble
+    bool nibble = std::is_same<TB, XDNN_UINT4x2>::value;
+    int size = nibble ? (K * N + 1) / 2 : K * N;
+
+    ALLOC(TB, B, size);
+    ALLOC(TB, transposedB, size);
+    ALLOC(TB, packedB1, kernels.packb_size(N, K));
+    ALLOC(TB, packedB2, kernels.packb_size(N, K));
+
+    test_utils::init(B.get(), size, 0.0f, 15.0f);
+    if (nibble) {
+        for (int k = 0; k < K; ++k) {
+            for (int n = 0; n < N; ++n) {
+                xdnn_set_u4((XDNN_UINT4x2 *)transposedB.get(), n * K + k, xdnn_get_u4((XDNN_UINT4x2 *)B.get(), k * N + n));
+            }
+        }
+    } else {
+        test_utils::transpose(N, K, B.get(), N, transposedB.get());
+    }
+
+    kernels.packb(false, N, K, B.get(), N, packedB1.get());
+    kernels.packb(true, N, K, transposedB.get(), K, packedB2.get());
+
+    if (memcmp(packedB1.get(), packedB2.get(), kernels.packb_size(N, K) * sizeof(TB)) != 0) {
+        printf("\tFailed: packed matrix different (K=%d, N=%d)\n", K, N);
+        return;
+    }
+    printf("\tPassed: K=%d, N=%d\n", K, N);
+}
+
+template <typename TB>
+void test_xdnn_gemm_kernels(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    printf("Test xdnn_%s_kernels (%s) packb:\n", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+    test_xdnn_gemm_kernels_packb(kernels, 768, 768);
+    test_xdnn_gemm_kernels_packb(kernels, 300, 772);
+
+    printf("Test xdnn_%s_kernels (%s) compute:\n", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+    for (int i = 0; i < POST_OPS_CASES; ++i) {
+        test_xdnn_gemm_kernels_compute(kernels, 1, 4096, 512, i);
+        test_xdnn_gemm_kernels_compute(kernels, 34, 1710, 512, i, 4, 4, 4);
+        test_xdnn_gemm_kernels_compute(kernels, 128, 128, 130, i);
+    }
+
+    // Tables without compute_post_ops fuse the head of the chain through a fixed entry point
+    if (kernels.compute_post_ops) {
+        XDNN_GEMM_KERNELS<TB> fixed = kernels;
+        fixed.compute_post_ops = nullptr;
+
+        printf("Test xdnn_%s_kernels (%s) compute w/ fixed entry points:\n", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+        for (int i = 0; i < POST_OPS_CASES; ++i) {
+            test_xdnn_gemm_kernels_compute(fixed, 1, 4096, 512, i);
+            test_xdnn_gemm_kernels_compute(fixed, 300, 1710, 512, i, 4, 4, 4);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("CPU ISA: %s\n", xdnn_cpu_isa_name(xdnn_cpu_isa()));
+
+    for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+        test_xdnn_gemm_kernels(xdnn_sgemm_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_sgemm_f32f16f32_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_hgemm_f32f16f32_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_bgemm_f32bf16f32_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_sgemm_f32s8f32_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_sgemm_f32u4f32_kernels((XDNN_CPU_ISA)isa));
+        test_xdnn_gemm_kernels(xdnn_sgemm_f32nf4f32_kernels((XDNN_CPU_ISA)isa));
+    }
+
+    return 0;
+}
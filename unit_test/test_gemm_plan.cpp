@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+
+#include "gemm_plan.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.01f
+
+// The plan is made once and executed for several steps, each with a new A and residual
+void test_xdnn_plan_execute(const XDNN_GEMM_KERNELS<float> &kernels, int M, int N, int K, int steps) {
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, bias, N);
+    ALLOC(float, res, M * N);
+    ALLOC(float, res2, M * N);
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(bias.get(), N, -1.00f, 1.00f);
+
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_scale(0.5f), xdnn_post_op_bias(bias.get()),
+            xdnn_post_op_gelu(), xdnn_post_op_res_add(res.get(), N)});
+    XDNN_GEMM_PLAN<float> plan = xdnn_plan_create(packed, false, M, 1.0f, K, 0.0f, N, &ops);
+
+    // Steps alternate between two residuals (only the buffers rebound) and change gamma every other step
+    for (int s = 0; s < steps; ++s) {
+        float *r = s % 2 ? res2.get() : res.get();
+        test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+        test_utils::init(r, M * N, -1.00f, 1.00f);
+        float gamma = 1.0f + s / 2;
+        ops.ops[3] = xdnn_post_op_res_add(r, N, gamma);
+        xdnn_plan_set_post_ops(plan, 1.0f, 0.0f, &ops);
+
+        test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+        xdnn_apply_post_ops(&ops, 0, 0, M, N, refC.get(), N);
+
+        xdnn_plan_execute(plan, A.get(), C.get());
+    }
+
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+}
+
+// Shapes seen again hit the cache, and the cached plans give the uncached results
+void test_xdnn_plan_cache(const XDNN_GEMM_KERNELS<float> &kernels, int N, int K) {
+    const int shapes[] = {1, 7, 1, 64, 7, 1};
+    ALLOC(float, A, 64 * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, bias, N);
+    ALLOC(float, C, 64 * N);
+    ALLOC(float, refC, 64 * N);
+
+    test_utils::init(A.get(), 64 * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(bias.get(), N, -1.00f, 1.00f);
+
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.get()), xdnn_post_op_silu()});
+    XDNN_PLAN_CACHE<float> cache;
+
+    for (int M : shapes) {
+        xdnn_packed_b_compute(packed, false, M, 1.0f, A.get(), K, 0.0f, refC.get(), N, &ops);
+        xdnn_plan_execute(cache.get(packed, false, M, 1.0f, K, 0.0f, N, &ops), A.get(), C.get());
+        test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+    }
+
+    if (cache.size() != 3) {
+        printf("\tFailed: %zu plans cached for 3 shapes\n", cache.size());
+    }
+}
+
+// A cache of capacity plans drops the least recently used one for a new shape
+void test_xdnn_plan_cache_capacity(const XDNN_GEMM_KERNELS<float> &kernels, int N, int K) {
+    const int shapes[] = {1, 7, 1, 64, 7, 64, 1};
+    ALLOC(float, A, 64 * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, C, 64 * N);
+    ALLOC(float, refC, 64 * N);
+
+    test_utils::init(A.get(), 64 * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    XDNN_PLAN_CACHE<float> cache(2);
+
+    for (int M : shapes) {
+        xdnn_plan_execute(cache.get(packed, false, M, 1.0f, K, 0.0f, N, nullptr), A.get(), C.get());
+        test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+        test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+        if (cache.size() > 2) {
+            printf("\tFailed: %zu plans cached with capacity 2\n", cache.size());
+            return;
+        }
+    }
+}
+
+// A descriptor reused for another weight (same address, new N, K and data) gets a new plan,
+// and a plan made from a temporary descriptor keeps working after it is gone
+void test_xdnn_plan_cache_reuse(const XDNN_GEMM_KERNELS<float> &kernels, int M, int N, int K) {
+    const int N2 = N + 64, K2 = K / 2;
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, B2, K2 * N2);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, packedB2, xdnn_packb_panels_size(kernels, N2, K2));
+    ALLOC(float, C, M * N2);
+    ALLOC(float, refC, M * N2);
+
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(B2.get(), K2 * N2, -0.25f, 0.25f);
+
+    XDNN_PLAN_CACHE<float> cache;
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    xdnn_plan_execute(cache.get(packed, false, M, 1.0f, K, 0.0f, N, nullptr), A.get(), C.get());
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+
+    packed = xdnn_packb_panels(kernels, false, N2, K2, B2.get(), N2, nullptr, nullptr, packedB2.get());
+    xdnn_plan_execute(cache.get(packed, false, M, 1.0f, K, 0.0f, N2, nullptr), A.get(), C.get());
+    test_utils::gemm_ref(false, false, M, N2, K2, 1.0f, A.get(), K, B2.get(), N2, 0.0f, refC.get(), N2);
+    test_utils::validate(M, N2, K2, K, N2, N2, refC.get(), C.get(), ACCURACY);
+
+    if (cache.size() != 2) {
+        printf("\tFailed: %zu plans cached for 2 weights\n", cache.size());
+    }
+
+    XDNN_GEMM_PLAN<float> plan = xdnn_plan_create(
+            xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get()), false, M, 1.0f, K, 0.0f, N);
+    xdnn_plan_execute(plan, A.get(), C.get());
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    // Same table with the fixed entry points only, to go through the fused head + rest path
+    XDNN_GEMM_KERNELS<float> fixed = xdnn_sgemm_kernels();
+    fixed.compute_post_ops = nullptr;
+    fixed.compute_block = nullptr;
+
+    const XDNN_GEMM_KERNELS<float> *tables[] = {&xdnn_sgemm_kernels(), &fixed};
+    for (const XDNN_GEMM_KERNELS<float> *kernels : tables) {
+        printf("Test xdnn_plan_execute (%s%s):\n", kernels->name, kernels->compute_post_ops ? "" : ", fixed entry points");
+        test_xdnn_plan_execute(*kernels, 1, 4096, 1024, 3);
+        test_xdnn_plan_execute(*kernels, 4, 1000, 512, 3);
+        test_xdnn_plan_execute(*kernels, 37, 200, 300, 2);
+        test_xdnn_plan_execute(*kernels, 128, 512, 256, 2);
+
+        printf("Test XDNN_PLAN_CACHE (%s%s):\n", kernels->name, kernels->compute_post_ops ? "" : ", fixed entry points");
+        test_xdnn_plan_cache(*kernels, 700, 256);
+        test_xdnn_plan_cache_capacity(*kernels, 300, 128);
+        test_xdnn_plan_cache_reuse(*kernels, 5, 300, 512);
+    }
+
+    return 0;
+}
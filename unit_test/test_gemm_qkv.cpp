@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+
+#include "gemm_qkv.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.02f
+
+template <typename TB>
+void test_xdnn_gemm_compute_qkv(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int Nq, int Nkv, int K, bool withBias) {
+    int N = Nq + 2 * Nkv;
+    int lda = K;
+    int ldq = Nq + 4;
+    int ldkv = Nkv * 2; // K and V of a token are next to each other in a cache line
+
+    ALLOC(float, A, M * lda);
+    ALLOC(float, B, K * N);
+    ALLOC(TB, convertedB, K * N);
+    ALLOC(TB, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, scaleB, N);
+    ALLOC(float, zeroB, N);
+    ALLOC(float, bias, N);
+    ALLOC(float, refC, M * N);
+    ALLOC(float, Q, M * ldq);
+    ALLOC(XDNN_BF16, KV, M * ldkv);
+    ALLOC(XDNN_FP16, V, M * Nkv);
+
+    test_utils::init(A.get(), M * lda, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(bias.get(), N, -1.00f, 1.00f);
+
+    prepare_weight(kernels, false, N, K, B.get(), N, 0.99f, convertedB.get(), scaleB.get(), zeroB.get(), B.get());
+
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), lda, B.get(), N, 0.0f, refC.get(), N);
+    if (withBias) test_utils::add_bias(M, N, refC.get(), N, bias.get());
+
+    XDNN_PACKED_B<TB> packed = xdnn_packb_panels(kernels, false, N, K, convertedB.get(), N,
+            scaleB.get(), zeroB.get(), packedB.get());
+    XDNN_SPLIT_OUTPUT q = {Nq, Q.get(), ldq, XDNN_DT_FP32};
+    XDNN_SPLIT_OUTPUT k = {Nkv, KV.get(), ldkv, XDNN_DT_BF16};
+    XDNN_SPLIT_OUTPUT v = {Nkv, V.get(), Nkv, XDNN_DT_FP16};
+    xdnn_gemm_compute_qkv(packed, false, M, A.get(), lda, q, k, v, withBias ? bias.get() : nullptr);
+
+    // validate compares with the same stride, so split refC into the layout of each output
+    ALLOC(float, refQ, M * ldq);
+    ALLOC(float, refK, M * ldkv);
+    ALLOC(float, refV, M * Nkv);
+    for (int i = 0; i < M; ++i) {
+        memcpy(refQ.get() + i * ldq, refC.get() + i * N, Nq * sizeof(float));
+        memcpy(refK.get() + i * ldkv, refC.get() + i * N + Nq, Nkv * sizeof(float));
+        memcpy(refV.get() + i * Nkv, refC.get() + i * N + Nq + Nkv, Nkv * sizeof(float));
+    }
+    test_utils::validate(M, Nq, K, lda, N, ldq, refQ.get(), Q.get(), ACCURACY);
+    test_utils::validate(M, Nkv, K, lda, N, ldkv, refK.get(), KV.get(), ACCURACY);
+    test_utils::validate(M, Nkv, K, lda, N, Nkv, refV.get(), V.get(), ACCURACY);
+}
+
+template <typename TB>
+void test_xdnn_gemm_compute_qkv(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    printf("Test xdnn_gemm_compute_qkv (%s):\n", kernels.name);
+    test_xdnn_gemm_compute_qkv(kernels, 1, 4096, 1024, 4096, false);
+    test_xdnn_gemm_compute_qkv(kernels, 4, 1000, 200, 512, true);
+    test_xdnn_gemm_compute_qkv(kernels, 130, 768, 768, 768, true);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    test_xdnn_gemm_compute_qkv(xdnn_sgemm_kernels());
+    test_xdnn_gemm_compute_qkv(xdnn_hgemm_f32f16f32_kernels());
+    test_xdnn_gemm_compute_qkv(xdnn_sgemm_f32s8f32_kernels());
+
+    return 0;
+}
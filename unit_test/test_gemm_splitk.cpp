@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "quantize_packb.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.01f
+
+// Split-K only when the tiles leave threads idle and K is large enough for two slices
+void test_xdnn_splitk_rows() {
+    bool ok = xdnn_plain_splitk_rows(1, 65536, 32) == 2048;
+    ok &= xdnn_plain_splitk_rows(16, 65536, 32) == 32768;
+    ok &= xdnn_plain_splitk_rows(1, 3000, 8) == 1536;
+    ok &= xdnn_plain_splitk_rows(1, 1500, 8) == 1500;
+    ok &= xdnn_plain_splitk_rows(32, 65536, 32) == 65536;
+    ok &= xdnn_plain_splitk_rows(1, 65536, 1) == 65536;
+
+    if (ok) {
+        printf("\tPassed: xdnn_plain_splitk_rows\n");
+    } else {
+        printf("\tFailed: xdnn_plain_splitk_rows\n");
+    }
+}
+
+// C of a split-K call (small M and a large K, on 'threads' threads) against the same call on one
+// thread, with beta and a post op chain that must run once on the reduced sum
+template <typename TB>
+void test_xdnn_splitk_compute(const XDNN_GEMM_KERNELS<TB> &kernels, int threads, int M, int N, int K) {
+    size_t scales = xdnn_scale_count(kernels, N, K);
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), res((size_t)M * N);
+    std::vector<float> C((size_t)M * N), refC((size_t)M * N), scaleB(scales), zeroB(scales);
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C.data(), C.size(), -1.00f, 1.00f);
+    refC = C;
+
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_gelu(),
+            xdnn_post_op_res_add(res.data(), N)});
+
+    // Reference on one thread, no split
+    int prev = omp_get_max_threads();
+    omp_set_num_threads(1);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            0.5f, refC.data(), N, &ops);
+    omp_set_num_threads(threads);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            0.5f, C.data(), N, &ops);
+    omp_set_num_threads(prev);
+
+    int tiles = ((M + XDNN_PLAIN_MB - 1) / XDNN_PLAIN_MB) * ((N + XDNN_PLAIN_NB - 1) / XDNN_PLAIN_NB);
+    int splits = (K + xdnn_plain_splitk_rows(tiles, K, threads) - 1) / xdnn_plain_splitk_rows(tiles, K, threads);
+    printf("\t%-20s %-6s threads=%2d splits=%2d", kernels.name, xdnn_cpu_isa_name(kernels.isa), threads, splits);
+    test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test split-K:\n");
+    test_xdnn_splitk_rows();
+
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        XDNN_CPU_ISA tier = (XDNN_CPU_ISA)isa;
+        test_xdnn_splitk_compute(xdnn_sgemm_kernels(tier), 8, 1, 64, 65536);
+        test_xdnn_splitk_compute(xdnn_sgemm_kernels(tier), 32, 3, 130, 9000);
+        test_xdnn_splitk_compute(xdnn_hgemm_f32f16f32_kernels(tier), 32, 1, 1024, 16384);
+        test_xdnn_splitk_compute(xdnn_sgemm_f32s8f32_kernels(tier), 16, 1, 64, 65536);
+        test_xdnn_splitk_compute(xdnn_sgemm_f32u4f32_group_kernels(128, tier), 8, 1, 64, 65536);
+        test_xdnn_splitk_compute(xdnn_sgemm_f32u3f32_group_kernels(64, tier), 6, 1, 100, 20000);
+    }
+
+    return 0;
+}
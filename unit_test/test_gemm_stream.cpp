@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "quantize_packb.h"
+#include "gemm_w8a8.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+// C of a chain ending in a STREAM op is, bit for bit, the C of the chain without it. C starts
+// one float past an aligned address and ldc is odd, so the rows start at every alignment.
+template <typename TB>
+void test_xdnn_stream(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K, float beta, int threads = 1) {
+    int ldc = N + 3;
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), res((size_t)M * N);
+    std::vector<float> scaleB(xdnn_scale_count(kernels, N, K)), zeroB(xdnn_zero_count(kernels, N, K));
+    std::vector<float> C0((size_t)M * ldc + 16), C, refC;
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C0.data(), C0.size(), -1.00f, 1.00f);
+    C = C0;
+    refC = C0;
+
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_gelu(),
+            xdnn_post_op_res_add(res.data(), N)});
+    XDNN_POST_OPS stream = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_gelu(),
+            xdnn_post_op_res_add(res.data(), N), xdnn_post_op_stream()});
+
+    int prev = omp_get_max_threads();
+    omp_set_num_threads(threads);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            beta, refC.data() + 1, ldc, &ops);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            beta, C.data() + 1, ldc, &stream);
+    omp_set_num_threads(prev);
+
+    printf("\t%-20s %-6s beta=%.1f threads=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), beta, threads);
+    if (memcmp(C.data(), refC.data(), C.size() * sizeof(float)) != 0) {
+        printf("\tFailed: M=%5d, N=%5d, K=%5d, differs from the call without STREAM\n", M, N, K);
+    } else {
+        printf("\tPassed: M=%5d, N=%5d, K=%5d, ldc=%5d\n", M, N, K, ldc);
+    }
+}
+
+// A STREAM op is dropped for the library tables, whose fused entry points then still match
+void test_xdnn_stream_epilogue() {
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_stream(), xdnn_post_op_silu()});
+    XDNN_GEMM_EPILOGUE lib = xdnn_gemm_epilogue(xdnn_sgemm_kernels(XDNN_ISA_AMX), 1.0f, 0.0f, &ops);
+    XDNN_GEMM_EPILOGUE plain = xdnn_gemm_epilogue(xdnn_sgemm_kernels(XDNN_ISA_AVX2), 1.0f, 0.0f, &ops);
+    bool ok = lib.chain.count == 1 && lib.entry == XDNN_FUSED_SILU && lib.rest.count == 0;
+    ok &= plain.chain.count == 2 && xdnn_post_ops_has(&plain.chain, XDNN_POST_OP_STREAM);
+
+    printf("\t%s: xdnn_gemm_epilogue\n", ok ? "Passed" : "Failed");
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test non-temporal C stores:\n");
+    test_xdnn_stream_epilogue();
+
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        XDNN_CPU_ISA tier = (XDNN_CPU_ISA)isa;
+        test_xdnn_stream(xdnn_sgemm_kernels(tier), 128, 1000, 300, 0.0f);
+        test_xdnn_stream(xdnn_sgemm_kernels(tier), 128, 1000, 300, 0.5f);
+        test_xdnn_stream(xdnn_hgemm_f32f16f32_kernels(tier), 1, 700, 500, 0.0f);
+        test_xdnn_stream(xdnn_hgemm_f32f16f32_kernels(tier), 1, 64, 8192, 0.0f, 4);
+        test_xdnn_stream(xdnn_sgemm_f32u4f32_group_kernels(64, tier), 70, 200, 320, 0.0f);
+        test_xdnn_stream(xdnn_w8a8_sgemm_f32s8f32_kernels(tier), 100, 300, 256, 0.0f);
+        test_xdnn_stream(xdnn_w8a8_sgemm_f32s8f32_kernels(tier), 100, 300, 256, 0.5f);
+    }
+
+    return 0;
+}
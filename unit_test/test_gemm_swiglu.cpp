@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+
+#include "gemm_swiglu.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.01f
+
+template <typename TB>
+void test_xdnn_gemm_compute_swiglu(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K,
+        bool withBias, unsigned int padA = 0, unsigned int padC = 0) {
+    int lda = K + padA;
+    int ldc = N + padC;
+
+    ALLOC(float, A, M * lda);
+    ALLOC(float, gate, K * N);
+    ALLOC(float, up, K * N);
+    ALLOC(TB, convertedGate, K * N);
+    ALLOC(TB, convertedUp, K * N);
+    ALLOC(TB, packedGate, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(TB, packedUp, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, scaleGate, N);
+    ALLOC(float, zeroGate, N);
+    ALLOC(float, scaleUp, N);
+    ALLOC(float, zeroUp, N);
+    ALLOC(float, bias, N);
+    ALLOC(float, refGate, M * ldc);
+    ALLOC(float, C, M * ldc);
+    ALLOC(float, refC, M * ldc);
+
+    test_utils::init(A.get(), M * lda, -1.00f, 1.00f);
+    test_utils::init(gate.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(up.get(), K * N, -0.25f, 0.25f);
+    test_utils::init(bias.get(), N, -1.00f, 1.00f);
+
+    prepare_weight(kernels, false, N, K, gate.get(), N, 0.99f, convertedGate.get(), scaleGate.get(), zeroGate.get(), gate.get());
+    prepare_weight(kernels, false, N, K, up.get(), N, 0.99f, convertedUp.get(), scaleUp.get(), zeroUp.get(), up.get());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.get())});
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), lda, gate.get(), N, 0.0f, refGate.get(), ldc);
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), lda, up.get(), N, 0.0f, refC.get(), ldc);
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            refC.get()[i * ldc + j] *= xdnn_silu(refGate.get()[i * ldc + j]);
+        }
+    }
+    if (withBias) xdnn_apply_post_ops(&ops, 0, 0, M, N, refC.get(), ldc);
+
+    XDNN_PACKED_B<TB> packedG = xdnn_packb_panels(kernels, false, N, K, convertedGate.get(), N,
+            scaleGate.get(), zeroGate.get(), packedGate.get());
+    XDNN_PACKED_B<TB> packedU = xdnn_packb_panels(kernels, false, N, K, convertedUp.get(), N,
+            scaleUp.get(), zeroUp.get(), packedUp.get());
+    xdnn_gemm_compute_swiglu(packedG, packedU, false, M, A.get(), lda, C.get(), ldc, withBias ? &ops : nullptr);
+
+    test_utils::validate(M, N, K, lda, N, ldc, refC.get(), C.get(), ACCURACY);
+}
+
+template <typename TB>
+void test_xdnn_gemm_compute_swiglu(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    printf("Test xdnn_gemm_compute_swiglu (%s):\n", kernels.name);
+    test_xdnn_gemm_compute_swiglu(kernels, 1, 1408, 2048, false);
+    test_xdnn_gemm_compute_swiglu(kernels, 7, 1408, 2048, true, 4, 4);
+    test_xdnn_gemm_compute_swiglu(kernels, 128, 688, 512, false);
+    test_xdnn_gemm_compute_swiglu(kernels, 300, 256, 256, true);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    test_xdnn_gemm_compute_swiglu(xdnn_sgemm_kernels());
+    test_xdnn_gemm_compute_swiglu(xdnn_hgemm_f32f16f32_kernels());
+    test_xdnn_gemm_compute_swiglu(xdnn_bgemm_f32bf16f32_kernels());
+    test_xdnn_gemm_compute_swiglu(xdnn_sgemm_f32s8f32_kernels());
+    test_xdnn_gemm_compute_swiglu(xdnn_sgemm_f32u4f32_kernels());
+    test_xdnn_gemm_compute_swiglu(xdnn_sgemm_f32nf4f32_kernels());
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gemm_w8a8.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.10f
+
+static const char *kernel_name(XDNN_W8A8_KERNEL kernel) {
+    switch (kernel) {
+        case XDNN_W8A8_AVX_VNNI: return "avx_vnni";
+        case XDNN_W8A8_AVX512_VNNI: return "avx512_vnni";
+        case XDNN_W8A8_AMX_INT8: return "amx_int8";
+        default: return "avx2";
+    }
+}
+
+static bool kernel_available(XDNN_W8A8_KERNEL kernel) {
+    const XDNN_CPU_FEATURES &f = xdnn_cpu_features();
+    switch (kernel) {
+        case XDNN_W8A8_AVX_VNNI: return f.avx_vnni;
+        case XDNN_W8A8_AVX512_VNNI: return f.avx512_vnni;
+        case XDNN_W8A8_AMX_INT8: return f.amx_tile && f.amx_int8;
+        default: return f.avx2;
+    }
+}
+
+// Every kernel against fp32 A x dequantized B, and bit for bit against the AVX2 kernel
+void test_xdnn_w8a8_compute(bool transA, int M, int N, int K, unsigned int padA = 0, unsigned int padC = 0) {
+    int lda = (transA ? M : K) + padA;
+    int ldc = N + padC;
+    int rowsA = transA ? K : M;
+
+    std::vector<float> A((size_t)rowsA * lda), B((size_t)K * N), roundedB((size_t)K * N);
+    std::vector<int8_t> quantizedB((size_t)K * N);
+    std::vector<float> scaleB(N), zeroB(N), C0((size_t)M * ldc), refC((size_t)M * ldc), baseC((size_t)M * ldc);
+    ALLOC(int8_t, packedB, xdnn_w8a8_sgemm_f32s8f32_packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(C0.data(), C0.size(), -1.00f, 1.00f);
+
+    xdnn_w8a8_sgemm_f32s8f32_quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, scaleB.data(), zeroB.data());
+    test_utils::init(zeroB.data(), N, -0.01f, 0.01f); // the zeroB term of the epilogue
+    for (int k = 0; k < K; ++k) {
+        for (int n = 0; n < N; ++n) roundedB[(size_t)k * N + n] = quantizedB[(size_t)k * N + n] * scaleB[n] + zeroB[n];
+    }
+    xdnn_w8a8_sgemm_f32s8f32_packb(false, N, K, quantizedB.data(), N, packedB.get());
+
+    // gemm_ref takes A as M x K
+    std::vector<float> refA((size_t)M * K);
+    for (int m = 0; m < M; ++m) {
+        for (int k = 0; k < K; ++k) refA[(size_t)m * K + k] = transA ? A[(size_t)k * lda + m] : A[(size_t)m * lda + k];
+    }
+    refC = C0;
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, refA.data(), K, roundedB.data(), N, 0.5f, refC.data(), ldc);
+
+    for (int k = XDNN_W8A8_AVX2; k <= XDNN_W8A8_AMX_INT8; ++k) {
+        XDNN_W8A8_KERNEL kernel = (XDNN_W8A8_KERNEL)k;
+        if (!kernel_available(kernel)) continue;
+
+        std::vector<float> C = C0;
+        xdnn_w8a8_gemm_compute(kernel, transA, M, N, K, 1.0f, A.data(), lda, packedB.get(), scaleB.data(), zeroB.data(),
+                0.5f, C.data(), ldc, nullptr);
+        if (kernel == XDNN_W8A8_AVX2) baseC = C;
+
+        printf("\t%-12s transA=%d", kernel_name(kernel), transA);
+        if (memcmp(C.data(), baseC.data(), C.size() * sizeof(float)) != 0) {
+            printf("\tFailed: M=%5d, N=%5d, K=%5d, differs from the avx2 kernel\n", M, N, K);
+            continue;
+        }
+        test_utils::validate(M, N, K, lda, N, ldc, refC.data(), C.data(), ACCURACY);
+    }
+}
+
+// Null scaleB/zeroB are the same as scales of 1 and zero points of 0
+void test_xdnn_w8a8_null_scale_zero(int M, int N, int K) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N);
+    std::vector<int8_t> quantizedB((size_t)K * N);
+    std::vector<float> scaleB(N), zeroB(N), ones(N, 1.0f), zeros(N, 0.0f), C1((size_t)M * N), C2((size_t)M * N);
+    ALLOC(int8_t, packedB, xdnn_w8a8_sgemm_f32s8f32_packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    xdnn_w8a8_sgemm_f32s8f32_quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, scaleB.data(), zeroB.data());
+    xdnn_w8a8_sgemm_f32s8f32_packb(false, N, K, quantizedB.data(), N, packedB.get());
+
+    for (int k = XDNN_W8A8_AVX2; k <= XDNN_W8A8_AMX_INT8; ++k) {
+        XDNN_W8A8_KERNEL kernel = (XDNN_W8A8_KERNEL)k;
+        if (!kernel_available(kernel)) continue;
+
+        xdnn_w8a8_gemm_compute(kernel, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeros.data(),
+                0.0f, C1.data(), N, nullptr);
+        xdnn_w8a8_gemm_compute(kernel, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), nullptr,
+                0.0f, C2.data(), N, nullptr);
+        bool zero_ok = memcmp(C1.data(), C2.data(), C1.size() * sizeof(float)) == 0;
+
+        xdnn_w8a8_gemm_compute(kernel, false, M, N, K, 1.0f, A.data(), K, packedB.get(), ones.data(), nullptr,
+                0.0f, C1.data(), N, nullptr);
+        xdnn_w8a8_gemm_compute(kernel, false, M, N, K, 1.0f, A.data(), K, packedB.get(), nullptr, nullptr,
+                0.0f, C2.data(), N, nullptr);
+        bool scale_ok = memcmp(C1.data(), C2.data(), C1.size() * sizeof(float)) == 0;
+
+        if (!zero_ok || !scale_ok) {
+            printf("\tFailed: %-12s M=%d, N=%d, K=%d, null %s differs\n", kernel_name(kernel), M, N, K,
+                    zero_ok ? "scaleB" : "zeroB");
+            continue;
+        }
+        printf("\tPassed: %-12s M=%d, N=%d, K=%d\n", kernel_name(kernel), M, N, K);
+    }
+}
+
+// The kernel table of the running CPU with a post op chain
+void test_xdnn_w8a8_kernels(const XDNN_GEMM_KERNELS<int8_t> &kernels, int M, int N, int K) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), roundedB((size_t)K * N), bias(N);
+    std::vector<int8_t> quantizedB((size_t)K * N);
+    std::vector<float> scaleB(N), zeroB(N), C((size_t)M * N), refC((size_t)M * N);
+    ALLOC(int8_t, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+
+    kernels.quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, scaleB.data(), zeroB.data());
+    for (int k = 0; k < K; ++k) {
+        for (int n = 0; n < N; ++n) roundedB[(size_t)k * N + n] = quantizedB[(size_t)k * N + n] * scaleB[n] + zeroB[n];
+    }
+    kernels.packb(false, N, K, quantizedB.data(), N, packedB.get());
+
+    XDNN_POST_OPS ops = xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_gelu()});
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), K, roundedB.data(), N, 0.0f, refC.data(), N);
+    xdnn_apply_post_ops(&ops, 0, 0, M, N, refC.data(), N);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            0.0f, C.data(), N, &ops);
+
+    printf("\t%-12s bias+gelu", xdnn_cpu_isa_name(kernels.isa));
+    test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+}
+
+// The packed B of B and of its transpose are the same
+void test_xdnn_w8a8_packb(int N, int K) {
+    std::vector<int8_t> B((size_t)K * N), transposedB((size_t)K * N);
+    size_t size = xdnn_w8a8_sgemm_f32s8f32_packb_size(N, K);
+    ALLOC(int8_t, packedB1, size);
+    ALLOC(int8_t, packedB2, size);
+
+    for (size_t i = 0; i < B.size(); ++i) B[i] = (int8_t)(rand() % 255 - 127);
+    test_utils::transpose(N, K, B.data(), N, transposedB.data());
+    xdnn_w8a8_sgemm_f32s8f32_packb(false, N, K, B.data(), N, packedB1.get());
+    xdnn_w8a8_sgemm_f32s8f32_packb(true, N, K, transposedB.data(), K, packedB2.get());
+
+    if (memcmp(packedB1.get(), packedB2.get(), size) != 0) {
+        printf("\tFailed: packed matrix different (K=%d, N=%d)\n", K, N);
+        return;
+    }
+    printf("\tPassed: K=%d, N=%d\n", K, N);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test xdnn_w8a8_sgemm_f32s8f32_packb:\n");
+    test_xdnn_w8a8_packb(768, 768);
+    test_xdnn_w8a8_packb(300, 77);
+
+    printf("Test xdnn_w8a8_gemm_compute:\n");
+    for (bool transA : {false, true}) {
+        test_xdnn_w8a8_compute(transA, 1, 4096, 512);
+        test_xdnn_w8a8_compute(transA, 34, 1710, 512, 4, 4);
+        test_xdnn_w8a8_compute(transA, 128, 128, 130);
+        test_xdnn_w8a8_compute(transA, 300, 200, 70, 3, 1);
+    }
+
+    printf("Test xdnn_w8a8_gemm_compute with null scaleB/zeroB:\n");
+    test_xdnn_w8a8_null_scale_zero(67, 320, 256);
+
+    printf("Test xdnn_w8a8_sgemm_f32s8f32_kernels:\n");
+    for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+        test_xdnn_w8a8_kernels(xdnn_w8a8_sgemm_f32s8f32_kernels((XDNN_CPU_ISA)isa), 67, 320, 256);
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "packed_b.h"
+#include "packed_file.h"
+#include "packb_size.h"
+#include "thread_context.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+// packb writes nothing past the buffer of xdnn_packb_layout, and all of it on the portable formats
+template <typename TB>
+void test_xdnn_packb_layout(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K) {
+    XDNN_PACKB_LAYOUT layout = xdnn_packb_layout(kernels, N, K);
+    const size_t canary = 256;
+
+    std::vector<float> B((size_t)K * N);
+    std::vector<float> scaleB(N), zeroB(N);
+    std::vector<TB> convertedB((size_t)K * N);
+    test_utils::init(B.data(), K * N, -0.25f, 0.25f);
+    prepare_weight(kernels, false, N, K, B.data(), N, 0.99f, convertedB.data(), scaleB.data(), zeroB.data());
+
+    bool ok = layout.bytes == layout.elems * sizeof(TB) && layout.alignment == XDNN_PACKB_ALIGN;
+    std::vector<unsigned char> packed[2];
+    for (int i = 0; i < 2; ++i) {
+        unsigned char fill = i == 0 ? 0x00 : 0xFF;
+        std::unique_ptr<unsigned char, decltype(&free)> buffer(
+                (unsigned char *)aligned_alloc(layout.alignment, layout.bytes + canary), &free);
+        memset(buffer.get(), fill, layout.bytes + canary);
+        kernels.packb(false, N, K, convertedB.data(), N, (TB *)buffer.get());
+        for (size_t j = layout.bytes; j < layout.bytes + canary; ++j) ok &= buffer.get()[j] == fill;
+        packed[i].assign(buffer.get(), buffer.get() + layout.bytes);
+    }
+    // The last element is written whatever the buffer held, if the size is exact (the portable formats)
+    if (kernels.isa != XDNN_ISA_AMX) ok &= memcmp(packed[0].data() + layout.bytes - sizeof(TB), packed[1].data() + layout.bytes - sizeof(TB), sizeof(TB)) == 0;
+
+    if (ok) {
+        printf("\tPassed: %s, N=%d, K=%d, %zu bytes\n", kernels.name, N, K, layout.bytes);
+    } else {
+        printf("\tFailed: %s, N=%d, K=%d, %zu bytes\n", kernels.name, N, K, layout.bytes);
+    }
+}
+
+void test_xdnn_packb_size_families() {
+    bool ok = xdnn_sgemm_packb_size(100, 30) == 3000;
+    ok &= xdnn_hgemm_f32f16f32_packb_size(100, 30) == 3000;
+    ok &= xdnn_sgemm_f32s8f32_packb_size(100, 30) == 3000;
+    ok &= xdnn_sgemm_f32u4f32_packb_size(100, 30) == 3000;
+    ok &= xdnn_sgemm_f32nf4f32_packb_size(101, 30) == 3030;
+    ok &= xdnn_sgemm_f32e4m3f32_packb_size(101, 30) == 3030;
+    ok &= xdnn_sgemm_f32u2f32_packb_size(101, 30) == 780;
+    ok &= xdnn_sgemm_f32u3f32_packb_size(101, 30) == 390;
+    ok &= xdnn_sgemm_f32u3f32_kernels(XDNN_ISA_AVX2).packb_size(101, 30) == 390;
+    ok &= xdnn_hgemm_f32u4f32_packb_size(7, 3) == 21;
+    ok &= xdnn_sgemm_f32u4f32_kernels(XDNN_ISA_AMX).packb_size(7, 3) == 21;
+    ok &= xdnn_sgemm_f32u4f32_kernels(XDNN_ISA_AVX2).packb_size(7, 3) == 12;
+
+    if (ok) {
+        printf("\tPassed: xdnn_<family>_packb_size\n");
+    } else {
+        printf("\tFailed: xdnn_<family>_packb_size\n");
+    }
+}
+
+// The portable sgemm as a blocked family: the block pads the panels, so a packb with
+// another block than the buffer was sized for would not fit
+static XDNN_PACKB_BLOCK fake_packb_block(int N, int K, int threads) {
+    return xdnn_packb_block("fake_blocked_sgemm", N, K, {16, 32}, threads);
+}
+
+static size_t fake_packb_size_blocked(int N, int K, XDNN_PACKB_BLOCK b) {
+    return (size_t)(K + b.block_rows - 1) / b.block_rows * b.block_rows * ((N + b.block_cols - 1) / b.block_cols * b.block_cols);
+}
+
+static void fake_packb_blocked(bool transB, int N, int K, const float *B, int ldb, float *packedB, XDNN_PACKB_BLOCK b) {
+    const XDNN_GEMM_KERNELS<float> &kernels = xdnn_sgemm_kernels(std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512));
+    size_t used = kernels.packb_size(N, K);
+    kernels.packb(transB, N, K, B, ldb, packedB);
+    memset(packedB + used, 0, (fake_packb_size_blocked(N, K, b) - used) * sizeof(float));
+}
+
+// A weight is packed with the block tuned for the team it is packed for, not for the thread
+// that packs it (a thread scope of 1 thread here), and the packed file header records that block
+void test_xdnn_packb_panels_block(int M, int N, int K, int threads) {
+    XDNN_GEMM_KERNELS<float> kernels = xdnn_sgemm_kernels(std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512));
+    kernels.name = "fake_blocked_sgemm";
+    kernels.packb_block = fake_packb_block;
+    kernels.packb_size_blocked = fake_packb_size_blocked;
+    kernels.packb_blocked = fake_packb_blocked;
+    xdnn_tuning_db().add({"fake_blocked_sgemm", XDNN_PANEL_COLS, K, threads, 1, 64, {64, 128}, 1.0f});
+
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+
+    size_t size = xdnn_packb_panels_size(kernels, N, K, XDNN_PANEL_COLS, threads);
+    ALLOC(float, packedB, size);
+    XDNN_PACKED_B<float> packed;
+    {
+        XDNN_THREAD_SCOPE scope(xdnn_thread_context(1));
+        packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get(), XDNN_PANEL_COLS, threads);
+    }
+    XDNN_PACKED_FILE_HEADER h = xdnn_packed_file_header(packed);
+
+    xdnn_packed_b_compute(packed, false, M, 1.0f, A.get(), K, 0.0f, C.get(), N, nullptr);
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), 0.01f);
+
+    bool ok = packed.block.block_rows == 64 && packed.block.block_cols == 128
+            && packed.panels * packed.panel_stride == size && h.block_rows == 64 && h.block_cols == 128
+            && xdnn_panel_block(kernels, K, XDNN_PANEL_COLS, threads + 1).block_rows == 16;
+    if (ok) {
+        printf("\tPassed: N=%d, K=%d, block %d x %d for %d threads\n", N, K, packed.block.block_rows,
+                packed.block.block_cols, threads);
+    } else {
+        printf("\tFailed: N=%d, K=%d, block %d x %d for %d threads\n", N, K, packed.block.block_rows,
+                packed.block.block_cols, threads);
+    }
+}
+
+// Buffers of an arena are aligned and don't overlap
+void test_xdnn_packb_arena() {
+    const XDNN_GEMM_KERNELS<int8_t> &kernels = xdnn_sgemm_f32s8f32_kernels();
+    const int shapes[][2] = {{4096, 4096}, {11008, 4096}, {4096, 11008}, {33, 7}, {1, 1}, {4096, 4096}};
+
+    XDNN_PACKB_ARENA arena;
+    std::vector<size_t> offsets, bytes;
+    for (const int *s : shapes) {
+        XDNN_PACKB_LAYOUT layout = xdnn_packb_panels_layout(kernels, s[0], s[1]);
+        offsets.push_back(arena.reserve(layout));
+        bytes.push_back(layout.bytes);
+    }
+
+    bool ok = arena.max_alignment() == XDNN_PACKB_ALIGN && arena.size(XDNN_HUGE_PAGE) % XDNN_HUGE_PAGE == 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        ok &= offsets[i] % XDNN_PACKB_ALIGN == 0;
+        if (i > 0) ok &= offsets[i] >= offsets[i - 1] + bytes[i - 1] && offsets[i] < offsets[i - 1] + bytes[i - 1] + XDNN_PACKB_ALIGN;
+    }
+    ok &= arena.size() == offsets.back() + bytes.back();
+
+    if (ok) {
+        printf("\tPassed: %zu buffers, %zu bytes\n", offsets.size(), arena.size());
+    } else {
+        printf("\tFailed: arena layout\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test xdnn_packb_layout (%s):\n", xdnn_cpu_isa_name(xdnn_cpu_isa()));
+    test_xdnn_packb_layout(xdnn_sgemm_kernels(), 100, 30);
+    test_xdnn_packb_layout(xdnn_hgemm_f32f16f32_kernels(), 128, 64);
+    test_xdnn_packb_layout(xdnn_bgemm_f32bf16f32_kernels(), 80, 16);
+    test_xdnn_packb_layout(xdnn_sgemm_f32s8f32_kernels(), 300, 17);
+    test_xdnn_packb_layout(xdnn_sgemm_f32u4f32_kernels(), 64, 33);
+    test_xdnn_packb_layout(xdnn_sgemm_f32nf4f32_kernels(), 256, 8);
+    test_xdnn_packb_layout(xdnn_sgemm_f32u3f32_kernels(), 61, 9);
+
+    printf("Test xdnn_<family>_packb_size:\n");
+    test_xdnn_packb_size_families();
+
+    printf("Test xdnn_packb_panels block:\n");
+    test_xdnn_packb_panels_block(3, 300, 100, 4);
+
+    printf("Test XDNN_PACKB_ARENA:\n");
+    test_xdnn_packb_arena();
+
+    return 0;
+}
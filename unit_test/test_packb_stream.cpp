@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "packb_stream.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+// Streaming B in chunks of 'chunk' rows packs the same bytes (and scales) as quantize + pack of the whole B
+template <typename TB>
+void test_xdnn_packb_stream(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, int chunk) {
+    int rowsB = transB ? N : K;
+    int ldb = transB ? K : N;
+    bool quantized = kernels.quantize != nullptr;
+    size_t size = xdnn_packb_panels_size(kernels, N, K);
+
+    std::vector<float> B((size_t)rowsB * ldb);
+    std::vector<TB> convertedB(xdnn_elems<TB>((size_t)K * N + 1));
+    std::vector<float> scaleB(N), zeroB(N), refScaleB(N), refZeroB(N);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(TB));
+    memset((void *)refPackedB.get(), 0, size * sizeof(TB));
+    test_utils::init(B.data(), rowsB * ldb, -0.25f, 0.25f);
+
+    prepare_weight(kernels, transB, N, K, B.data(), ldb, 1.0f, convertedB.data(), refScaleB.data(), refZeroB.data());
+    xdnn_packb_panels(kernels, transB, N, K, convertedB.data(), ldb, refScaleB.data(), refZeroB.data(), refPackedB.get());
+
+    XDNN_PACKB_STREAM<TB> stream(kernels, transB, N, K, packedB.get(), scaleB.data(), zeroB.data());
+    if (quantized && !transB) {
+        for (int r = 0; r < rowsB; r += chunk) stream.observe(B.data() + (size_t)r * ldb, std::min(chunk, rowsB - r), ldb);
+    }
+    for (int r = 0; r < rowsB; r += chunk) stream.push(B.data() + (size_t)r * ldb, std::min(chunk, rowsB - r), ldb);
+    XDNN_PACKED_B<TB> packed = stream.finish();
+
+    bool ok = packed.panels == (N + XDNN_PANEL_COLS - 1) / XDNN_PANEL_COLS && packed.data == packedB.get();
+    ok &= memcmp(packedB.get(), refPackedB.get(), size * sizeof(TB)) == 0;
+    if (quantized) {
+        ok &= memcmp(scaleB.data(), refScaleB.data(), N * sizeof(float)) == 0;
+        ok &= memcmp(zeroB.data(), refZeroB.data(), N * sizeof(float)) == 0;
+    }
+
+    if (ok) {
+        printf("\tPassed: %s, transB=%d, N=%d, K=%d, chunk=%d\n", kernels.name, transB, N, K, chunk);
+    } else {
+        printf("\tFailed: %s, transB=%d, N=%d, K=%d, chunk=%d\n", kernels.name, transB, N, K, chunk);
+    }
+}
+
+template <typename TB>
+void test_xdnn_packb_stream(const XDNN_GEMM_KERNELS<TB> &kernels) {
+    printf("Test XDNN_PACKB_STREAM (%s, %s):\n", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+    for (bool transB : {true, false}) {
+        test_xdnn_packb_stream(kernels, transB, 256, 128, 64);
+        test_xdnn_packb_stream(kernels, transB, 300, 130, 37);
+        test_xdnn_packb_stream(kernels, transB, 130, 300, 1);
+        test_xdnn_packb_stream(kernels, transB, 1000, 64, 1000);
+        test_xdnn_packb_stream(kernels, transB, 77, 50, 200);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    test_xdnn_packb_stream(xdnn_sgemm_kernels());
+    test_xdnn_packb_stream(xdnn_hgemm_f32f16f32_kernels());
+    test_xdnn_packb_stream(xdnn_bgemm_f32bf16f32_kernels());
+    test_xdnn_packb_stream(xdnn_sgemm_f32s8f32_kernels());
+    test_xdnn_packb_stream(xdnn_sgemm_f32u4f32_kernels());
+    test_xdnn_packb_stream(xdnn_sgemm_f32nf4f32_kernels());
+
+    return 0;
+}
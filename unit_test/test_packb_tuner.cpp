@@ -0,0 +1,163 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <unistd.h>
+
+#include "packb_tuner.h"
+#include "gemm_kernels.h"
+#include "../utils/utils.h"
+
+// A family whose compute gets slower the further the block is from 64 x 128,
+// with a plain sgemm on B so that the packed layout must be right
+struct fake_blocked_family {
+    using TA = float;
+    using TB = float;
+    using TC = float;
+    static constexpr const char *name = "fake_blocked";
+    static constexpr XDNN_PACKB_BLOCK fallback = {16, 64};
+
+    static size_t packb_size(int N, int K, XDNN_PACKB_BLOCK) {
+        return (size_t)K * N;
+    }
+
+    static void packb(int N, int K, const TB *B, int ldb, TB *packedB, XDNN_PACKB_BLOCK) {
+        for (int k = 0; k < K; ++k) memcpy(packedB + (size_t)k * N, B + (size_t)k * ldb, N * sizeof(float));
+    }
+
+    static void compute(int M, int N, int K, const TA *A, int lda, const TB *packedB, XDNN_PACKB_BLOCK b, TC *C, int ldc) {
+        int penalty = 1 + std::abs(b.block_rows - 64) / 16 + std::abs(b.block_cols - 128) / 32;
+        for (int r = 0; r < penalty; ++r) {
+            test_utils::gemm_ref(false, false, M, N, K, 1.0f, A, lda, packedB, N, 0.0f, C, ldc);
+        }
+    }
+};
+
+// The same family with a packb that gets the layout wrong for the fastest block
+struct fake_broken_family : fake_blocked_family {
+    static constexpr const char *name = "fake_broken";
+
+    static void packb(int N, int K, const TB *B, int ldb, TB *packedB, XDNN_PACKB_BLOCK b) {
+        fake_blocked_family::packb(N, K, B, ldb, packedB, b);
+        if (b.block_rows == 64 && b.block_cols == 128) std::swap(packedB[0], packedB[(size_t)K * N - 1]);
+    }
+};
+
+void test_xdnn_tune_packb_block(int m_lo, int m_hi, int N, int K) {
+    XDNN_TUNING_DB db;
+    XDNN_TUNING_ENTRY e = xdnn_tune_packb_block<fake_blocked_family>(m_lo, m_hi, N, K, {}, 3, db);
+
+    XDNN_PACKB_BLOCK found = db.find("fake_blocked", N, K, omp_get_max_threads(), m_hi, {0, 0});
+    if (e.block.block_rows == 64 && e.block.block_cols == 128 && found.block_rows == 64 && found.block_cols == 128) {
+        printf("\tPassed: M=[%d, %d], N=%d, K=%d, %.1fus\n", m_lo, m_hi, N, K, e.us);
+    } else {
+        printf("\tFailed: M=[%d, %d], N=%d, K=%d, got %d x %d\n", m_lo, m_hi, N, K, e.block.block_rows, e.block.block_cols);
+    }
+}
+
+// The wrongly packed block is rejected even though it is the fastest
+void test_xdnn_tune_packb_block_mismatch(int m_lo, int m_hi, int N, int K) {
+    XDNN_TUNING_DB db;
+    XDNN_TUNING_ENTRY e = xdnn_tune_packb_block<fake_broken_family>(m_lo, m_hi, N, K, {}, 3, db);
+
+    if (!(e.block.block_rows == 64 && e.block.block_cols == 128) && e.us < INFINITY) {
+        printf("\tPassed: M=[%d, %d], N=%d, K=%d, %d x %d rejected, got %d x %d\n", m_lo, m_hi, N, K, 64, 128,
+                e.block.block_rows, e.block.block_cols);
+    } else {
+        printf("\tFailed: M=[%d, %d], N=%d, K=%d, got %d x %d\n", m_lo, m_hi, N, K, e.block.block_rows, e.block.block_cols);
+    }
+}
+
+// A library family packed with the tuned block (N, K not multiples of the larger blocks) gives A * B
+template <typename Family>
+void test_xdnn_tune_packb_block_family(int M, int N, int K) {
+    using TB = typename Family::TB;
+    XDNN_TUNING_DB db;
+    XDNN_TUNING_ENTRY e = xdnn_tune_packb_block<Family>(1, M, N, K, {}, 1, db);
+
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(TB, convertedB, K * N);
+    ALLOC(TB, packedB, Family::packb_size(N, K, e.block));
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    for (int i = 0; i < K * N; ++i) {
+        convertedB.get()[i] = static_cast<TB>(B.get()[i]);
+        B.get()[i] = static_cast<float>(convertedB.get()[i]);
+    }
+
+    Family::packb(N, K, convertedB.get(), N, packedB.get(), e.block);
+    Family::compute(M, N, K, A.get(), K, packedB.get(), e.block, C.get(), N);
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), 0.01f);
+}
+
+// Entries survive a save/load, are found by M range, and replace older ones of the same key
+void test_xdnn_tuning_db_file() {
+    char path[] = "/tmp/xdnn_tuning_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+
+    XDNN_TUNING_DB db;
+    db.add({"bgemm_f32bf16f32", 4096, 4096, 8, 1, 16, {32, 64}, 10.0f});
+    db.add({"bgemm_f32bf16f32", 4096, 4096, 8, 17, 1024, {64, 128}, 100.0f});
+    db.add({"bgemm_f32bf16f32", 4096, 4096, 8, 1, 16, {64, 64}, 9.0f});
+    db.add({"hgemm_f32f16f32", 4096, 11008, 8, 1, 1, {128, 256}, 20.0f});
+    bool saved = db.save(path);
+
+    XDNN_TUNING_DB loaded;
+    bool ok = saved && loaded.load(path) && loaded.size() == 3;
+    XDNN_PACKB_BLOCK none = {-1, -1};
+    XDNN_PACKB_BLOCK b1 = loaded.find("bgemm_f32bf16f32", 4096, 4096, 8, 4, none);
+    XDNN_PACKB_BLOCK b2 = loaded.find("bgemm_f32bf16f32", 4096, 4096, 8, 512, none);
+    XDNN_PACKB_BLOCK b3 = loaded.find("bgemm_f32bf16f32", 4096, 4096, 8, -1, none);
+    XDNN_PACKB_BLOCK b4 = loaded.find("bgemm_f32bf16f32", 4096, 4096, 16, 4, none);
+    XDNN_PACKB_BLOCK b5 = loaded.find("hgemm_f32f16f32", 4096, 11008, 8, 1, none);
+    ok &= b1.block_rows == 64 && b1.block_cols == 64;
+    ok &= b2.block_rows == 64 && b2.block_cols == 128;
+    ok &= b3.block_rows == 64 && b3.block_cols == 128;
+    ok &= b4.block_rows == -1;
+    ok &= b5.block_rows == 128 && b5.block_cols == 256;
+
+    // Not a tuning db
+    FILE *fp = fopen(path, "w");
+    fprintf(fp, "bgemm_f32bf16f32 1 1 1 1 1 1 1 1\n");
+    fclose(fp);
+    ok &= !loaded.load(path) && loaded.size() == 3;
+    remove(path);
+
+    if (ok) {
+        printf("\tPassed: save/load/find\n");
+    } else {
+        printf("\tFailed: save/load/find\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test XDNN_TUNING_DB:\n");
+    test_xdnn_tuning_db_file();
+
+    printf("Test xdnn_tune_packb_block:\n");
+    test_xdnn_tune_packb_block(1, 1, 256, 256);
+    test_xdnn_tune_packb_block(1, 16, 512, 256);
+    test_xdnn_tune_packb_block(8, 64, 256, 512);
+
+    printf("Test xdnn_tune_packb_block (rejected blocks):\n");
+    test_xdnn_tune_packb_block_mismatch(1, 1, 256, 256);
+    test_xdnn_tune_packb_block_mismatch(4, 16, 512, 256);
+
+    printf("Test xdnn_tune_packb_block (%s):\n", xdnn_blocked_bgemm_f32bf16f32::name);
+    test_xdnn_tune_packb_block_family<xdnn_blocked_bgemm_f32bf16f32>(16, 300, 200);
+
+    printf("Test xdnn_tune_packb_block (%s):\n", xdnn_blocked_hgemm_f32f16f32::name);
+    test_xdnn_tune_packb_block_family<xdnn_blocked_hgemm_f32f16f32>(16, 300, 200);
+
+    return 0;
+}
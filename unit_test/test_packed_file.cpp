@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <unistd.h>
+
+#include "packed_file.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.01f
+
+// Pack, save, map back and compute from the mapping: same C as from the packed buffer.
+// withZero = false packs the quantized weights with zeroB = nullptr (FP8).
+template <typename TB>
+void test_xdnn_packed_b_file(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K, bool withZero = true) {
+    char path[] = "/tmp/xdnn_packed_XXXXXX";
+    close(mkstemp(path));
+
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(TB, convertedB, K * N);
+    ALLOC(TB, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, scaleB, N);
+    ALLOC(float, zeroB, N);
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    prepare_weight(kernels, false, N, K, B.get(), N, 0.99f, convertedB.get(), scaleB.get(), zeroB.get());
+
+    bool quantized = kernels.quantize != nullptr;
+    XDNN_PACKED_B<TB> packed = xdnn_packb_panels(kernels, false, N, K, convertedB.get(), N,
+            quantized ? scaleB.get() : nullptr, quantized && withZero ? zeroB.get() : nullptr, packedB.get());
+    xdnn_packed_b_compute(packed, false, M, 1.0f, A.get(), K, 0.0f, refC.get(), N, nullptr);
+
+    if (!xdnn_save_packed_b(path, packed)) {
+        printf("\tFailed: cannot save %s\n", path);
+        return;
+    }
+
+    {
+        XDNN_PACKED_B_FILE<TB> file(path, kernels, true);
+        if (!file.valid()) {
+            printf("\tFailed: %s\n", file.error());
+        } else {
+            xdnn_packed_b_compute(file.packed(), false, M, 1.0f, A.get(), K, 0.0f, C.get(), N, nullptr);
+            test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+        }
+    }
+
+    // Rejected with a table of another ISA tier, or when corrupted
+    XDNN_GEMM_KERNELS<TB> other = kernels;
+    other.isa = kernels.isa == XDNN_ISA_AVX2 ? XDNN_ISA_AVX512 : XDNN_ISA_AVX2;
+    XDNN_PACKED_B_FILE<TB> wrongIsa(path, other);
+
+    FILE *fp = fopen(path, "r+b");
+    fseek(fp, offsetof(XDNN_PACKED_FILE_HEADER, panels), SEEK_SET);
+    int panels = packed.panels + 1;
+    fwrite(&panels, sizeof(panels), 1, fp);
+    fclose(fp);
+    XDNN_PACKED_B_FILE<TB> corrupted(path, kernels);
+
+    truncate(path, XDNN_PACKED_FILE_ALIGN);
+    XDNN_PACKED_B_FILE<TB> truncated(path, kernels);
+    XDNN_PACKED_B_FILE<TB> missing("/tmp/xdnn_packed_missing", kernels);
+    remove(path);
+
+    if (!wrongIsa.valid() && !corrupted.valid() && !truncated.valid() && !missing.valid()) {
+        printf("\tPassed: rejected (%s, %s, %s, %s)\n", wrongIsa.error(), corrupted.error(), truncated.error(), missing.error());
+    } else {
+        printf("\tFailed: a bad file was loaded\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test XDNN_PACKED_B_FILE (%s):\n", xdnn_cpu_isa_name(xdnn_cpu_isa()));
+    test_xdnn_packed_b_file(xdnn_sgemm_kernels(), 16, 1000, 512);
+    test_xdnn_packed_b_file(xdnn_hgemm_f32f16f32_kernels(), 4, 512, 256);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32s8f32_kernels(), 7, 300, 256);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32u4f32_kernels(), 1, 256, 512);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32nf4f32_kernels(), 33, 128, 128);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32e4m3f32_kernels(), 5, 200, 128);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32e4m3f32_kernels(), 3, 136, 64, false);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32e5m2f32_kernels(), 2, 100, 96, false);
+    test_xdnn_packed_b_file(xdnn_sgemm_f32u3f32_kernels(), 1, 264, 96);
+
+    return 0;
+}
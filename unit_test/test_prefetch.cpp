@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "prefetch.h"
+#include "quantize_packb.h"
+#include "thread_pool.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+// The shares of a team cover every byte of the range once, in whole cache lines
+void test_xdnn_prefetch_share_range() {
+    bool ok = true;
+    for (size_t bytes : {(size_t)0, (size_t)1, (size_t)63, (size_t)64, (size_t)65, (size_t)1000, (size_t)4097}) {
+        for (int n = 1; n <= 7; ++n) {
+            size_t next = 0;
+            for (int t = 0; t < n; ++t) {
+                size_t begin, end;
+                xdnn_prefetch_share_range(bytes, t, n, begin, end);
+                ok &= begin == next && begin <= end && (begin % XDNN_CACHE_LINE == 0 || begin == bytes);
+                next = end;
+            }
+            ok &= next == bytes;
+        }
+    }
+
+    // Any range, aligned or not, at every level
+    std::vector<char> buf(10000);
+    for (XDNN_PREFETCH_LEVEL level : {XDNN_PREFETCH_L1, XDNN_PREFETCH_L2, XDNN_PREFETCH_LLC}) {
+        xdnn_prefetch_packed(buf.data() + 3, buf.size() - 3, level);
+        xdnn_prefetch_packed(buf.data(), 0, level);
+        xdnn_prefetch_packed(nullptr, 100, level);
+    }
+
+    printf("\t%s: xdnn_prefetch_share_range\n", ok ? "Passed" : "Failed");
+}
+
+// Scopes nest and give the previous hint back
+void test_xdnn_prefetch_scope() {
+    char a[64], b[64];
+    bool ok = xdnn_current_prefetch_hint() == nullptr;
+    {
+        XDNN_PREFETCH_SCOPE outer(a, sizeof(a));
+        ok &= xdnn_current_prefetch_hint()->ptr == a && xdnn_current_prefetch_hint()->level == XDNN_PREFETCH_LLC;
+        {
+            XDNN_PREFETCH_SCOPE inner(b, sizeof(b), XDNN_PREFETCH_L2);
+            ok &= xdnn_current_prefetch_hint()->ptr == b && xdnn_current_prefetch_hint()->level == XDNN_PREFETCH_L2;
+        }
+        ok &= xdnn_current_prefetch_hint()->ptr == a;
+    }
+    ok &= xdnn_current_prefetch_hint() == nullptr;
+
+    printf("\t%s: XDNN_PREFETCH_SCOPE\n", ok ? "Passed" : "Failed");
+}
+
+// An L2 hint is prefetched into L2 only on a pool pinned to cpus, into the LLC elsewhere
+void test_xdnn_prefetch_share_level() {
+    char a[64];
+    XDNN_PREFETCH_SCOPE next(a, sizeof(a), XDNN_PREFETCH_L2);
+    const XDNN_PREFETCH_HINT *hint = xdnn_current_prefetch_hint();
+    bool ok = xdnn_prefetch_share_level(nullptr) == XDNN_PREFETCH_LLC && xdnn_prefetch_share_level(hint) == XDNN_PREFETCH_LLC;
+    {
+        XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(2);
+        XDNN_THREAD_POOL pool(ctx);
+        ctx.pool = &pool;
+        XDNN_THREAD_SCOPE scope(ctx);
+        ok &= xdnn_prefetch_share_level(hint) == XDNN_PREFETCH_LLC;
+    }
+    {
+        cpu_set_t mask;
+        sched_getaffinity(0, sizeof(mask), &mask);
+        XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(mask, 2);
+        XDNN_THREAD_POOL pool(ctx);
+        ctx.pool = &pool;
+        XDNN_THREAD_SCOPE scope(ctx);
+        ok &= xdnn_prefetch_share_level(hint) == XDNN_PREFETCH_L2;
+    }
+    ok &= xdnn_prefetch_share_level(hint) == XDNN_PREFETCH_LLC;
+
+    printf("\t%s: xdnn_prefetch_share_level\n", ok ? "Passed" : "Failed");
+}
+
+// C of a call with the next weight hint set is the one of the call without
+template <typename TB>
+void test_xdnn_prefetch_compute(const XDNN_GEMM_KERNELS<TB> &kernels, int M, int N, int K) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), C((size_t)M * N), refC((size_t)M * N);
+    std::vector<float> scaleB(xdnn_scale_count(kernels, N, K)), zeroB(xdnn_zero_count(kernels, N, K));
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+    ALLOC(TB, nextB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -1.00f, 1.00f);
+
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+    memcpy((void *)nextB.get(), (const void *)packedB.get(), kernels.packb_size(N, K) * sizeof(TB));
+
+    int prev = omp_get_max_threads();
+    omp_set_num_threads(4);
+    xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+            0.0f, refC.data(), N, nullptr);
+    {
+        XDNN_PREFETCH_SCOPE next(nextB.get(), kernels.packb_size(N, K) * sizeof(TB));
+        xdnn_gemm_compute(kernels, false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(),
+                0.0f, C.data(), N, nullptr);
+    }
+    omp_set_num_threads(prev);
+
+    printf("\t%-20s %-6s", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+    test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), 0.0f);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test prefetch:\n");
+    test_xdnn_prefetch_share_range();
+    test_xdnn_prefetch_scope();
+    test_xdnn_prefetch_share_level();
+
+    for (int isa = XDNN_ISA_AVX2; isa <= std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512); ++isa) {
+        XDNN_CPU_ISA tier = (XDNN_CPU_ISA)isa;
+        // GEMV, GEMV with split-K and blocked tiles
+        test_xdnn_prefetch_compute(xdnn_sgemm_kernels(tier), 1, 1024, 512);
+        test_xdnn_prefetch_compute(xdnn_hgemm_f32f16f32_kernels(tier), 1, 64, 8192);
+        test_xdnn_prefetch_compute(xdnn_sgemm_f32u4f32_group_kernels(64, tier), 70, 200, 300);
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "quantize_packb.h"
+#include "../utils/utils.h"
+
+template <typename TB>
+using quantize_packb_fn = typename XDNN_GEMM_KERNELS<TB>::quantize_packb_fn;
+
+// Fused quantize + pack of B (in TS) gives the bytes of quantize + packb of B converted to fp32
+template <typename TB, typename TS>
+void test_xdnn_quantize_packb(const XDNN_GEMM_KERNELS<TB> &kernels, quantize_packb_fn<TB> quantize_packb,
+        const char *path, bool transB, int N, int K) {
+    int rowsB = transB ? N : K;
+    int ldb = (transB ? K : N) + 3;
+    int ldq = transB ? K : N;
+    size_t size = kernels.packb_size(N, K);
+
+    std::vector<float> B((size_t)rowsB * ldb);
+    std::vector<TS> srcB(B.size());
+    std::vector<TB> quantizedB(xdnn_elems_for<TB>((size_t)K * N));
+    std::vector<float> scaleB(N), zeroB(N), refScaleB(N), refZeroB(N);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(TB));
+    memset((void *)refPackedB.get(), 0, size * sizeof(TB));
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    for (size_t i = 0; i < B.size(); ++i) {
+        srcB[i] = static_cast<TS>(B[i]);
+        B[i] = static_cast<float>(srcB[i]);
+    }
+
+    kernels.quantize(transB, N, K, B.data(), ldb, 0.9999f, quantizedB.data(), ldq, refScaleB.data(), refZeroB.data());
+    kernels.packb(transB, N, K, quantizedB.data(), ldq, refPackedB.get());
+
+    quantize_packb(transB, N, K, srcB.data(), xdnn_data_type_of<TS>(), ldb, 0.9999f, packedB.get(), scaleB.data(), zeroB.data());
+
+    bool ok = memcmp(packedB.get(), refPackedB.get(), size * sizeof(TB)) == 0;
+    ok &= memcmp(scaleB.data(), refScaleB.data(), N * sizeof(float)) == 0;
+    ok &= memcmp(zeroB.data(), refZeroB.data(), N * sizeof(float)) == 0;
+
+    const char *src = xdnn_data_type_of<TS>() == XDNN_DT_FP32 ? "fp32" : xdnn_data_type_of<TS>() == XDNN_DT_FP16 ? "fp16" : "bf16";
+    if (ok) {
+        printf("\tPassed: %s, %s, B in %s, transB=%d, N=%d, K=%d\n", kernels.name, path, src, transB, N, K);
+    } else {
+        printf("\tFailed: %s, %s, B in %s, transB=%d, N=%d, K=%d\n", kernels.name, path, src, transB, N, K);
+    }
+}
+
+// xdnn_quantize of B (in TS) gives the values and scales of _quantize of B converted to fp32
+template <typename TB, typename TS>
+void test_xdnn_quantize(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K) {
+    int rowsB = transB ? N : K;
+    int ldb = transB ? K : N;
+    int ldq = ldb + 2;
+    size_t size = xdnn_elems_for<TB>((size_t)rowsB * ldq);
+
+    std::vector<float> B((size_t)rowsB * ldb);
+    std::vector<TS> srcB(B.size());
+    std::vector<TB> quantizedB(size), refQuantizedB(size);
+    std::vector<float> scaleB(N), zeroB(N), refScaleB(N), refZeroB(N);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    for (size_t i = 0; i < B.size(); ++i) {
+        srcB[i] = static_cast<TS>(B[i]);
+        B[i] = static_cast<float>(srcB[i]);
+    }
+
+    kernels.quantize(transB, N, K, B.data(), ldb, 0.999f, refQuantizedB.data(), ldq, refScaleB.data(), refZeroB.data());
+    xdnn_quantize(kernels, transB, N, K, srcB.data(), ldb, 0.999f, quantizedB.data(), ldq, scaleB.data(), zeroB.data());
+
+    bool ok = memcmp(quantizedB.data(), refQuantizedB.data(), size * sizeof(TB)) == 0;
+    ok &= memcmp(scaleB.data(), refScaleB.data(), N * sizeof(float)) == 0;
+    ok &= memcmp(zeroB.data(), refZeroB.data(), N * sizeof(float)) == 0;
+
+    const char *src = xdnn_data_type_of<TS>() == XDNN_DT_FP16 ? "fp16" : "bf16";
+    if (ok) {
+        printf("\tPassed: %s, quantize, B in %s, transB=%d, N=%d, K=%d\n", kernels.name, src, transB, N, K);
+    } else {
+        printf("\tFailed: %s, quantize, B in %s, transB=%d, N=%d, K=%d\n", kernels.name, src, transB, N, K);
+    }
+}
+
+// The vectorized conversions against the scalar ones, for every 16 bit pattern
+void test_xdnn_to_float() {
+    std::vector<uint16_t> bits(65536 + 5);
+    for (size_t i = 0; i < bits.size(); ++i) bits[i] = (uint16_t)i;
+    std::vector<float> dst(bits.size());
+
+    printf("Test xdnn_fp16_to_float/xdnn_bf16_to_float:\n");
+    for (XDNN_DATA_TYPE type : {XDNN_DT_FP16, XDNN_DT_BF16}) {
+        if (type == XDNN_DT_FP16) {
+            xdnn_fp16_to_float((const XDNN_FP16 *)bits.data(), bits.size(), dst.data());
+        } else {
+            xdnn_bf16_to_float((const XDNN_BF16 *)bits.data(), bits.size(), dst.data());
+        }
+        bool ok = true;
+        for (size_t i = 0; i < bits.size(); ++i) {
+            float ref = type == XDNN_DT_FP16 ? (float)((const XDNN_FP16 *)bits.data())[i] : (float)((const XDNN_BF16 *)bits.data())[i];
+            ok &= memcmp(&ref, &dst[i], sizeof(float)) == 0 || (std::isnan(ref) && std::isnan(dst[i]));
+        }
+        printf("\t%s: %s\n", ok ? "Passed" : "Failed", type == XDNN_DT_FP16 ? "fp16" : "bf16");
+    }
+}
+
+// The panel variant against xdnn_packb_panels of the quantized B
+template <typename TB>
+void test_xdnn_quantize_packb_panels(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K) {
+    int rowsB = transB ? N : K;
+    int ldb = transB ? K : N;
+    size_t size = xdnn_packb_panels_size(kernels, N, K);
+
+    std::vector<float> B((size_t)rowsB * ldb);
+    std::vector<XDNN_BF16> srcB(B.size());
+    std::vector<TB> quantizedB(xdnn_elems_for<TB>((size_t)K * N));
+    std::vector<float> scaleB(N), zeroB(N), refScaleB(N), refZeroB(N);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(TB));
+    memset((void *)refPackedB.get(), 0, size * sizeof(TB));
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    for (size_t i = 0; i < B.size(); ++i) {
+        srcB[i] = static_cast<XDNN_BF16>(B[i]);
+        B[i] = static_cast<float>(srcB[i]);
+    }
+
+    kernels.quantize(transB, N, K, B.data(), ldb, 1.0f, quantizedB.data(), ldb, refScaleB.data(), refZeroB.data());
+    xdnn_packb_panels(kernels, transB, N, K, quantizedB.data(), ldb, refScaleB.data(), refZeroB.data(), refPackedB.get());
+
+    XDNN_PACKED_B<TB> packed = xdnn_quantize_packb_panels(kernels, transB, N, K, srcB.data(), ldb, 1.0f,
+            packedB.get(), scaleB.data(), zeroB.data());
+
+    bool ok = packed.panels == (N + XDNN_PANEL_COLS - 1) / XDNN_PANEL_COLS && packed.scaleB == scaleB.data();
+    ok &= memcmp(packedB.get(), refPackedB.get(), size * sizeof(TB)) == 0;
+    ok &= memcmp(scaleB.data(), refScaleB.data(), N * sizeof(float)) == 0;
+    ok &= memcmp(zeroB.data(), refZeroB.data(), N * sizeof(float)) == 0;
+
+    if (ok) {
+        printf("\tPassed: %s, panels, transB=%d, N=%d, K=%d\n", kernels.name, transB, N, K);
+    } else {
+        printf("\tFailed: %s, panels, transB=%d, N=%d, K=%d\n", kernels.name, transB, N, K);
+    }
+}
+
+template <typename Fmt, XDNN_CPU_ISA isa>
+void test_xdnn_quantize_packb(const char *name) {
+    using TB = typename Fmt::type;
+    using table = xdnn_plain_kernels<Fmt, isa>;
+    XDNN_GEMM_KERNELS<TB> kernels = table::table(name);
+
+    // Through a buffer of the weight type, as with the library tables
+    quantize_packb_fn<TB> staged = xdnn_quantize_then_packb<TB, table::quantize, xdnn_plain_packb<Fmt>>;
+
+    printf("Test xdnn_quantize_packb (%s, %s):\n", name, xdnn_cpu_isa_name(isa));
+    for (bool transB : {true, false}) {
+        for (auto [N, K] : {std::pair{256, 128}, std::pair{301, 77}, std::pair{64, 1000}, std::pair{1, 33}}) {
+            test_xdnn_quantize_packb<TB, float>(kernels, kernels.quantize_packb, "fused", transB, N, K);
+            test_xdnn_quantize_packb<TB, XDNN_FP16>(kernels, kernels.quantize_packb, "fused", transB, N, K);
+            test_xdnn_quantize_packb<TB, XDNN_BF16>(kernels, kernels.quantize_packb, "fused", transB, N, K);
+            test_xdnn_quantize_packb<TB, float>(kernels, staged, "staged", transB, N, K);
+            test_xdnn_quantize_packb<TB, XDNN_BF16>(kernels, staged, "staged", transB, N, K);
+        }
+        test_xdnn_quantize<TB, XDNN_FP16>(kernels, transB, 130, 301);
+        test_xdnn_quantize<TB, XDNN_BF16>(kernels, transB, 130, 301);
+        test_xdnn_quantize_packb_panels(kernels, transB, 300, 130);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    test_xdnn_to_float();
+    test_xdnn_quantize_packb<xdnn_fmt_s8, XDNN_ISA_AVX512>("sgemm_f32s8f32");
+    test_xdnn_quantize_packb<xdnn_fmt_u4, XDNN_ISA_AVX512>("sgemm_f32u4f32");
+    test_xdnn_quantize_packb<xdnn_fmt_nf4, XDNN_ISA_AVX2>("sgemm_f32nf4f32");
+    test_xdnn_quantize_packb<xdnn_fmt_e4m3, XDNN_ISA_AVX512>("sgemm_f32e4m3f32");
+    test_xdnn_quantize_packb<xdnn_fmt_u2, XDNN_ISA_AVX512>("sgemm_f32u2f32");
+    test_xdnn_quantize_packb<xdnn_fmt_u3, XDNN_ISA_AVX2>("sgemm_f32u3f32");
+
+    return 0;
+}
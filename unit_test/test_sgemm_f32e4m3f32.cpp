@@ -0,0 +1,207 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gemm_kernels.h"
+#include "quantize_packb.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.05f
+
+template <typename T>
+static const char *fp8_name() {
+    return std::is_same_v<T, XDNN_FP8_E4M3> ? "e4m3" : "e5m2";
+}
+
+template <typename T>
+static float fp8_value(uint8_t bits) {
+    T v;
+    memcpy(&v, &bits, 1);
+    return v;
+}
+
+// Every code converts back to itself, float to FP8 gives the nearest code (ties to even),
+// and the vector conversion matches the scalar one
+template <typename T>
+void test_xdnn_fp8_convert(void (*to_float)(const T *, size_t, float *)) {
+    std::vector<float> values(256);
+    std::vector<T> codes(256);
+    for (int i = 0; i < 256; ++i) {
+        values[i] = fp8_value<T>(i);
+        memcpy(&codes[i], &i, 1);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < 256; ++i) {
+        T back = values[i];
+        uint8_t b;
+        memcpy(&b, &back, 1);
+        if (std::isnan(values[i])) {
+            ok &= std::isnan((float)back);
+        } else {
+            ok &= b == i;
+        }
+    }
+
+    // Nearest finite code by search, ties to the even code
+    int finite = 0;
+    while (finite + 1 < 128 && std::isfinite(values[finite + 1])) ++finite; // largest finite code
+    for (int t = 0; t < 100000 && ok; ++t) {
+        float f = (2.0f * rand() / RAND_MAX - 1.0f) * T::max() * (t % 2 ? 1.0f : std::ldexp(1.0f, -(t % 24)));
+        if (t % 7 == 0) { // ties
+            int j = rand() % finite;
+            f = (values[j] + values[j + 1]) * (rand() % 2 ? 0.5f : -0.5f);
+        }
+        float best = 0.0f;
+        int best_code = 0;
+        for (int i = 0; i < 128; ++i) {
+            if (!std::isfinite(values[i])) continue;
+            float d = std::fabs(values[i] - std::fabs(f)), db = std::fabs(best - std::fabs(f));
+            if (d < db || (d == db && (i & 1) == 0)) {
+                best = values[i];
+                best_code = i;
+            }
+        }
+        T q = f;
+        uint8_t b;
+        memcpy(&b, &q, 1);
+        ok &= (b & 0x7F) == best_code && (f == 0.0f || (b >> 7) == (f < 0));
+        if (!ok) printf("\t%s: %g converts to %g, nearest %g\n", fp8_name<T>(), f, (float)q, best);
+    }
+
+    std::vector<float> converted(256 + 7);
+    to_float(codes.data(), 256, converted.data());
+    for (int i = 0; i < 256; ++i) {
+        ok &= std::isnan(values[i]) ? std::isnan(converted[i]) : converted[i] == values[i];
+    }
+
+    if (ok) {
+        printf("\tPassed: %s conversions\n", fp8_name<T>());
+    } else {
+        printf("\tFailed: %s conversions\n", fp8_name<T>());
+    }
+}
+
+// _quantize + _packb + _compute with every epilogue against fp32 A x dequantized B
+template <typename T>
+void test_xdnn_fp8_compute(const XDNN_GEMM_KERNELS<T> &kernels, bool transB, int M, int N, int K, unsigned int pad = 0) {
+    int lda = K + pad;
+    int ldc = N + pad;
+    int ldb = (transB ? K : N) + pad;
+
+    std::vector<float> A((size_t)M * lda), B((size_t)(transB ? N : K) * ldb), roundedB((size_t)K * N);
+    std::vector<float> scaleB(N), zeroB(N), bias(N), res((size_t)M * ldc), C0((size_t)M * ldc);
+    std::vector<T> quantizedB(B.size());
+    ALLOC(T, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C0.data(), C0.size(), -1.00f, 1.00f);
+
+    kernels.quantize(transB, N, K, B.data(), ldb, 1.0f, quantizedB.data(), ldb, scaleB.data(), zeroB.data());
+    kernels.packb(transB, N, K, quantizedB.data(), ldb, packedB.get());
+    for (int k = 0; k < K; ++k) {
+        for (int n = 0; n < N; ++n) {
+            size_t idx = transB ? (size_t)n * ldb + k : (size_t)k * ldb + n;
+            roundedB[(size_t)k * N + n] = (float)quantizedB[idx] * scaleB[n] + zeroB[n];
+        }
+    }
+
+    float gamma = 2.0f;
+    struct Case {
+        const char *name;
+        XDNN_POST_OPS ops;
+    } cases[] = {
+        {"compute", xdnn_post_ops({})},
+        {"compute_silu", xdnn_post_ops({xdnn_post_op_silu()})},
+        {"compute_gelu", xdnn_post_ops({xdnn_post_op_gelu()})},
+        {"compute_biasadd", xdnn_post_ops({xdnn_post_op_bias(bias.data())})},
+        {"compute_biasadd_relu", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_relu()})},
+        {"compute_residential", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), ldc)})},
+        {"compute_resext", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), ldc, gamma)})},
+        {"compute_resmul", xdnn_post_ops({xdnn_post_op_res_mul(res.data(), ldc)})},
+    };
+
+    for (int c = 0; c < 8; ++c) {
+        std::vector<float> C = C0, refC = C0;
+        test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), lda, roundedB.data(), N, 0.5f, refC.data(), ldc);
+        xdnn_apply_post_ops(&cases[c].ops, 0, 0, M, N, refC.data(), ldc);
+
+        const T *p = packedB.get();
+        const float *s = scaleB.data(), *z = zeroB.data();
+        switch (c) {
+            case 0: kernels.compute(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc); break;
+            case 1: kernels.compute_silu(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc); break;
+            case 2: kernels.compute_gelu(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc); break;
+            case 3: kernels.compute_biasadd(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc, bias.data()); break;
+            case 4: kernels.compute_biasadd_relu(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc, bias.data()); break;
+            case 5:
+                kernels.compute_residential(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc,
+                        bias.data(), res.data(), ldc);
+                break;
+            case 6:
+                kernels.compute_resext(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc,
+                        bias.data(), gamma, res.data(), ldc);
+                break;
+            default: kernels.compute_resmul(false, M, N, K, 1.0f, A.data(), lda, p, s, z, 0.5f, C.data(), ldc, res.data(), ldc);
+        }
+
+        printf("\t%-16s %-6s %-20s transB=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), cases[c].name, transB);
+        test_utils::validate(M, N, K, lda, N, ldc, refC.data(), C.data(), ACCURACY);
+    }
+}
+
+// An FP8 checkpoint packed as it is, without scales
+template <typename T>
+void test_xdnn_fp8_checkpoint(const XDNN_GEMM_KERNELS<T> &kernels, int M, int N, int K) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), C((size_t)M * N), refC((size_t)M * N);
+    std::vector<T> checkpoint((size_t)K * N);
+    ALLOC(T, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -2.00f, 2.00f);
+    for (size_t i = 0; i < B.size(); ++i) {
+        checkpoint[i] = B[i];
+        B[i] = checkpoint[i];
+    }
+
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), K, B.data(), N, 0.0f, refC.data(), N);
+    kernels.packb(false, N, K, checkpoint.data(), N, packedB.get());
+    kernels.compute(false, M, N, K, 1.0f, A.data(), K, packedB.get(), nullptr, nullptr, 0.0f, C.data(), N);
+
+    printf("\t%-16s %-6s checkpoint", kernels.name, xdnn_cpu_isa_name(kernels.isa));
+    test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+}
+
+template <typename T>
+void test_xdnn_fp8_family(const XDNN_GEMM_KERNELS<T> &(*family_kernels)(XDNN_CPU_ISA)) {
+    for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+        const XDNN_GEMM_KERNELS<T> &kernels = family_kernels((XDNN_CPU_ISA)isa);
+        for (bool transB : {false, true}) {
+            test_xdnn_fp8_compute(kernels, transB, 1, 512, 1024);
+            test_xdnn_fp8_compute(kernels, transB, 37, 130, 300, 3);
+        }
+        test_xdnn_fp8_checkpoint(kernels, 64, 256, 512);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test XDNN_FP8_E4M3/XDNN_FP8_E5M2:\n");
+    test_xdnn_fp8_convert<XDNN_FP8_E4M3>(xdnn_e4m3_to_float);
+    test_xdnn_fp8_convert<XDNN_FP8_E5M2>(xdnn_e5m2_to_float);
+
+    printf("Test xdnn_sgemm_f32e4m3f32_kernels:\n");
+    test_xdnn_fp8_family<XDNN_FP8_E4M3>(xdnn_sgemm_f32e4m3f32_kernels);
+    printf("Test xdnn_sgemm_f32e5m2f32_kernels:\n");
+    test_xdnn_fp8_family<XDNN_FP8_E5M2>(xdnn_sgemm_f32e5m2f32_kernels);
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gemm_kernels.h"
+#include "quantize_packb.h"
+#include "packb_stream.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.05f
+
+template <typename TB>
+static const char *type_name() {
+    return std::is_same_v<TB, XDNN_UINT2x4> ? "uint2x4" : "uint3x8";
+}
+
+// Values set one by one read back, and decode gives them from any column on
+template <typename Fmt>
+void test_xdnn_packed_values() {
+    using TB = typename Fmt::type;
+    const int n = 203;
+    std::vector<TB> packed(xdnn_elems_for<TB>(n));
+    std::vector<uint8_t> values(n);
+    memset((void *)packed.data(), 0xFF, packed.size() * sizeof(TB));
+    for (int i = 0; i < n; ++i) {
+        values[i] = rand() % (Fmt::qmax + 1);
+        xdnn_set_packed(packed.data(), i, values[i]);
+    }
+
+    bool ok = true;
+    std::vector<float> decoded(n);
+    for (int i = 0; i < n; ++i) ok &= xdnn_get_packed(packed.data(), i) == values[i];
+    for (int n0 : {0, 3, 8, 61}) {
+        Fmt::decode(packed.data(), n0, n - n0, decoded.data());
+        for (int i = n0; i < n; ++i) ok &= decoded[i - n0] == values[i];
+    }
+
+    if (ok) {
+        printf("\tPassed: %s values\n", type_name<TB>());
+    } else {
+        printf("\tFailed: %s values\n", type_name<TB>());
+    }
+}
+
+// B (K x N) dequantized from quantizedB (K x N) as q * scale + zero
+template <typename Fmt>
+std::vector<float> dequantize(int N, int K, int group_size, const typename Fmt::type *quantizedB,
+        const float *scaleB, const float *zeroB) {
+    int groups = xdnn_scale_groups(K, group_size);
+    int rows = group_size > 0 ? group_size : K;
+    std::vector<float> B((size_t)K * N);
+    for (int k = 0; k < K; ++k) {
+        for (int n = 0; n < N; ++n) {
+            size_t i = (size_t)n * groups + k / rows;
+            B[(size_t)k * N + n] = xdnn_get_packed(quantizedB, (size_t)k * N + n) * scaleB[i] + zeroB[i];
+        }
+    }
+    return B;
+}
+
+// _quantize + _packb, and the fused quantize_packb, then _compute with every epilogue
+// against fp32 A x dequantized B
+template <typename Fmt>
+void test_xdnn_lowbit_compute(const XDNN_GEMM_KERNELS<typename Fmt::type> &kernels, bool transB, int M, int N, int K) {
+    using TB = typename Fmt::type;
+    int ldb = transB ? K : N;
+    size_t scales = xdnn_scale_count(kernels, N, K);
+    size_t size = kernels.packb_size(N, K);
+
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), bias(N), res((size_t)M * N), C0((size_t)M * N);
+    std::vector<TB> quantizedB(xdnn_elems_for<TB>((size_t)K * N));
+    std::vector<float> scaleB(scales), zeroB(scales), refScaleB(scales), refZeroB(scales);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, fusedB, size);
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    test_utils::init(bias.data(), N, -1.00f, 1.00f);
+    test_utils::init(res.data(), res.size(), -1.00f, 1.00f);
+    test_utils::init(C0.data(), C0.size(), -1.00f, 1.00f);
+
+    // Reference from K x N quantized values
+    kernels.quantize(false, N, K, B.data(), N, 1.0f, quantizedB.data(), N, refScaleB.data(), refZeroB.data());
+    std::vector<float> roundedB = dequantize<Fmt>(N, K, kernels.group_size, quantizedB.data(), refScaleB.data(), refZeroB.data());
+
+    std::vector<float> transposedB;
+    if (transB) {
+        transposedB.resize(B.size());
+        test_utils::transpose(N, K, B.data(), N, transposedB.data());
+    }
+    const float *src = transB ? transposedB.data() : B.data();
+    kernels.quantize(transB, N, K, src, ldb, 1.0f, quantizedB.data(), ldb, scaleB.data(), zeroB.data());
+    kernels.packb(transB, N, K, quantizedB.data(), ldb, packedB.get());
+    bool ok = scaleB == refScaleB && zeroB == refZeroB;
+    memset((void *)fusedB.get(), 0, size * sizeof(TB));
+    xdnn_quantize_packb(kernels, transB, N, K, src, ldb, 1.0f, fusedB.get(), scaleB.data(), zeroB.data());
+    ok &= scaleB == refScaleB && zeroB == refZeroB;
+    ok &= memcmp(packedB.get(), fusedB.get(), size * sizeof(TB)) == 0;
+    if (!ok) {
+        printf("\tFailed: %s, transB=%d, M=%d, N=%d, K=%d, quantized values differ\n", kernels.name, transB, M, N, K);
+        return;
+    }
+
+    float gamma = 2.0f;
+    struct Case {
+        const char *name;
+        XDNN_POST_OPS ops;
+    } cases[] = {
+        {"compute", xdnn_post_ops({})},
+        {"compute_silu", xdnn_post_ops({xdnn_post_op_silu()})},
+        {"compute_gelu", xdnn_post_ops({xdnn_post_op_gelu()})},
+        {"compute_biasadd", xdnn_post_ops({xdnn_post_op_bias(bias.data())})},
+        {"compute_biasadd_relu", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_relu()})},
+        {"compute_residential", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), N)})},
+        {"compute_resext", xdnn_post_ops({xdnn_post_op_bias(bias.data()), xdnn_post_op_res_add(res.data(), N, gamma)})},
+        {"compute_resmul", xdnn_post_ops({xdnn_post_op_res_mul(res.data(), N)})},
+    };
+
+    for (int c = 0; c < 8; ++c) {
+        std::vector<float> C = C0, refC = C0;
+        test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.data(), K, roundedB.data(), N, 0.5f, refC.data(), N);
+        xdnn_apply_post_ops(&cases[c].ops, 0, 0, M, N, refC.data(), N);
+
+        const TB *p = packedB.get();
+        const float *s = scaleB.data(), *z = zeroB.data();
+        switch (c) {
+            case 0: kernels.compute(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 1: kernels.compute_silu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 2: kernels.compute_gelu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N); break;
+            case 3: kernels.compute_biasadd(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, bias.data()); break;
+            case 4: kernels.compute_biasadd_relu(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, bias.data()); break;
+            case 5:
+                kernels.compute_residential(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N,
+                        bias.data(), res.data(), N);
+                break;
+            case 6:
+                kernels.compute_resext(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N,
+                        bias.data(), gamma, res.data(), N);
+                break;
+            default: kernels.compute_resmul(false, M, N, K, 1.0f, A.data(), K, p, s, z, 0.5f, C.data(), N, res.data(), N);
+        }
+
+        printf("\t%-20s %-6s %-20s transB=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), cases[c].name, transB);
+        test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+    }
+}
+
+// Streamed K chunks (transB = false) give the packed B and scales of xdnn_quantize_packb_panels
+template <typename Fmt>
+void test_xdnn_lowbit_stream(const XDNN_GEMM_KERNELS<typename Fmt::type> &kernels, int N, int K, int chunk) {
+    using TB = typename Fmt::type;
+    size_t scales = xdnn_scale_count(kernels, N, K);
+    size_t size = xdnn_packb_panels_size(kernels, N, K);
+
+    std::vector<float> B((size_t)K * N);
+    std::vector<float> scaleB(scales), zeroB(scales), refScaleB(scales), refZeroB(scales);
+    ALLOC(TB, packedB, size);
+    ALLOC(TB, refPackedB, size);
+    memset((void *)packedB.get(), 0, size * sizeof(TB));
+    memset((void *)refPackedB.get(), 0, size * sizeof(TB));
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+
+    xdnn_quantize_packb_panels(kernels, false, N, K, B.data(), N, 1.0f, refPackedB.get(), refScaleB.data(), refZeroB.data());
+
+    XDNN_PACKB_STREAM<TB> stream(kernels, false, N, K, packedB.get(), scaleB.data(), zeroB.data());
+    for (int k = 0; k < K; k += chunk) stream.observe(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    for (int k = 0; k < K; k += chunk) stream.push(B.data() + (size_t)k * N, std::min(chunk, K - k), N);
+    stream.finish();
+
+    bool ok = memcmp(packedB.get(), refPackedB.get(), size * sizeof(TB)) == 0;
+    ok &= scaleB == refScaleB && zeroB == refZeroB;
+    if (ok) {
+        printf("\tPassed: %s stream, N=%d, K=%d, chunk=%d\n", kernels.name, N, K, chunk);
+    } else {
+        printf("\tFailed: %s stream, N=%d, K=%d, chunk=%d\n", kernels.name, N, K, chunk);
+    }
+}
+
+template <typename Fmt, typename Kernels, typename GroupKernels>
+void test_xdnn_lowbit_family(Kernels family_kernels, GroupKernels group_kernels) {
+    for (int isa = XDNN_ISA_AVX2; isa <= xdnn_cpu_isa(); ++isa) {
+        for (bool transB : {false, true}) {
+            test_xdnn_lowbit_compute<Fmt>(family_kernels((XDNN_CPU_ISA)isa), transB, 1, 512, 1024);
+            test_xdnn_lowbit_compute<Fmt>(family_kernels((XDNN_CPU_ISA)isa), transB, 37, 130, 300);
+            test_xdnn_lowbit_compute<Fmt>(group_kernels(32, (XDNN_CPU_ISA)isa), transB, 1, 256, 4096);
+            test_xdnn_lowbit_compute<Fmt>(group_kernels(128, (XDNN_CPU_ISA)isa), transB, 37, 130, 300);
+        }
+    }
+    test_xdnn_lowbit_stream<Fmt>(family_kernels(xdnn_cpu_isa()), 300, 200, 50);
+    test_xdnn_lowbit_stream<Fmt>(group_kernels(64, xdnn_cpu_isa()), 256, 200, 64);
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test XDNN_UINT2x4/XDNN_UINT3x8:\n");
+    test_xdnn_packed_values<xdnn_fmt_u2>();
+    test_xdnn_packed_values<xdnn_fmt_u3>();
+
+    printf("Test xdnn_sgemm_f32u2f32_kernels:\n");
+    test_xdnn_lowbit_family<xdnn_fmt_u2>(
+            [](XDNN_CPU_ISA isa) -> const auto & { return xdnn_sgemm_f32u2f32_kernels(isa); },
+            [](int g, XDNN_CPU_ISA isa) -> const auto & { return xdnn_sgemm_f32u2f32_group_kernels(g, isa); });
+    printf("Test xdnn_sgemm_f32u3f32_kernels:\n");
+    test_xdnn_lowbit_family<xdnn_fmt_u3>(
+            [](XDNN_CPU_ISA isa) -> const auto & { return xdnn_sgemm_f32u3f32_kernels(isa); },
+            [](int g, XDNN_CPU_ISA isa) -> const auto & { return xdnn_sgemm_f32u3f32_group_kernels(g, isa); });
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "thread_context.h"
+#include "gemm_kernels.h"
+#include "packed_b.h"
+#include "../utils/utils.h"
+
+#define ACCURACY 0.01f
+
+// Threads of a team in the scope of ctx must be ctx.threads, each on its cpu
+void test_xdnn_thread_scope(const XDNN_THREAD_CONTEXT &ctx) {
+    int outside = omp_get_max_threads();
+    bool ok = true;
+    {
+        XDNN_THREAD_SCOPE scope(ctx);
+        ok &= omp_get_max_threads() == ctx.threads;
+        ok &= xdnn_current_thread_context() && xdnn_same_thread_context(*xdnn_current_thread_context(), ctx);
+
+        std::vector<int> team(ctx.threads, -1);
+        #pragma omp parallel
+        {
+            team[omp_get_thread_num()] = omp_get_num_threads() == ctx.threads ? sched_getcpu() : -2;
+        }
+        for (int t = 0; t < ctx.threads; ++t) {
+            if (ctx.ncpus > 0) ok &= team[t] == ctx.cpus[t % ctx.ncpus];
+            else ok &= team[t] >= 0;
+        }
+    }
+    ok &= omp_get_max_threads() == outside;
+    ok &= xdnn_current_thread_context() == nullptr;
+
+    if (ok) {
+        printf("\tPassed: threads=%d, ncpus=%d\n", ctx.threads, ctx.ncpus);
+    } else {
+        printf("\tFailed: threads=%d, ncpus=%d\n", ctx.threads, ctx.ncpus);
+    }
+}
+
+// A gemm in the scope of ctx gives the same result as without it
+void test_xdnn_thread_scope_compute(const XDNN_THREAD_CONTEXT &ctx, int M, int N, int K) {
+    const XDNN_GEMM_KERNELS<float> &kernels = xdnn_sgemm_kernels();
+
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+
+    XDNN_THREAD_SCOPE scope(ctx);
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    xdnn_packed_b_compute(packed, false, M, 1.0f, A.get(), K, 0.0f, C.get(), N, nullptr);
+
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+}
+
+// The affinity of each thread of a team
+std::vector<cpu_set_t> team_affinity(int threads) {
+    std::vector<cpu_set_t> masks(threads);
+    #pragma omp parallel num_threads(threads)
+    {
+        if (omp_get_num_threads() == threads) {
+            pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &masks[omp_get_thread_num()]);
+        }
+    }
+    return masks;
+}
+
+bool same_affinity(const std::vector<cpu_set_t> &a, const std::vector<cpu_set_t> &b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!CPU_EQUAL(&a[i], &b[i])) return false;
+    }
+    return a.size() == b.size();
+}
+
+// A scope of a temporary context keeps its own copy, and the team gets its affinity back
+// when the outermost scope ends, for a later context that keeps the affinity too
+void test_xdnn_thread_scope_restore(const XDNN_THREAD_CONTEXT &outer, const XDNN_THREAD_CONTEXT &inner) {
+    int threads = std::max(outer.threads, inner.threads);
+    std::vector<cpu_set_t> before = team_affinity(threads);
+    bool ok = true;
+    {
+        XDNN_THREAD_SCOPE scope(xdnn_thread_context(outer.threads, outer.cpus, outer.ncpus));
+        {
+            XDNN_THREAD_SCOPE nested(inner);
+        }
+        const XDNN_THREAD_CONTEXT *current = xdnn_current_thread_context();
+        ok &= current != nullptr && xdnn_same_thread_context(*current, outer);
+        ok &= omp_get_max_threads() == outer.threads;
+    }
+    ok &= same_affinity(team_affinity(threads), before);
+    {
+        XDNN_THREAD_SCOPE scope(xdnn_thread_context(threads));
+        ok &= same_affinity(team_affinity(threads), before);
+    }
+
+    if (ok) {
+        printf("\tPassed: restored affinity of %d threads after ncpus=%d and ncpus=%d\n", threads, outer.ncpus, inner.ncpus);
+    } else {
+        printf("\tFailed: affinity of %d threads not restored after ncpus=%d and ncpus=%d\n", threads, outer.ncpus, inner.ncpus);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    cpu_set_t mask;
+    sched_getaffinity(0, sizeof(mask), &mask);
+    XDNN_THREAD_CONTEXT all = xdnn_thread_context(mask);
+
+    // The first half of the cpus, and the second one with two threads per cpu
+    int half = std::max(1, all.ncpus / 2);
+    XDNN_THREAD_CONTEXT first = xdnn_thread_context(0, all.cpus, half);
+    XDNN_THREAD_CONTEXT second = xdnn_thread_context(2 * std::max(1, all.ncpus - half),
+            all.cpus + all.ncpus - std::max(1, all.ncpus - half), std::max(1, all.ncpus - half));
+    XDNN_THREAD_CONTEXT unpinned = xdnn_thread_context(3);
+
+    printf("Test XDNN_THREAD_SCOPE:\n");
+    test_xdnn_thread_scope(all);
+    test_xdnn_thread_scope(first);
+    test_xdnn_thread_scope(second);
+    test_xdnn_thread_scope(first);
+    test_xdnn_thread_scope(unpinned);
+
+    printf("Test XDNN_THREAD_SCOPE restore:\n");
+    test_xdnn_thread_scope_restore(first, second);
+    test_xdnn_thread_scope_restore(unpinned, second);
+
+    printf("Test XDNN_THREAD_SCOPE compute:\n");
+    test_xdnn_thread_scope_compute(first, 64, 1024, 512);
+    test_xdnn_thread_scope_compute(second, 1, 4096, 1024);
+
+    return 0;
+}
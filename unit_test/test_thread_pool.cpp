@@ -0,0 +1,168 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "thread_pool.h"
+#include "gemm_kernels.h"
+#include "packed_b.h"
+#include "../utils/utils.h"
+#include "../utils/weight_utils.h"
+
+#define ACCURACY 0.01f
+
+// Every task must run exactly once, in back-to-back jobs of different sizes
+void test_xdnn_thread_pool_run(int threads, int spin_us, int jobs) {
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(threads);
+    XDNN_THREAD_POOL pool(ctx, spin_us);
+    ctx.pool = &pool;
+    XDNN_THREAD_SCOPE scope(ctx);
+
+    std::atomic<int> failures{0};
+    for (int j = 0; j < jobs && failures == 0; ++j) {
+        int tasks = 1 + (j * 7) % 97;
+        std::vector<std::atomic<int>> hits(tasks);
+        for (auto &h : hits) h = 0;
+
+        xdnn_parallel_for(tasks, [&](int t) {
+            hits[t]++;
+            // Nested schedulers run serially inside a task
+            xdnn_parallel_for(3, [&](int) {
+                if (!XDNN_THREAD_POOL::in_pool() || omp_get_max_threads() != 1) failures++;
+            });
+        });
+
+        for (int t = 0; t < tasks; ++t) failures += hits[t] != 1;
+    }
+    bool ok = failures == 0 && !XDNN_THREAD_POOL::in_pool() && omp_get_max_threads() == threads;
+
+    if (ok) {
+        printf("\tPassed: threads=%d, spin_us=%d, jobs=%d\n", threads, spin_us, jobs);
+    } else {
+        printf("\tFailed: threads=%d, spin_us=%d, jobs=%d\n", threads, spin_us, jobs);
+    }
+}
+
+// A task that throws: run() rethrows it on the caller, which leaves pool mode, and the pool
+// keeps serving jobs
+void test_xdnn_thread_pool_throw(int threads, int tasks) {
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(threads);
+    XDNN_THREAD_POOL pool(ctx);
+    ctx.pool = &pool;
+    XDNN_THREAD_SCOPE scope(ctx);
+
+    bool ok = true;
+    for (int bad : {0, tasks / 2, tasks - 1}) {
+        bool caught = false;
+        try {
+            xdnn_parallel_for(tasks, [&](int t) {
+                if (t == bad) throw std::runtime_error("task failed");
+            });
+        } catch (const std::runtime_error &) {
+            caught = true;
+        }
+        ok &= caught && !XDNN_THREAD_POOL::in_pool() && omp_get_max_threads() == threads;
+
+        std::atomic<int> runs{0};
+        xdnn_parallel_for(tasks, [&](int) { runs++; });
+        ok &= runs == tasks;
+    }
+
+    if (ok) {
+        printf("\tPassed: threads=%d, tasks=%d, exceptions rethrown\n", threads, tasks);
+    } else {
+        printf("\tFailed: threads=%d, tasks=%d, exceptions rethrown\n", threads, tasks);
+    }
+}
+
+// A gemm scheduled on the pool gives the same result as on the OpenMP team
+void test_xdnn_thread_pool_compute(int threads, int M, int N, int K) {
+    const XDNN_GEMM_KERNELS<float> &kernels = xdnn_sgemm_kernels();
+
+    ALLOC(float, A, M * K);
+    ALLOC(float, B, K * N);
+    ALLOC(float, packedB, xdnn_packb_panels_size(kernels, N, K));
+    ALLOC(float, C, M * N);
+    ALLOC(float, refC, M * N);
+
+    test_utils::init(A.get(), M * K, -1.00f, 1.00f);
+    test_utils::init(B.get(), K * N, -0.25f, 0.25f);
+    test_utils::gemm_ref(false, false, M, N, K, 1.0f, A.get(), K, B.get(), N, 0.0f, refC.get(), N);
+
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(threads);
+    XDNN_THREAD_POOL pool(ctx);
+    ctx.pool = &pool;
+    XDNN_THREAD_SCOPE scope(ctx);
+
+    XDNN_PACKED_B<float> packed = xdnn_packb_panels(kernels, false, N, K, B.get(), N, nullptr, nullptr, packedB.get());
+    for (int i = 0; i < 10; ++i) {
+        xdnn_packed_b_compute(packed, false, M, 1.0f, A.get(), K, 0.0f, C.get(), N, nullptr);
+    }
+
+    test_utils::validate(M, N, K, K, N, N, refC.get(), C.get(), ACCURACY);
+}
+
+// The portable kernels of a table (AVX2/AVX-512 tiers) run their tiles, split-K slices and
+// reductions on the pool of the context, and give the result of the OpenMP team
+template <typename TB>
+void test_xdnn_thread_pool_kernels(const XDNN_GEMM_KERNELS<TB> &kernels, int threads, int M, int N, int K) {
+    std::vector<float> A((size_t)M * K), B((size_t)K * N), C((size_t)M * N), refC((size_t)M * N);
+    std::vector<float> scaleB(xdnn_scale_count(kernels, N, K)), zeroB(xdnn_zero_count(kernels, N, K));
+    ALLOC(TB, packedB, kernels.packb_size(N, K));
+
+    test_utils::init(A.data(), A.size(), -1.00f, 1.00f);
+    test_utils::init(B.data(), B.size(), -0.25f, 0.25f);
+    prepare_packed_weight(kernels, N, K, B.data(), 1.0f, packedB.get(), scaleB.data(), zeroB.data());
+
+    XDNN_THREAD_CONTEXT ctx = xdnn_thread_context(threads);
+    {
+        XDNN_THREAD_SCOPE scope(ctx);
+        kernels.compute(false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(), 0.0f, refC.data(), N);
+    }
+
+    XDNN_THREAD_POOL pool(ctx);
+    ctx.pool = &pool;
+    {
+        XDNN_THREAD_SCOPE scope(ctx);
+        kernels.compute(false, M, N, K, 1.0f, A.data(), K, packedB.get(), scaleB.data(), zeroB.data(), 0.0f, C.data(), N);
+    }
+
+    printf("\t%-20s %-6s threads=%d", kernels.name, xdnn_cpu_isa_name(kernels.isa), threads);
+    if (pool.jobs() == 0) {
+        printf("\tFailed: M=%5d, N=%5d, K=%5d, not run on the pool\n", M, N, K);
+    } else {
+        test_utils::validate(M, N, K, K, N, N, refC.data(), C.data(), ACCURACY);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+
+    printf("Test XDNN_THREAD_POOL run:\n");
+    test_xdnn_thread_pool_run(1, XDNN_POOL_SPIN_US, 100);
+    test_xdnn_thread_pool_run(4, XDNN_POOL_SPIN_US, 1000);
+    test_xdnn_thread_pool_run(4, 0, 1000);
+    test_xdnn_thread_pool_run(8, 10, 300);
+
+    printf("Test XDNN_THREAD_POOL exceptions:\n");
+    test_xdnn_thread_pool_throw(1, 10);
+    test_xdnn_thread_pool_throw(4, 100);
+
+    printf("Test XDNN_THREAD_POOL compute:\n");
+    test_xdnn_thread_pool_compute(4, 1, 4096, 4096);
+    test_xdnn_thread_pool_compute(3, 70, 1000, 512);
+
+    // Tiles, GEMV, and split-K with its reduction for the decode shape
+    XDNN_CPU_ISA isa = std::min(xdnn_cpu_isa(), XDNN_ISA_AVX512);
+    printf("Test XDNN_THREAD_POOL kernels.compute:\n");
+    test_xdnn_thread_pool_kernels(xdnn_sgemm_kernels(isa), 4, 70, 1000, 512);
+    test_xdnn_thread_pool_kernels(xdnn_sgemm_kernels(isa), 4, 1, 4096, 4096);
+    test_xdnn_thread_pool_kernels(xdnn_sgemm_f32s8f32_kernels(isa), 4, 1, 100, 8192);
+    test_xdnn_thread_pool_kernels(xdnn_sgemm_f32u4f32_group_kernels(64, isa), 3, 5, 60, 4096);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "gemm_kernels.h"
+#include "quantize_packb.h"
+
+// Quantize (the quantized families) or convert B into the weight type of the table.
+// B is K x N, N x K if transB, with stride ldb; convertedB gets the same layout.
+// roundedB, if given, receives the fp32 values the kernels really see (B's layout).
+template <typename TB>
+void prepare_weight(const XDNN_GEMM_KERNELS<TB> &kernels, bool transB, int N, int K, const float *B, int ldb,
+        float quantization_rate, TB *convertedB, float *scaleB, float *zeroB, float *roundedB = nullptr) {
+    if (kernels.quantize) {
+        kernels.quantize(transB, N, K, B, ldb, quantization_rate, convertedB, ldb, scaleB, zeroB);
+    } else if constexpr (std::is_convertible_v<float, TB>) {
+        for (int r = 0; r < (transB ? N : K); ++r) {
+            for (int c = 0; c < (transB ? K : N); ++c) convertedB[(size_t)r * ldb + c] = static_cast<TB>(B[(size_t)r * ldb + c]);
+        }
+    }
+    if (roundedB == nullptr) return;
+
+    bool nf4 = !kernels.codebook && strstr(kernels.name, "nf4") != nullptr;
+    for (int k = 0; k < K; ++k) {
+        int g = kernels.group_size > 0 ? k / kernels.group_size : 0;
+        for (int n = 0; n < N; ++n) {
+            size_t idx = transB ? (size_t)n * ldb + k : (size_t)k * ldb + n;
+            float q;
+            if constexpr (xdnn_values_per<TB> > 1) {
+                uint8_t v = xdnn_get_packed(convertedB, idx);
+                q = kernels.codebook ? zeroB[XDNN_CODEBOOK_SIZE * g + v] : nf4 ? XDNN_NORMAL_FLOAT32[v] : v;
+            } else {
+                q = static_cast<float>(convertedB[idx]);
+            }
+            if (kernels.quantize) {
+                float zero = kernels.codebook ? 0.0f : zeroB[xdnn_zero_offset(kernels, K, n) + g];
+                q = q * scaleB[xdnn_scale_offset(kernels, K, n) + g] + zero;
+            }
+            roundedB[idx] = q;
+        }
+    }
+}
+
+// Quantize or convert B (K x N) and pack it into packedB (kernels.packb_size elements)
+template <typename TB>
+void prepare_packed_weight(const XDNN_GEMM_KERNELS<TB> &kernels, int N, int K, const float *B,
+        float quantization_rate, TB *packedB, float *scaleB, float *zeroB) {
+    if (kernels.quantize) {
+        xdnn_quantize_packb(kernels, false, N, K, B, N, quantization_rate, packedB, scaleB, zeroB);
+    } else if constexpr (std::is_convertible_v<float, TB>) {
+        std::vector<TB> convertedB((size_t)K * N);
+        for (size_t i = 0; i < convertedB.size(); ++i) convertedB[i] = static_cast<TB>(B[i]);
+        kernels.packb(false, N, K, convertedB.data(), N, packedB);
+    }
+}